@@ -30,7 +30,7 @@ namespace mars {
 
     GraphicsTimer::GraphicsTimer(GraphicsManagerInterface *graphics_,
                                  SimulatorInterface *sim_)
-      : graphics(graphics_), sim(sim_) {
+      : graphics(graphics_), sim(sim_), updateTime(10) {
       graphicsTimer = new QTimer();
       connect(graphicsTimer, SIGNAL(timeout()), this, SLOT(timerEvent()));
       connect(this, SIGNAL(internalRun()), this, SLOT(runOnceInternal()),
@@ -39,7 +39,7 @@ namespace mars {
 
     void GraphicsTimer::run() {
       char* marsTimerStepsize = getenv("MARS_GRAPHICS_UPDATE_TIME");
-      int updateTime = 10;
+      updateTime = 10;
       if(marsTimerStepsize) {
         updateTime = atoi(marsTimerStepsize);
       }
@@ -65,7 +65,18 @@ namespace mars {
     }
 
     void GraphicsTimer::timerEvent(void) {
-      if(sim->getAllowDraw() || !sim->getSyncGraphics()) {
+      // in synchronized mode the frame is drawn as soon as the running
+      // simulation allows it; the timer fires again immediately and the
+      // wait returns to the event loop at least every updateTime
+      // milliseconds. A stopped simulation allows no new frames, thus it
+      // is only polled with the normal interval.
+      bool sync = sim->getSyncGraphics();
+      bool wait = sync && sim->isSimRunning();
+      bool draw;
+      if(!sync) draw = true;
+      else if(wait) draw = sim->waitForAllowDraw(updateTime);
+      else draw = sim->getAllowDraw();
+      if(draw) {
         if(graphics) {
           graphics->draw();
         }
@@ -73,6 +84,7 @@ namespace mars {
           sim->finishedDraw();
         }
       }
+      graphicsTimer->setInterval(wait ? 0 : updateTime);
     }
  
   } // end of namespace app
@@ -56,6 +56,7 @@ namespace mars {
       mars::interfaces::GraphicsManagerInterface *graphics;
       mars::interfaces::SimulatorInterface *sim;
       bool runFinished;
+      int updateTime;
 
     }; // end of class GraphicsTimer
 
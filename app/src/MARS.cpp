@@ -287,10 +287,10 @@ namespace mars {
 
     int MARS::runWoQApp() {
       while(!quit) {
-        if(control->sim->getAllowDraw() || !control->sim->getSyncGraphics()) {
+        if(!control->sim->getSyncGraphics() ||
+           control->sim->waitForAllowDraw(10)) {
           control->sim->finishedDraw();
         }
-        //mars::utils::msleep(2);
       }
       return 0;
     }
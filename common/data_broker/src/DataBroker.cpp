@@ -47,6 +47,7 @@
 
 #include <mars/utils/MutexLocker.h>
 #include <mars/utils/misc.h>
+#include <mars/utils/TraceRecorder.h>
 
 #include <cstdio>
 #include <cerrno>
@@ -286,6 +287,7 @@ namespace mars {
     }
 
     bool DataBroker::stepTimer(const std::string &timerName, long step) {
+      ScopedTrace trace("stepTimer", timerName.c_str());
       std::map<std::string, Timer>::iterator timerIt, endIt;
       std::list<DeferredCallback> deferredCallbacks;
       std::set<DataItemConnection> activeConnections;
@@ -384,6 +386,8 @@ namespace mars {
           timedReceiverIt != deferredReceivers.end();
           ++timedReceiverIt) {
         DataElement *element = timedReceiverIt->element;
+        ScopedTrace callbackTrace("stepTimer callback",
+                                  element->info.dataName.c_str());
         element->bufferLock->lockForRead();
         timedReceiverIt->receiver->receiveData(element->info,
                                                *element->frontBuffer,
@@ -406,6 +410,8 @@ namespace mars {
       for(callbackIt = deferredCallbacks.begin();
           callbackIt != deferredCallbacks.end();
           ++callbackIt) {
+        ScopedTrace callbackTrace("stepTimer callback",
+                                  callbackIt->info.dataName.c_str());
         for(receiverIt = callbackIt->receivers.begin();
             receiverIt != callbackIt->receivers.end();
             ++receiverIt) {
@@ -950,6 +956,7 @@ namespace mars {
       elementsLock.unlock();
 
       // do the synchronous callbacks
+      ScopedTrace trace("pushData", info.dataName.c_str());
       for(syncReceiverIt = syncReceivers.begin();
           syncReceiverIt != syncReceivers.end();
           ++syncReceiverIt) {
@@ -1043,6 +1050,7 @@ namespace mars {
       std::list<DeferredCallback> deferredCallbacks;
       std::list<DeferredCallback>::iterator callbackIt;
 
+      TraceRecorder::setThreadName("DataBroker");
       wakeupMutex.lock();
       while(!stop_thread) {
         elementsLock.lockForRead();
@@ -1076,6 +1084,8 @@ namespace mars {
         //pushError("DataBroker::deferredCallbacks %d", deferredCallbacks.size());
         for(callbackIt = deferredCallbacks.begin();
             callbackIt != deferredCallbacks.end(); ++callbackIt) {
+          ScopedTrace trace("DataBroker callback",
+                            callbackIt->info.dataName.c_str());
           for(receiverIt = callbackIt->receivers.begin();
               receiverIt != callbackIt->receivers.end();
               ++receiverIt) {
@@ -0,0 +1,140 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef MARS_UTILS_BINARY_BUFFER_H
+#define MARS_UTILS_BINARY_BUFFER_H
+
+#include <vector>
+#include <cstring>
+
+namespace mars {
+  namespace utils {
+
+    /**
+     * \brief A growing byte buffer to store plain values in a compact
+     * binary form, e.g. the state of a simulation.
+     *
+     * Only types that can be copied with memcpy (numbers, Vector,
+     * Quaternion, structs of those) must be written. The data is stored
+     * in the byte order of the machine.
+     */
+    class BinaryBuffer {
+    public:
+      BinaryBuffer() : readPos(0) {}
+
+      void write(const void *data, size_t size) {
+        const char *bytes = static_cast<const char*>(data);
+        buffer.insert(buffer.end(), bytes, bytes+size);
+      }
+
+      template<typename T>
+      void write(const T &value) {
+        write(&value, sizeof(T));
+      }
+
+      /**
+       * \return false if the buffer contains less than \c size unread
+       *         bytes; in that case nothing is read.
+       */
+      bool read(void *data, size_t size) {
+        if(readPos + size > buffer.size()) return false;
+        if(size) memcpy(data, &buffer[readPos], size);
+        readPos += size;
+        return true;
+      }
+
+      template<typename T>
+      bool read(T *value) {
+        return read(value, sizeof(T));
+      }
+
+      /**
+       * \brief Skips \c size bytes.
+       * \return false if the buffer contains less than \c size unread
+       *         bytes.
+       */
+      bool skip(size_t size) {
+        if(readPos + size > buffer.size()) return false;
+        readPos += size;
+        return true;
+      }
+
+      /**
+       * \brief Reads the value if \c apply is set, otherwise only skips it.
+       * Thus a buffer can be checked with the code that applies it.
+       */
+      template<typename T>
+      bool readOrSkip(T *value, bool apply) {
+        return apply ? read(value) : skip(sizeof(T));
+      }
+
+      template<typename T>
+      void writeVector(const std::vector<T> &values) {
+        write((unsigned long)values.size());
+        if(!values.empty()) write(&values[0], values.size()*sizeof(T));
+      }
+
+      template<typename T>
+      bool readVector(std::vector<T> *values) {
+        unsigned long count;
+        if(!read(&count)) return false;
+        if(count*sizeof(T) > buffer.size()-readPos) return false;
+        values->resize(count);
+        return count == 0 || read(&(*values)[0], count*sizeof(T));
+      }
+
+      /**
+       * \brief Starts reading at the beginning of the buffer again.
+       */
+      void rewind() {
+        readPos = 0;
+      }
+
+      void clear() {
+        buffer.clear();
+        readPos = 0;
+      }
+
+      bool atEnd() const {
+        return readPos == buffer.size();
+      }
+
+      size_t size() const {
+        return buffer.size();
+      }
+
+      const std::vector<char>& getData() const {
+        return buffer;
+      }
+
+      void setData(const std::vector<char> &data) {
+        buffer = data;
+        readPos = 0;
+      }
+
+    private:
+      std::vector<char> buffer;
+      size_t readPos;
+    }; // end of class BinaryBuffer
+
+  } // end of namespace utils
+} // end of namespace mars
+
+#endif /* MARS_UTILS_BINARY_BUFFER_H */
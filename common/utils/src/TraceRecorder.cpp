@@ -0,0 +1,262 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TraceRecorder.h"
+#include "MutexLocker.h"
+#include "misc.h"
+
+#include <pthread.h>
+#include <cstdio>
+#include <cstring>
+
+#ifdef WIN32
+  #include <process.h>
+  #define getpid _getpid
+#else
+  #include <unistd.h>
+#endif
+
+#if defined(__GNUC__)
+  #define TRACE_MEMORY_BARRIER() __sync_synchronize()
+#elif defined(_MSC_VER)
+  #include <windows.h>
+  #define TRACE_MEMORY_BARRIER() MemoryBarrier()
+#endif
+
+namespace mars {
+  namespace utils {
+
+    static const size_t traceNameLength = 64;
+    static const size_t traceBufferSize = 32768;
+
+    struct TraceEvent {
+      long long time;
+      const char *category;
+      char phase;
+      char name[traceNameLength];
+    };
+
+    /**
+     * Only the owning thread writes into the buffer. The event count is
+     * increased after the event is written, so a reader sees only
+     * complete events. numOpen counts the recorded begin events without
+     * end event, numSkipped the dropped ones.
+     */
+    struct TraceThreadBuffer {
+      void reset(unsigned int generation_) {
+        generation = generation_;
+        count = 0;
+        dropped = 0;
+        numOpen = 0;
+        numSkipped = 0;
+        truncated = false;
+        truncatedTime = 0;
+      }
+
+      int threadId;
+      std::string threadName;
+      unsigned int generation;
+      TraceEvent *events;
+      volatile size_t count;
+      unsigned long dropped;
+      size_t numOpen;
+      size_t numSkipped;
+      volatile bool truncated;
+      long long truncatedTime;
+    };
+
+    volatile bool TraceRecorder::enabled = false;
+    volatile unsigned int TraceRecorder::generation = 0;
+    Mutex TraceRecorder::buffersMutex;
+    std::list<TraceThreadBuffer*> TraceRecorder::buffers;
+
+    static pthread_key_t traceBufferKey;
+    static pthread_once_t traceBufferKeyOnce = PTHREAD_ONCE_INIT;
+
+    static void createTraceBufferKey() {
+      pthread_key_create(&traceBufferKey, NULL);
+    }
+
+    void TraceRecorder::setEnabled(bool enable) {
+      if(enable && !enabled) {
+        // the threads reset their buffers with their next event
+        ++generation;
+        TRACE_MEMORY_BARRIER();
+      }
+      enabled = enable;
+    }
+
+    TraceThreadBuffer* TraceRecorder::getThreadBuffer() {
+      pthread_once(&traceBufferKeyOnce, createTraceBufferKey);
+      TraceThreadBuffer *buffer;
+      buffer = (TraceThreadBuffer*)pthread_getspecific(traceBufferKey);
+      if(!buffer) {
+        // the buffers are kept until the end of the process, thus the
+        // events of finished threads are still written
+        buffer = new TraceThreadBuffer();
+        buffer->reset(generation);
+        buffer->events = NULL;
+        MutexLocker locker(&buffersMutex);
+        buffer->threadId = (int)buffers.size()+1;
+        buffers.push_back(buffer);
+        pthread_setspecific(traceBufferKey, buffer);
+      }
+      return buffer;
+    }
+
+    void TraceRecorder::setThreadName(const std::string &name) {
+      TraceThreadBuffer *buffer = getThreadBuffer();
+      MutexLocker locker(&buffersMutex);
+      buffer->threadName = name;
+    }
+
+    void TraceRecorder::addEvent(char phase, const char *category,
+                                 const char *name) {
+      TraceThreadBuffer *buffer = getThreadBuffer();
+      if(buffer->generation != generation) {
+        buffer->reset(generation);
+      }
+      if(!buffer->events) {
+        buffer->events = new TraceEvent[traceBufferSize];
+      }
+      if(phase == 'B') {
+        // the begin event needs room for itself, its own end event and
+        // the end events of the open begin events
+        if(!buffer->truncated &&
+           buffer->count + buffer->numOpen + 2 > traceBufferSize) {
+          buffer->truncatedTime = getTimeMicroseconds();
+          TRACE_MEMORY_BARRIER();
+          buffer->truncated = true;
+        }
+        if(buffer->truncated) {
+          ++buffer->numSkipped;
+          ++buffer->dropped;
+          return;
+        }
+        ++buffer->numOpen;
+      }
+      else {
+        // the events are nested, thus the end events of dropped begin
+        // events come first
+        if(buffer->numSkipped) {
+          --buffer->numSkipped;
+          ++buffer->dropped;
+          return;
+        }
+        // the begin event was recorded before the recording was
+        // restarted or not at all
+        if(!buffer->numOpen) return;
+        --buffer->numOpen;
+      }
+      TraceEvent &event = buffer->events[buffer->count];
+      event.time = getTimeMicroseconds();
+      event.category = category;
+      event.phase = phase;
+      strncpy(event.name, name, traceNameLength-1);
+      event.name[traceNameLength-1] = '\0';
+      TRACE_MEMORY_BARRIER();
+      ++buffer->count;
+    }
+
+    void TraceRecorder::begin(const char *category, const char *name) {
+      if(enabled) addEvent('B', category, name);
+    }
+
+    void TraceRecorder::end(const char *category, const char *name) {
+      // the end event of an open begin event is also recorded after the
+      // recording was stopped to keep the events balanced
+      addEvent('E', category, name);
+    }
+
+    static void writeJSONString(FILE *file, const char *s) {
+      fputc('"', file);
+      for(; *s; ++s) {
+        if(*s == '"' || *s == '\\') fputc('\\', file);
+        if((unsigned char)*s < 0x20) fputc(' ', file);
+        else fputc(*s, file);
+      }
+      fputc('"', file);
+    }
+
+    bool TraceRecorder::writeFile(const std::string &filename) {
+      FILE *file = fopen(filename.c_str(), "w");
+      if(!file) {
+        fprintf(stderr, "TraceRecorder: could not open \"%s\"\n",
+                filename.c_str());
+        return false;
+      }
+      int pid = (int)getpid();
+      bool first = true;
+      std::list<TraceThreadBuffer*>::iterator it;
+
+      fprintf(file, "{\"traceEvents\":[\n");
+      MutexLocker locker(&buffersMutex);
+      for(it = buffers.begin(); it != buffers.end(); ++it) {
+        TraceThreadBuffer *buffer = *it;
+        if(!buffer->threadName.empty()) {
+          fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,"
+                  "\"tid\":%d,\"args\":{\"name\":", first ? "" : ",\n",
+                  pid, buffer->threadId);
+          writeJSONString(file, buffer->threadName.c_str());
+          fprintf(file, "}}");
+          first = false;
+        }
+        if(buffer->generation != generation) continue;
+        size_t count = buffer->count;
+        TRACE_MEMORY_BARRIER();
+        for(size_t i=0; i<count; ++i) {
+          const TraceEvent &event = buffer->events[i];
+          fprintf(file, "%s{\"name\":", first ? "" : ",\n");
+          writeJSONString(file, event.name);
+          fprintf(file, ",\"cat\":");
+          writeJSONString(file, event.category);
+          fprintf(file, ",\"ph\":\"%c\",\"ts\":%lld,\"pid\":%d,\"tid\":%d}",
+                  event.phase, event.time, pid, buffer->threadId);
+          first = false;
+        }
+        if(buffer->truncated) {
+          fprintf(file, "%s{\"name\":\"trace buffer full\",\"cat\":\"trace\","
+                  "\"ph\":\"i\",\"s\":\"t\",\"ts\":%lld,\"pid\":%d,"
+                  "\"tid\":%d,\"args\":{\"dropped\":%lu}}",
+                  first ? "" : ",\n", buffer->truncatedTime, pid,
+                  buffer->threadId, buffer->dropped);
+          first = false;
+          fprintf(stderr, "TraceRecorder: the trace of thread %d is "
+                  "truncated, %lu events were dropped\n", buffer->threadId,
+                  buffer->dropped);
+        }
+      }
+      fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+      fclose(file);
+      return true;
+    }
+
+    unsigned long TraceRecorder::getNumDroppedEvents() {
+      unsigned long dropped = 0;
+      std::list<TraceThreadBuffer*>::iterator it;
+      MutexLocker locker(&buffersMutex);
+      for(it = buffers.begin(); it != buffers.end(); ++it) {
+        if((*it)->generation == generation) dropped += (*it)->dropped;
+      }
+      return dropped;
+    }
+
+  } // end of namespace utils
+} // end of namespace mars
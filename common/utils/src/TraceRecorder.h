@@ -0,0 +1,115 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef MARS_UTILS_TRACE_RECORDER_H
+#define MARS_UTILS_TRACE_RECORDER_H
+
+#include "Mutex.h"
+
+#include <string>
+#include <list>
+
+namespace mars {
+  namespace utils {
+
+    struct TraceThreadBuffer;
+
+    /**
+     * \brief Records begin/end events of all threads of the process and
+     * writes them in the Chrome trace event format (chrome://tracing,
+     * Perfetto).
+     *
+     * Every thread writes into its own fixed size buffer, thus recording
+     * an event takes no lock and does not allocate memory. Each recorded
+     * begin event keeps room for its end event. When the buffer is full,
+     * the thread stops recording and only the end events of the begin
+     * events that are still open are added, thus the written trace stays
+     * balanced; the point of the truncation is marked in the trace. The
+     * buffer of a thread is
+     * allocated with its first event after the recording was enabled.
+     * Event names longer than 63 characters are truncated.
+     */
+    class TraceRecorder {
+    public:
+      /**
+       * \brief Starts or stops the recording. Starting the recording
+       * discards all previously recorded events.
+       */
+      static void setEnabled(bool enable);
+
+      static inline bool isEnabled()
+      { return enabled; }
+
+      /**
+       * \brief Sets the name of the calling thread shown in the trace.
+       */
+      static void setThreadName(const std::string &name);
+
+      static void begin(const char *category, const char *name);
+      static void end(const char *category, const char *name);
+
+      /**
+       * \brief Writes all recorded events as JSON file. The recording
+       * should be stopped before.
+       * \return false if the file could not be written.
+       */
+      static bool writeFile(const std::string &filename);
+
+      /**
+       * \returns the number of events that were dropped because the
+       * buffer of their thread was full.
+       */
+      static unsigned long getNumDroppedEvents();
+
+    private:
+      static void addEvent(char phase, const char *category, const char *name);
+      static TraceThreadBuffer* getThreadBuffer();
+
+      static volatile bool enabled;
+      static volatile unsigned int generation;
+      static Mutex buffersMutex;
+      static std::list<TraceThreadBuffer*> buffers;
+    }; // end of class TraceRecorder
+
+    /**
+     * \brief Records a begin event on construction and the matching end
+     * event on destruction if the TraceRecorder is enabled.
+     */
+    class ScopedTrace {
+    public:
+      ScopedTrace(const char *category, const char *name)
+        : category(category), name(name), active(TraceRecorder::isEnabled()) {
+        if(active) TraceRecorder::begin(category, name);
+      }
+
+      ~ScopedTrace() {
+        if(active) TraceRecorder::end(category, name);
+      }
+
+    private:
+      const char *category;
+      const char *name;
+      bool active;
+    }; // end of class ScopedTrace
+
+  } // end of namespace utils
+} // end of namespace mars
+
+#endif /* MARS_UTILS_TRACE_RECORDER_H */
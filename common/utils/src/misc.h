@@ -29,6 +29,9 @@
   #include <sys/time.h>
   #include <unistd.h>
 #endif
+#ifdef __linux__
+  #include <time.h>
+#endif
 
 #include <string>
 #include <vector>
@@ -89,6 +92,35 @@ namespace mars {
       return getTime() - start;
     }
 
+    /**
+     * @return current time in microseconds, intended to measure short
+     *         durations; on linux a monotonic clock is used
+     */
+    inline long long getTimeMicroseconds() {
+#ifdef WIN32
+      LARGE_INTEGER frequency, counter;
+      QueryPerformanceFrequency(&frequency);
+      QueryPerformanceCounter(&counter);
+      return (long long)(counter.QuadPart*1000000LL/frequency.QuadPart);
+#elif defined __linux__
+      struct timespec timer;
+      clock_gettime(CLOCK_MONOTONIC, &timer);
+      return ((long long)timer.tv_sec)*1000000LL + timer.tv_nsec/1000;
+#else
+      struct timeval timer;
+      gettimeofday(&timer, NULL);
+      return ((long long)timer.tv_sec)*1000000LL + timer.tv_usec;
+#endif
+    }
+
+    /**
+     * @param start reference time in microseconds
+     * @return time difference between now and start in microseconds
+     */
+    inline long long getTimeDiffMicroseconds(long long start) {
+      return getTimeMicroseconds() - start;
+    }
+
     /**
      * sleeps for at least the specified time.
      * @param milliseconds time to sleep in milliseconds
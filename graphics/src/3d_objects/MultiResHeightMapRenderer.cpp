@@ -46,6 +46,20 @@ namespace mars {
     float texCoord[2];
   };
 
+  // the heights of a sub tile
+  struct RowHeights {
+    explicit RowHeights(double **rows) : rows(rows) {}
+    double operator()(int x, int y) const {return rows[y][x];}
+    double **rows;
+  };
+
+  // the low resolution heights
+  struct LowResHeights {
+    explicit LowResHeights(const MultiResHeightMapRenderer *r) : r(r) {}
+    double operator()(int x, int y) const {return r->getHeight(x, y);}
+    const MultiResHeightMapRenderer *r;
+  };
+
   MultiResHeightMapRenderer::MultiResHeightMapRenderer(int gridW, int gridH,
                                                        double visualW,
                                                        double visualH,
@@ -61,6 +75,9 @@ namespace mars {
 
     maxNumSubTiles = 100;
     heightData = NULL;
+    grid = NULL;
+    gridScale = 1.0;
+    gridBorder = 0.0;
     numSubTiles = 0;
     prepare();
 
@@ -78,6 +95,7 @@ namespace mars {
     clear();
     delete[] vboIds;
     vboIds = NULL;
+    if(grid) grid->release();
   }
 
   void MultiResHeightMapRenderer::initialize() {
@@ -219,11 +237,11 @@ namespace mars {
           index = y*getLowResVertexCntX() + x;
           vertices[index].position[0] = x * stepX * scaleX;
           vertices[index].position[1] = y * stepY * scaleY;
-          vertices[index].position[2] = heightData[y][x] * scaleZ;
+          vertices[index].position[2] = getHeight(x, y) * scaleZ;
           vertices[index].texCoord[0] = x * stepX * scaleX*texScaleX;
           vertices[index].texCoord[1] = y * stepY * scaleY*texScaleY;
           getNormal(x, y, getLowResVertexCntX(), getLowResVertexCntY(),
-                    stepX, stepY, heightData,
+                    stepX, stepY, LowResHeights(this),
                     vertices[index].normal,
                     vertices[index].tangent, true);
         }
@@ -281,7 +299,8 @@ namespace mars {
         int index = y*width+x;
         vertices[index].position[0] = x * stepX * scaleX;
         vertices[index].position[1] = y * stepY * scaleY;
-        vertices[index].position[2] = heightData[y][x] * scaleZ;
+        // the heights of the high resolution vertices are set by fillCell
+        vertices[index].position[2] = highRes ? 0.0 : getHeight(x, y) * scaleZ;
         vertices[index].texCoord[0] = x * stepX * scaleX*texScaleX;
         vertices[index].texCoord[1] = y * stepY * scaleY*texScaleY;
 
@@ -469,10 +488,10 @@ namespace mars {
     double dy = (y - gridY*stepY) / stepY;
     double cornerHeights[4];
     assert((gridY < getLowResCellCntY()) && (gridX < getLowResCellCntX()));
-    cornerHeights[0] = heightData[gridY][gridX];
-    cornerHeights[1] = heightData[gridY+1][gridX];
-    cornerHeights[2] = heightData[gridY][gridX+1];
-    cornerHeights[3] = heightData[gridY+1][gridX+1];
+    cornerHeights[0] = getHeight(gridX, gridY);
+    cornerHeights[1] = getHeight(gridX, gridY+1);
+    cornerHeights[2] = getHeight(gridX+1, gridY);
+    cornerHeights[3] = getHeight(gridX+1, gridY+1);
     double height = (cornerHeights[0] * (1-dx) * (1-dy) +
                      cornerHeights[1] * (1-dx) * dy +
                      cornerHeights[2] * dx * (1-dy) +
@@ -515,7 +534,7 @@ namespace mars {
           index = x2 + iy*getHighResVertexCntX() + ix;
           getNormal(ix, iy, getHighResCellCntX(), getHighResCellCntY(),
                     highStepX, highStepY,
-                    tile->heightData,
+                    RowHeights(tile->heightData),
                     vertices[index].normal,
                     vertices[index].tangent, true);
         }
@@ -641,7 +660,7 @@ namespace mars {
           for(int n = 0; n < getHighResVertexCntY(); ++n)
             for(int m = 0; m < getHighResVertexCntX(); ++m)
               // TODO: Should we interpolate here?
-              newSubTile->heightData[n][m] = heightData[iy][ix];
+              newSubTile->heightData[n][m] = getHeight(ix, iy);
 
           fillCell(newSubTile);
 
@@ -813,7 +832,7 @@ namespace mars {
           
           getNormal(x, y, getHighResCellCntX(), getHighResCellCntY(),
                     highStepX, highStepY,
-                    tile->heightData,
+                    RowHeights(tile->heightData),
                     vertices[index].normal,
                     vertices[index].tangent, true);
           
@@ -840,6 +859,7 @@ namespace mars {
                                             double height) {
     assert(gridX < (unsigned int)getLowResVertexCntX());
     assert(gridY < (unsigned int)this->getLowResVertexCntY());
+    assert(!grid);
     if(height < minZ)
       minZ = height;
     if(height > maxZ)
@@ -849,8 +869,36 @@ namespace mars {
   }
 
   double MultiResHeightMapRenderer::getHeight(unsigned int gridX,
-                                              unsigned int gridY) {
-    return heightData[gridY][gridX];
+                                              unsigned int gridY) const {
+    if(!grid) return heightData[gridY][gridX];
+    double h = grid->get(gridX, gridY) * gridScale;
+    if(gridX == 0 || gridY == 0 ||
+       gridX == (unsigned int)getLowResCellCntX() ||
+       gridY == (unsigned int)getLowResCellCntY()) {
+      h += gridBorder;
+    }
+    return h;
+  }
+
+  void MultiResHeightMapRenderer::setHeightGrid(interfaces::HeightGrid *grid,
+                                                double scale,
+                                                double borderOffset) {
+    assert(grid->getWidth() == getLowResVertexCntX());
+    assert(grid->getHeight() == getLowResVertexCntY());
+    grid->retain();
+    if(this->grid) this->grid->release();
+    this->grid = grid;
+    gridScale = scale;
+    gridBorder = borderOffset;
+    // the own copy of the heights is no longer needed
+    if(heightData) {
+      for(int i = 0; i < getLowResVertexCntY(); ++i) {
+        delete[] heightData[i];
+      }
+      delete[] heightData;
+      heightData = NULL;
+    }
+    dirty = true;
   }
 
   void MultiResHeightMapRenderer::setOffset(double x, double y, double z) {
@@ -861,9 +909,10 @@ namespace mars {
     offset[2] = z;
   }
 
+  template <class Heights>
   void MultiResHeightMapRenderer::getNormal(int x, int y, int mx, int my,
                                             double x_step, double y_step,
-                                            double **height_data,
+                                            const Heights &height_data,
                                             float *normal,
                                             float *tangent,
                                             bool skipBorder) {
@@ -871,71 +920,71 @@ namespace mars {
 
     if(skipBorder) {
       if(x < mx-2 && x > 1) {
-        vz1 = height_data[y][x+1] - height_data[y][x-1];
+        vz1 = height_data(x+1, y) - height_data(x-1, y);
         vx1 = x_step*2.0;
       }
       else if(x==0) {
-        vz1 = height_data[y][x+2] - height_data[y][x+1];
+        vz1 = height_data(x+2, y) - height_data(x+1, y);
         vx1 = x_step;
       }
       else if(x==1) {
-        vz1 = height_data[y][x+1] - height_data[y][x];
+        vz1 = height_data(x+1, y) - height_data(x, y);
         vx1 = x_step;
       }
       else if(x==mx-1) {
-        vz1 = height_data[y][x-1] - height_data[y][x-2];
+        vz1 = height_data(x-1, y) - height_data(x-2, y);
         vx1 = x_step;
       }
       else {
-        vz1 = height_data[y][x] - height_data[y][x-1];
+        vz1 = height_data(x, y) - height_data(x-1, y);
         vx1 = x_step;
       }
 
       if(y > 1 && y < my-2) {
-        vz2 = height_data[y+1][x] - height_data[y-1][x];
+        vz2 = height_data(x, y+1) - height_data(x, y-1);
         vy2 = y_step*2.0;
       }
       else if(y==0) {
-        vz2 = height_data[y+2][x] - height_data[y+1][x];
+        vz2 = height_data(x, y+2) - height_data(x, y+1);
         vy2 = y_step;
       }
       else if(y==1) {
-        vz2 = height_data[y+1][x] - height_data[y][x];
+        vz2 = height_data(x, y+1) - height_data(x, y);
         vy2 = y_step;
       }
       else if(y==my-1) {
-        vz2 = height_data[y-1][x] - height_data[y-2][x];
+        vz2 = height_data(x, y-1) - height_data(x, y-2);
         vy2 = y_step;
       }
       else {
-        vz2 = height_data[y][x] - height_data[y-1][x];
+        vz2 = height_data(x, y) - height_data(x, y-1);
         vy2 = y_step;
       }
     }
     else {
       if(x != 0 && x != mx-1) {
-        vz1 = height_data[y][x+1] - height_data[y][x-1];
+        vz1 = height_data(x+1, y) - height_data(x-1, y);
         vx1 = x_step*2.0;
       }
       else if(x==0) {
-        vz1 = height_data[y][x+1] - height_data[y][x];
+        vz1 = height_data(x+1, y) - height_data(x, y);
         vx1 = x_step;
       }
       else {
-        vz1 = height_data[y][x] - height_data[y][x-1];
+        vz1 = height_data(x, y) - height_data(x-1, y);
         vx1 = x_step;
       }
 
       if(y != 0 && y != my-1) {
-        vz2 = height_data[y+1][x] - height_data[y-1][x];
+        vz2 = height_data(x, y+1) - height_data(x, y-1);
         vy2 = y_step*2.0;
       }
       else if(y==0) {
-        vz2 = height_data[y+1][x] - height_data[y][x];
+        vz2 = height_data(x, y+1) - height_data(x, y);
         vy2 = y_step;
       }
       else {
-        vz2 = height_data[y][x] - height_data[y-1][x];
+        vz2 = height_data(x, y) - height_data(x, y-1);
         vy2 = y_step;
       }
     }
@@ -985,7 +1034,7 @@ namespace mars {
         v = vertices+index;
         v->position[2] = tile->heightData[y][x] * scaleZ;
         getNormal(x, y, getHighResCellCntX(), getHighResCellCntY(), highStepX, highStepY,
-                  tile->heightData,
+                  RowHeights(tile->heightData),
                   vertices[index].normal,
                   vertices[index].tangent, true);
       }
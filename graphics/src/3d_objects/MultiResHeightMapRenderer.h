@@ -40,6 +40,8 @@ GLEW_FUN_EXPORT PFNGLUNMAPBUFFERPROC glUnmapBuffer;
 #include <map>
 #include <list>
 
+#include <mars/interfaces/HeightGrid.h>
+
 namespace mars {
 
   struct SubTile {
@@ -71,8 +73,16 @@ namespace mars {
     void highInitialize();
     void render();
     void collideSphere(double xPos, double yPos, double zPos, double radius);
+    /**
+     * \brief Reads the heights from grid instead of an own copy: the
+     * heights of the grid times scale, plus borderOffset at the borders.
+     * The size of the grid has to match gridW and gridH; setHeight() can
+     * not be used afterwards.
+     */
+    void setHeightGrid(interfaces::HeightGrid *grid, double scale,
+                       double borderOffset);
     void setHeight(unsigned int gridX, unsigned int gridY, double height);
-    double getHeight(unsigned int gridX, unsigned int gridY);
+    double getHeight(unsigned int gridX, unsigned int gridY) const;
     void setOffset(double x, double y, double z);
     void setDrawSolid(bool drawSolid);
     void setDrawWireframe(bool drawWireframe);
@@ -134,6 +144,9 @@ namespace mars {
     int maxNumSubTiles, numSubTiles;
     double newIndicesPos, newVerticesPos;
     double **heightData;
+    // the shared heights that replace heightData
+    interfaces::HeightGrid *grid;
+    double gridScale, gridBorder;
     bool dirty;
     double offset[3];
     double minX, minY, minZ, maxX, maxY, maxZ;
@@ -142,8 +155,10 @@ namespace mars {
     std::map<int, SubTile*> subTiles;
     std::list<SubTile*> listSubTiles;
 
+    // Heights returns the height of a vertex with operator()(x, y)
+    template <class Heights>
     void getNormal(int x, int y, int mx, int my, double x_step,
-                   double y_step, double **height_data, float *normal,
+                   double y_step, const Heights &height_data, float *normal,
                    float *tangent, bool skipBorder);
 
     void normalize(float *v);
@@ -34,6 +34,8 @@
 #include <osg/CullFace>
 #include <osg/Geometry>
 
+#include <algorithm>
+
 #ifdef HAVE_OSG_VERSION_H
   #include <osg/Version>
 #else
@@ -55,18 +57,41 @@ namespace mars {
       info.srcname = ts->srcname;
       info.texScaleX = ts->texScaleX;
       info.texScaleY = ts->texScaleY;
-      height_data = NULL;
 #ifdef USE_VERTEX_BUFFER
       vbt = new VertexBufferTerrain(ts);
 #endif
     }
 
     TerrainDrawObject::~TerrainDrawObject() {
-      if(height_data) {
-        for(int i = 0; i < info.height + 1; ++i)
-          delete height_data[i];
-        delete height_data;
+    }
+
+    /**
+     * The heights of the sub tiles.
+     */
+    struct RowHeights {
+      explicit RowHeights(double **rows) : rows(rows) {}
+      double operator()(int x, int y) const {return rows[y][x];}
+      double **rows;
+    };
+
+    /**
+     * The heights of the terrain mesh.
+     */
+    struct MeshHeights {
+      explicit MeshHeights(const TerrainDrawObject *o) : o(o) {}
+      double operator()(int x, int y) const {return o->getGridHeight(x, y);}
+      const TerrainDrawObject *o;
+    };
+
+    double TerrainDrawObject::getGridHeight(int x, int y) const {
+      // the skirt at the far borders is below the last row and column
+      if(x >= info.width || y >= info.height) {
+        return getGridHeight(std::min(x, info.width-1),
+                             std::min(y, info.height-1)) - 0.3;
       }
+      double h = info.heights->get(x, y) * info.scale;
+      if(y<1 || x<1) h -= 0.1;
+      return h;
     }
 
     std::list< osg::ref_ptr< osg::Geode > > TerrainDrawObject::createGeometry() {
@@ -117,9 +142,7 @@ namespace mars {
       //geom->setUseVertexBufferObjects(true);
       tangents = new osg::Vec4Array();
 
-      height_data = new double*[info.height+1];
-      for(int i = 0; i < info.height + 1; ++i)
-        height_data[i] = new double[info.width+1];
+      MeshHeights height_data(this);
 
       tex_data_x = new double*[info.height+1];
       tex_data_y = new double*[info.height+1];
@@ -133,15 +156,7 @@ namespace mars {
 
       for(int y = 0; y < info.height; ++y) {
         for(int x = 0; x < info.width; ++x) {
-          // create height
-          height_data[y][x] = info.pixelData[(y*info.width)+x] * info.scale;
-
           // create the tex_coords
-          if(y<1 || x<1) {
-            //mod = fmod(height_data[y][x], mod_val);
-            //if(mod > mod_val2) mod -= mod_val;
-            height_data[y][x] -= 0.1;
-          }
 
           /*
             if(y > info.height -2 ||
@@ -155,7 +170,7 @@ namespace mars {
             tex_data_y[y][x] = 0.0 + tex_off_y;
           }
           else {
-            calc = fabs(height_data[y-1][x] - height_data[y][x]);
+            calc = fabs(height_data(x, y-1) - height_data(x, y));
             calc = sqrt(pow(calc, 2) + y_step2);
             //tex_data_y[y][x] = tex_data_y[y-1][x] + calc;
             tex_data_y[y][x] = (y-1)*y_step + calc + tex_off_y;
@@ -164,7 +179,7 @@ namespace mars {
             tex_data_x[y][x] = 0.0 + tex_off_x;
           }
           else {
-            calc = fabs(height_data[y][x-1] - height_data[y][x]);
+            calc = fabs(height_data(x-1, y) - height_data(x, y));
             calc = sqrt(pow(calc, 2) + x_step2);
             //tex_data_x[y][x] = tex_data_x[y][x-1] + calc;
             tex_data_x[y][x] = (x-1)*x_step + calc + tex_off_x;
@@ -174,16 +189,13 @@ namespace mars {
       for(int y = 0; y < info.height; ++y) {
         tex_data_y[y][info.width] = tex_data_y[y][info.width-1];
         tex_data_x[y][info.width] = tex_data_x[y][info.width-1]+x_step;
-        height_data[y][info.width] = height_data[y][info.width-1] - 0.3;
       }
       for(int x = 0; x < info.width; ++x) {
         tex_data_x[info.height][x] = tex_data_x[info.height-1][x];
         tex_data_y[info.height][x] = tex_data_y[info.height-1][x]+y_step;
-        height_data[info.height][x] = height_data[info.height-1][x] - 0.3;
       }
       tex_data_x[info.height][info.width] = tex_data_x[info.height][info.width-1]+x_step;
       tex_data_y[info.height][info.width] = tex_data_y[info.height-1][info.width]+y_step;
-      height_data[info.height][info.width] = height_data[info.height-1][info.width-1] - 0.3;
 
       if(info.texScaleX == 0)
         {
@@ -263,14 +275,14 @@ namespace mars {
           normaly *= diff;
           normalz *= diff;
           */
-          vertices->push_back(osg::Vec3(x*x_step, y*y_step, height_data[y2][x2]));
+          vertices->push_back(osg::Vec3(x*x_step, y*y_step, height_data(x2, y2)));
           //normals->push_back(osg::Vec3(normalx, normaly, normalz));
           normals->push_back(osg::Vec3(n.x(), n.y(), n.z()));
           tangents->push_back(osg::Vec4(t.x(), t.y(), t.z(), 0.0));
           normal_debug->push_back(osg::Vec3(x*x_step, y*y_step,
-                                            height_data[y2][x2]));
+                                            height_data(x2, y2)));
           normal_debug->push_back(osg::Vec3(x*x_step, y*y_step,
-                                            height_data[y2][x2])+
+                                            height_data(x2, y2))+
                                   osg::Vec3(n.x(), n.y(), n.z())*0.1);
 
           // should use tex_scale in shader
@@ -590,7 +602,7 @@ namespace mars {
 
           n = getNormal(x, y, newSubTile->xCount, newSubTile->yCount,
                         newSubTile->xRes, newSubTile->yRes,
-                        newSubTile->heightData, &t);
+                        RowHeights(newSubTile->heightData), &t);
           newSubTile->vertices->push_back(osg::Vec3(v.x(), v.y(), v.z()));
           newSubTile->normals->push_back(osg::Vec3(n.x(), n.y(), n.z()));
           newSubTile->tangents->push_back(osg::Vec4(t.x(), t.y(), t.z(), 0.0));
@@ -675,79 +687,81 @@ namespace mars {
       //geom->addPrimitiveSet(newSubTile->pSet.get());
     }
 
+    template <class Heights>
     Vector TerrainDrawObject::getNormal(int x, int y, int mx, int my,
                                         double x_step, double y_step,
-                                        double **height_data, osg::Vec3d* t, bool skipBorder) {
+                                        const Heights &height_data,
+                                        osg::Vec3d* t, bool skipBorder) {
       double nx, ny, nz;
       double vx1, vz1, vy2, vz2;
 
       if(skipBorder) {
         if(x < mx-2 && x > 1) {
-          vz1 = height_data[y][x+1] - height_data[y][x-1];
+          vz1 = height_data(x+1, y) - height_data(x-1, y);
           vx1 = x_step*2.0;
         }
         else if(x==0) {
-          vz1 = height_data[y][x+2] - height_data[y][x+1];
+          vz1 = height_data(x+2, y) - height_data(x+1, y);
           vx1 = x_step;
         }
         else if(x==1) {
-          vz1 = height_data[y][x+1] - height_data[y][x];
+          vz1 = height_data(x+1, y) - height_data(x, y);
           vx1 = x_step;
         }
         else if(x==mx-1) {
-          vz1 = height_data[y][x-1] - height_data[y][x-2];
+          vz1 = height_data(x-1, y) - height_data(x-2, y);
           vx1 = x_step;
         }
         else {
-          vz1 = height_data[y][x] - height_data[y][x-1];
+          vz1 = height_data(x, y) - height_data(x-1, y);
           vx1 = x_step;
         }
 
         if(y > 1 && y < my-2) {
-          vz2 = height_data[y+1][x] - height_data[y-1][x];
+          vz2 = height_data(x, y+1) - height_data(x, y-1);
           vy2 = y_step*2.0;
         }
         else if(y==0) {
-          vz2 = height_data[y+2][x] - height_data[y+1][x];
+          vz2 = height_data(x, y+2) - height_data(x, y+1);
           vy2 = y_step;
         }
         else if(y==1) {
-          vz2 = height_data[y+1][x] - height_data[y][x];
+          vz2 = height_data(x, y+1) - height_data(x, y);
           vy2 = y_step;
         }
         else if(y==my-1) {
-          vz2 = height_data[y-1][x] - height_data[y-2][x];
+          vz2 = height_data(x, y-1) - height_data(x, y-2);
           vy2 = y_step;
         }
         else {
-          vz2 = height_data[y][x] - height_data[y-1][x];
+          vz2 = height_data(x, y) - height_data(x, y-1);
           vy2 = y_step;
         }
       }
       else {
         if(x != 0 && x != mx-1) {
-          vz1 = height_data[y][x+1] - height_data[y][x-1];
+          vz1 = height_data(x+1, y) - height_data(x-1, y);
           vx1 = x_step*2.0;
         }
         else if(x==0) {
-          vz1 = height_data[y][x+1] - height_data[y][x];
+          vz1 = height_data(x+1, y) - height_data(x, y);
           vx1 = x_step;
         }
         else {
-          vz1 = height_data[y][x] - height_data[y][x-1];
+          vz1 = height_data(x, y) - height_data(x-1, y);
           vx1 = x_step;
         }
 
         if(y != 0 && y != my-1) {
-          vz2 = height_data[y+1][x] - height_data[y-1][x];
+          vz2 = height_data(x, y+1) - height_data(x, y-1);
           vy2 = y_step*2.0;
         }
         else if(y==0) {
-          vz2 = height_data[y+1][x] - height_data[y][x];
+          vz2 = height_data(x, y+1) - height_data(x, y);
           vy2 = y_step;
         }
         else {
-          vz2 = height_data[y][x] - height_data[y-1][x];
+          vz2 = height_data(x, y) - height_data(x, y-1);
           vy2 = y_step;
         }
       }
@@ -978,7 +992,8 @@ namespace mars {
             v.z() = tile->heightData[y][x];
 
             n = getNormal(x, y, tile->xCount, tile->yCount,
-                          tile->xRes, tile->yRes, tile->heightData, &t);
+                          tile->xRes, tile->yRes,
+                          RowHeights(tile->heightData), &t);
             vid = tile->vStart+y*(tile->xCount)+x;
             (*(tile->vertices.get()))[vid] = v;
             (*(tile->normals.get()))[vid] = osg::Vec3(n.x(), n.y(), n.z());
@@ -1040,12 +1055,12 @@ namespace mars {
       x2 = floor((v.x()) / x_step);
       y2 = floor((v.y()) / y_step);
 
-      hs[0] = height_data[y2][x2];
-      if(y2 < info.height) hs[1] = height_data[y2+1][x2];
+      hs[0] = getGridHeight(x2, y2);
+      if(y2 < info.height) hs[1] = getGridHeight(x2, y2+1);
       else hs[1] = hs[0];
-      if(x2 < info.width) hs[2] = height_data[y2][x2+1];
+      if(x2 < info.width) hs[2] = getGridHeight(x2+1, y2);
       else hs[2] = hs[0];
-      if(y2 < info.height && x2 < info.width) hs[3] = height_data[y2+1][x2+1];
+      if(y2 < info.height && x2 < info.width) hs[3] = getGridHeight(x2+1, y2+1);
       else hs[3] = hs[0];
       dx = (v.x() - x2*x_step)/x_step;
       dy = (v.y() - y2*y_step)/y_step;
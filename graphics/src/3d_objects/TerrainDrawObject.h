@@ -87,6 +87,12 @@ namespace mars {
       virtual void generateTangents();
       virtual void collideSphere(mars::utils::Vector pos,
                                  mars::interfaces::sReal radius);
+      /**
+       * \brief Returns the height of the vertex (x, y) of the terrain mesh,
+       * which has a lowered skirt as additional last row and column. The
+       * heights are read from the height grid shared with the physics.
+       */
+      double getGridHeight(int x, int y) const;
       static int countSubTiles;
 
 #ifdef USE_VERTEX_BUFFER
@@ -109,8 +115,6 @@ namespace mars {
       osg::ref_ptr<osg::Vec3Array> normal_debug;
       osg::ref_ptr<osg::Geometry> normal_geom;
 
-      double **height_data;
-
       int tangentUnit;
       int num_y, num_x;
       double x_step, y_step;
@@ -124,9 +128,11 @@ namespace mars {
 
       void createNewSubTile(SubTile *newSubTile, mars::utils::Vector pos,
                             double radius);
+      // Heights returns the height of (x, y) with operator()(x, y)
+      template <class Heights>
       mars::utils::Vector getNormal(int x, int y, int mx, int my,
                        double x_step, double y_step,
-                       double **height_data, osg::Vec3d* t,
+                       const Heights &height_data, osg::Vec3d* t,
                        bool skipBorder = false);
 
       int rectangleIntersect(const osg::Vec3& first_leftup,
@@ -60,15 +60,14 @@ namespace mars {
                                             1.0, 1.0, 1.0, ts->texScaleX,
                                             ts->texScaleY);
       double maxHeight = 0.0;
-      double offset;
 
+      // the renderer reads the heights shared with the physics and lowers
+      // the borders by 0.1
+      mrhmr->setHeightGrid(ts->heights, ts->scale, -0.1);
       for(int i=0; i<ts->height; ++i)
         for(int j=0; j<ts->width; ++j) {
-          if(i==0 || j==0 || i==ts->height-1 || j==ts->width-1) offset = -0.1;
-          else offset = 0.0;
-          mrhmr->setHeight(j, i, offset+ts->scale*ts->pixelData[i*ts->width+j]);
-          if(ts->pixelData[i*ts->width+j]*ts->scale > maxHeight) {
-            maxHeight = ts->pixelData[i*ts->width+j]*ts->scale;
+          if(ts->heights->get(j, i)*ts->scale > maxHeight) {
+            maxHeight = ts->heights->get(j, i)*ts->scale;
           }
         }
 
@@ -62,6 +62,8 @@
 #include "wrapper/OSGNodeStruct.h"
 #include "QtOsgMixGraphicsWidget.h"
 
+#include <mars/utils/TraceRecorder.h>
+
 #include <iostream>
 #include <cassert>
 #include <stdexcept>
@@ -125,6 +127,8 @@ namespace mars {
     }
 
     void GraphicsManager::initializeOSG(void *data, bool createWindow) {
+      // the graphics are drawn by the thread that initializes them
+      utils::TraceRecorder::setThreadName("draw");
       cfg = libManager->getLibraryAs<cfg_manager::CFGManagerInterface>("cfg_manager");
       if(!cfg) {
         fprintf(stderr, "******* mars_graphics: couldn't find cfg_manager\n");
@@ -645,6 +649,7 @@ namespace mars {
     void GraphicsManager::draw() {
       std::list<interfaces::GraphicsUpdateInterface*>::iterator it;
       std::vector<GraphicsWidget*>::iterator iter;
+      utils::ScopedTrace trace("mars_graphics", "GraphicsManager::draw");
 
       for(it=graphicsUpdateObjects.begin();
           it!=graphicsUpdateObjects.end(); ++it) {
@@ -657,7 +662,10 @@ namespace mars {
       }
 
       // Render a complete new frame.
-      if(viewer) viewer->frame();
+      if(viewer) {
+        utils::ScopedTrace trace("mars_graphics", "viewer->frame");
+        viewer->frame();
+      }
       ++framecount;
       for(it=graphicsUpdateObjects.begin();
           it!=graphicsUpdateObjects.end(); ++it) {
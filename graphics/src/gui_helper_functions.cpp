@@ -50,6 +50,7 @@ namespace mars {
     using mars::utils::Vector;
     using mars::utils::Quaternion;
     using mars::interfaces::snmesh;
+    using mars::interfaces::HeightGrid;
 
     vector<nodeFileStruct> GuiHelper::nodeFiles;
     vector<textureFileStruct> GuiHelper::textureFiles;
@@ -496,9 +497,8 @@ namespace mars {
         terrain->width = img->width;
         terrain->height = img->height;
         fprintf(stderr, "w h = %d %d\n", img->width, img->height);
-        terrain->pixelData = (double*)calloc((terrain->width*
-                                              terrain->height),
-                                             sizeof(double));
+        HeightGrid *grid = new HeightGrid(terrain->width, terrain->height);
+        double *heights = grid->getWritableData();
 
 
        CvScalar s;
@@ -510,15 +510,16 @@ namespace mars {
           for(int x=0; x<terrain->width; x++) {
 
             s=cvGet2D(img,y,x);
-            terrain->pixelData[count++] = ((double)s.val[0])/imageMaxValue;
+            heights[count++] = ((double)s.val[0])/imageMaxValue;
             if(y==0 || y == terrain->height-1 ||
                x==0 || x == terrain->width-1)
-              terrain->pixelData[count-1] -= 0.002;
-            if(terrain->pixelData[count-1] <= 0.0)
-              terrain->pixelData[count-1] = 0.001;
+              heights[count-1] -= 0.002;
+            if(heights[count-1] <= 0.0)
+              heights[count-1] = 0.001;
 
           }
         }
+        terrain->setHeights(grid);
         cvReleaseImage(&img);
       }
 
@@ -538,11 +539,8 @@ namespace mars {
       if(image) {
         terrain->width = image->s();
         terrain->height = image->t();
-        //if(terrain->pixelData) free(terrain->pixelData);
-
-        terrain->pixelData = (double*)calloc((terrain->width*
-                                              terrain->height),
-                                             sizeof(double));
+        HeightGrid *grid = new HeightGrid(terrain->width, terrain->height);
+        double *heights = grid->getWritableData();
         //image->setPixelFormat(GL_RGB);
         //image->setDataType(GL_UNSIGNED_SHORT);
         //osgDB::writeImageFile(*image, std::string("test.jpg"));
@@ -559,9 +557,10 @@ namespace mars {
             //QColor converter(image.pixel(x, y));
             //converter.getRgb(&r, &g, &b);
             //convert to greyscale by common used scale
-            terrain->pixelData[count++] = r;//((r*0.3+g*0.59+b*0.11));
+            heights[count++] = r;//((r*0.3+g*0.59+b*0.11));
           }
         }
+        terrain->setHeights(grid);
       }
 #endif
     }
@@ -49,6 +49,7 @@ namespace mars {
     using mars::interfaces::NodeData;
     using mars::interfaces::LightData;
     using mars::interfaces::MaterialData;
+    using mars::interfaces::HeightGrid;
     using mars::utils::Vector;
 
     OSGNodeStruct::OSGNodeStruct(std::vector<LightData*> &lightList,
@@ -124,18 +125,10 @@ namespace mars {
         drawObject_->createObject(id, Vector(0.0, 0.0, 0.0));//node.pivot);
       } else if (node.physicMode == mars::interfaces::NODE_TYPE_TERRAIN) {
         // we have a heightfield
-        if (!node.terrain->pixelData) {
-          node.terrain->pixelData = (double*)calloc(
-                                                    (node.terrain->width*node.terrain->height), sizeof(double));
-          //QImage image(QString::fromStdString(snode->filename));
-          int r = 0, g = 0, b = 0;
-          int count = 0;
-          for (int y=0; y<node.terrain->height; y++) {
-            for (int x=0; x<node.terrain->width; x++) {
-              //convert to greyscale by common used scale
-              node.terrain->pixelData[count++] = ((r*0.3+g*0.59+b*0.11)/255.0);
-            }
-          }
+        if (!node.terrain->heights) {
+          // a flat terrain
+          node.terrain->setHeights(new HeightGrid(node.terrain->width,
+                                                  node.terrain->height));
         }
         drawObject_ = new TerrainDrawObject(node.terrain);
         drawObject_->setUseMARSShader(useMARSShader);
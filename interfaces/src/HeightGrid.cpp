@@ -0,0 +1,112 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file HeightGrid.cpp
+ * \author agent
+ * \brief "HeightGrid" holds the heights of a terrain for the physics and
+ * the graphics.
+ *
+ */
+
+#include "HeightGrid.h"
+
+#include <mars/utils/MutexLocker.h>
+
+#include <cstdio>
+#include <cstdlib>
+
+#ifndef WIN32
+  #include <sys/mman.h>
+#endif
+
+namespace mars {
+  namespace interfaces {
+
+    HeightGrid::HeightGrid() : data(NULL), width(0), height(0),
+                               mapAddress(NULL), mapLength(0), refCount(1) {
+    }
+
+    HeightGrid::HeightGrid(int width, int height)
+      : data(NULL), width(width), height(height), mapAddress(NULL),
+        mapLength(0), refCount(1) {
+      data = (double*)calloc((size_t)width*height, sizeof(double));
+    }
+
+    HeightGrid::~HeightGrid() {
+#ifndef WIN32
+      if(mapAddress) {
+        munmap(mapAddress, mapLength);
+        return;
+      }
+#endif
+      free(data);
+    }
+
+    HeightGrid* HeightGrid::mapFile(const std::string &file, size_t offset,
+                                    int width, int height) {
+      size_t count = (size_t)width*height;
+      FILE *f = fopen(file.c_str(), "rb");
+      if(!f) return NULL;
+      HeightGrid *grid = NULL;
+#ifndef WIN32
+      size_t length = offset + count*sizeof(double);
+      void *address = mmap(NULL, length, PROT_READ, MAP_SHARED, fileno(f), 0);
+      fclose(f);
+      if(address == MAP_FAILED) return NULL;
+      grid = new HeightGrid();
+      grid->mapAddress = address;
+      grid->mapLength = length;
+      grid->data = (double*)((char*)address + offset);
+#else
+      // without mmap the file is read at once
+      grid = new HeightGrid(width, height);
+      bool ok = (grid->data && fseek(f, (long)offset, SEEK_SET) == 0 &&
+                 fread(grid->data, sizeof(double), count, f) == count);
+      fclose(f);
+      if(!ok) {
+        grid->release();
+        return NULL;
+      }
+#endif
+      grid->width = width;
+      grid->height = height;
+      return grid;
+    }
+
+    HeightGrid* HeightGrid::retain(void) {
+      utils::MutexLocker locker(&refMutex);
+      ++refCount;
+      return this;
+    }
+
+    void HeightGrid::release(void) {
+      refMutex.lock();
+      bool last = (--refCount == 0);
+      refMutex.unlock();
+      if(last) delete this;
+    }
+
+    double* HeightGrid::getWritableData(void) {
+      return mapAddress ? NULL : data;
+    }
+
+  } // end of namespace interfaces
+} // end of namespace mars
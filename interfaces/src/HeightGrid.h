@@ -0,0 +1,102 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file HeightGrid.h
+ * \author agent
+ * \brief "HeightGrid" holds the heights of a terrain for the physics and
+ * the graphics.
+ *
+ */
+
+#ifndef MARS_INTERFACES_HEIGHT_GRID_H
+#define MARS_INTERFACES_HEIGHT_GRID_H
+
+#ifdef _PRINT_HEADER_
+  #warning "HeightGrid.h"
+#endif
+
+#include <mars/utils/Mutex.h>
+
+#include <cstddef>
+#include <string>
+
+namespace mars {
+  namespace interfaces {
+
+    /**
+     * \brief The normalized heights (0..1) of a terrain, row by row in
+     * the layout of LoadHeightmapInterface::readPixelData.
+     *
+     * A grid is shared by reference: the terrainStructs of the simulation,
+     * the reload list, the physics and the terrain renderers all read the
+     * same heights. It is created with one reference and deleted with its
+     * last release(). The creator fills the heights before the grid is
+     * shared; afterwards it is read-only. The heights are either allocated
+     * or a read-only mapping of a file, whose pages are only loaded where
+     * the heights are read.
+     */
+    class HeightGrid {
+    public:
+      /// creates a grid of zero heights
+      HeightGrid(int width, int height);
+
+      /**
+       * \brief Maps width*height doubles at offset of file read-only.
+       * \returns NULL if the file could not be mapped.
+       */
+      static HeightGrid* mapFile(const std::string &file, size_t offset,
+                                 int width, int height);
+
+      /// adds a reference and returns this
+      HeightGrid* retain(void);
+      /// removes a reference; the grid is deleted with the last one
+      void release(void);
+
+      int getWidth(void) const {return width;}
+      int getHeight(void) const {return height;}
+      bool isMapped(void) const {return mapAddress != NULL;}
+      const double* getData(void) const {return data;}
+      /// may only be written by the creator before the grid is shared
+      double* getWritableData(void);
+
+      double get(int x, int y) const {
+        return data[(size_t)y*width+x];
+      }
+
+    private:
+      HeightGrid();
+      ~HeightGrid();
+      // grids are shared, not copied
+      HeightGrid(const HeightGrid &other);
+      HeightGrid& operator=(const HeightGrid &other);
+
+      double *data;
+      int width, height;
+      void *mapAddress;
+      size_t mapLength;
+      int refCount;
+      utils::Mutex refMutex;
+    }; // end of class HeightGrid
+
+  } // end of namespace interfaces
+} // end of namespace mars
+
+#endif /* MARS_INTERFACES_HEIGHT_GRID_H */
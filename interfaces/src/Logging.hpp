@@ -15,13 +15,13 @@
 #ifndef ROCK
 //Push the logging mechanism to mars if mars is used standalone
 #include <mars/data_broker/DataBrokerInterface.h>
-// use pushMessage() rather than pushError et al because pushMessage 
-// can also take a va_list.
-#define LOG_FATAL(...) if(mars::interfaces::ControlCenter::theDataBroker) (mars::interfaces::ControlCenter::theDataBroker->pushMessage(mars::data_broker::DB_MESSAGE_TYPE_FATAL, __VA_ARGS__))
-#define LOG_ERROR(...) if(mars::interfaces::ControlCenter::theDataBroker) (mars::interfaces::ControlCenter::theDataBroker->pushMessage(mars::data_broker::DB_MESSAGE_TYPE_ERROR, __VA_ARGS__))
-#define LOG_WARN(...) if(mars::interfaces::ControlCenter::theDataBroker) (mars::interfaces::ControlCenter::theDataBroker->pushMessage(mars::data_broker::DB_MESSAGE_TYPE_WARNING, __VA_ARGS__))
-#define LOG_INFO(...) if(mars::interfaces::ControlCenter::theDataBroker) (mars::interfaces::ControlCenter::theDataBroker->pushMessage(mars::data_broker::DB_MESSAGE_TYPE_INFO, __VA_ARGS__))
-#define LOG_DEBUG(...) if(mars::interfaces::ControlCenter::theDataBroker) (mars::interfaces::ControlCenter::theDataBroker->pushMessage(mars::data_broker::DB_MESSAGE_TYPE_DEBUG, __VA_ARGS__))
+// the messages are sent through ControlCenter::logMessage() which guards
+// theDataBroker against being replaced while a message is sent
+#define LOG_FATAL(...) mars::interfaces::ControlCenter::logMessage(mars::data_broker::DB_MESSAGE_TYPE_FATAL, __VA_ARGS__)
+#define LOG_ERROR(...) mars::interfaces::ControlCenter::logMessage(mars::data_broker::DB_MESSAGE_TYPE_ERROR, __VA_ARGS__)
+#define LOG_WARN(...) mars::interfaces::ControlCenter::logMessage(mars::data_broker::DB_MESSAGE_TYPE_WARNING, __VA_ARGS__)
+#define LOG_INFO(...) mars::interfaces::ControlCenter::logMessage(mars::data_broker::DB_MESSAGE_TYPE_INFO, __VA_ARGS__)
+#define LOG_DEBUG(...) mars::interfaces::ControlCenter::logMessage(mars::data_broker::DB_MESSAGE_TYPE_DEBUG, __VA_ARGS__)
 #else //ROCK
 //Useing the Rock logging system
 #include <base/Logging.hpp>
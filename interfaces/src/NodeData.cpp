@@ -66,7 +66,8 @@ namespace mars {
         "cylinder",
         "plane",
         "terrain",
-        "reference"
+        "reference",
+        "convex"
       };
 
     const char* NodeData::toString(const NodeType &type) {
@@ -268,6 +269,12 @@ namespace mars {
       GET_VALUE("angular_damping", angular_damping, Double);
       GET_VALUE("angular_low", angular_low, Double);
 
+      GET_VALUE("auto_disable", auto_disable, Int);
+      GET_VALUE("auto_disable_linear", auto_disable_linear, Double);
+      GET_VALUE("auto_disable_angular", auto_disable_angular, Double);
+      GET_VALUE("auto_disable_steps", auto_disable_steps, Int);
+      GET_VALUE("auto_disable_time", auto_disable_time, Double);
+
       GET_VALUE("shadow_id", shadow_id, Int);
       GET_VALUE("shadowcaster", isShadowCaster, Bool);
       GET_VALUE("shadowreceiver", isShadowReceiver, Bool);
@@ -367,6 +374,12 @@ namespace mars {
       SET_VALUE("angular_damping", angular_damping);
       SET_VALUE("angular_low", angular_low);
 
+      SET_VALUE("auto_disable", auto_disable);
+      SET_VALUE("auto_disable_linear", auto_disable_linear);
+      SET_VALUE("auto_disable_angular", auto_disable_angular);
+      SET_VALUE("auto_disable_steps", auto_disable_steps);
+      SET_VALUE("auto_disable_time", auto_disable_time);
+
       SET_VALUE("shadow_id", shadow_id);
       SET_VALUE("shadowcaster", isShadowCaster);
       SET_VALUE("shadowreceiver", isShadowReceiver);
@@ -88,6 +88,11 @@ namespace mars {
         angular_damping = 0;
         angular_treshold = 0;
         angular_low  = 0;
+        auto_disable = -1;
+        auto_disable_linear = -1;
+        auto_disable_angular = -1;
+        auto_disable_steps = -1;
+        auto_disable_time = -1;
         shadow_id = 0;
         isShadowCaster = false;
         isShadowReceiver = true;
@@ -179,6 +184,7 @@ namespace mars {
        * - NODE_TYPE_CYLINDER
        * - NODE_TYPE_PLANE
        * - NODE_TYPE_TERRAIN
+       * - NODE_TYPE_CONVEX
        * .
        * \verbatim Default value: NODE_TYPE_UNDEFINED \endverbatim
        */
@@ -371,6 +377,26 @@ namespace mars {
       sReal angular_damping;
       sReal angular_treshold;
       sReal angular_low;
+
+      /**
+       * Defines if the body may be disabled while it is at rest: -1 uses
+       * the global setting of the simulation, 0 keeps the body enabled
+       * and 1 enables the auto disable for this body.
+       * \verbatim Default value: -1 \endverbatim
+       */
+      int auto_disable;
+
+      /**
+       * The thresholds of the auto disable of this body: the body is
+       * disabled if its linear and angular velocity stay below the
+       * thresholds for the given number of steps and time. Negative values
+       * use the global thresholds. \verbatim Default value: -1 \endverbatim
+       */
+      sReal auto_disable_linear;
+      sReal auto_disable_angular;
+      int auto_disable_steps;
+      sReal auto_disable_time;
+
       int shadow_id;
 
       bool isShadowCaster;
@@ -27,12 +27,15 @@
 
 #include "core_objects_exchange.h"
 
+#include <mars/utils/BinaryBuffer.h>
 #include <mars/utils/ConfigData.h>
 #include <mars/utils/Quaternion.h>
 #include <mars/utils/Vector.h>
 
 #include <vector>
 #include <limits>
+#include <cstdlib>
+#include <cstring>
 
 
 namespace mars {
@@ -78,10 +81,52 @@ namespace mars {
         return 0;
       };
 
+      /**
+       * \brief Copies the current sensor values into a buffer provided by
+       * the caller.
+       *
+       * In contrast to getSensorData no memory is allocated, which makes
+       * this the preferred way to read sensors every simulation step. The
+       * default implementation falls back to getSensorData; sensors that
+       * are read frequently override it.
+       *
+       * \param data The buffer the values are written to.
+       * \param size The number of values \c data can hold.
+       * \returns The number of values written to \c data.
+       */
+      virtual int readSensorData(double *data, int size) const{
+        double *values = NULL;
+        int count = getSensorData(&values);
+        if(count > size) count = size;
+        if(count > 0) memcpy(data, values, sizeof(double)*count);
+        free(values);
+        return count;
+      }
+
       virtual int getAsciiData(char *data) const{
         return 0;
       }
 
+      /**
+       * \brief Writes the internal state of the sensor to a snapshot of
+       * the simulation (see SimulatorInterface::saveState).
+       *
+       * The default implementation stores nothing; sensors that keep values
+       * between steps (e.g. a scan in progress) override it together with
+       * restoreState.
+       */
+      virtual void saveState(utils::BinaryBuffer *buffer) const {
+      }
+
+      /**
+       * \brief Reads the state written by saveState. If \c apply is false
+       * the state is only checked and the sensor is not changed.
+       * \return false if the state could not be read from \c buffer.
+       */
+      virtual bool restoreState(utils::BinaryBuffer *buffer, bool apply) {
+        return true;
+      }
+
       void getCoreExchange(core_objects_exchange* obj) const{
         obj->index = id;
         obj->name = name;
@@ -30,14 +30,39 @@
 #define ROCK
 #include "ControlCenter.h"
 
-namespace mars {
+#include <mars/data_broker/DataBrokerInterface.h>
+#include <mars/utils/ReadWriteLock.h>
 
-  namespace data_broker {
-    class DataBrokerInterface;
-  }
+#include <cstdarg>
+
+namespace mars {
 
   namespace interfaces {
     data_broker::DataBrokerInterface *ControlCenter::theDataBroker = NULL;
+
+    // several simulators share theDataBroker; the messages are sent with
+    // the read lock, so a simulator can replace it with the write lock
+    // before its DataBroker is deleted
+    static utils::ReadWriteLock logLock;
+
+    void ControlCenter::setLogDataBroker(data_broker::DataBrokerInterface *dataBroker) {
+      logLock.lockForWrite();
+      theDataBroker = dataBroker;
+      logLock.unlock();
+    }
+
+    void ControlCenter::logMessage(int messageType, const std::string &format,
+                                   ...) {
+      logLock.lockForRead();
+      if(theDataBroker) {
+        va_list args;
+        va_start(args, format);
+        theDataBroker->pushMessage((data_broker::MessageType)messageType,
+                                   format, args);
+        va_end(args);
+      }
+      logLock.unlock();
+    }
   }
 
 } // end of namespace mars
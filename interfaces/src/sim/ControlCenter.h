@@ -49,6 +49,7 @@
 
 // Include stddef for basic defs like NULL
 #include <cstddef>
+#include <string>
 
 namespace mars {
   namespace main_gui {
@@ -106,7 +107,23 @@ namespace mars {
       data_broker::DataBrokerInterface *dataBroker;
       LoadCenter *loadCenter;
 
+      /**
+       * \brief The DataBroker that receives the messages of the LOG_*
+       * macros; it is only changed by setLogDataBroker().
+       */
       static data_broker::DataBrokerInterface *theDataBroker;
+
+      /**
+       * \brief Replaces theDataBroker. Returns after all messages to the
+       * old DataBroker are sent, thus it can be deleted afterwards.
+       */
+      static void setLogDataBroker(data_broker::DataBrokerInterface *dataBroker);
+
+      /**
+       * \brief Sends a message of the data_broker::MessageType to
+       * theDataBroker if one is set; used by the LOG_* macros.
+       */
+      static void logMessage(int messageType, const std::string &format, ...);
     };
 
   } // end of namespace interfaces
@@ -31,6 +31,16 @@
 namespace mars {
   namespace interfaces {
 
+    /**
+     * \brief The values of a joint that are read from the physics in every
+     * step, see JointInterface::update().
+     */
+    struct JointState {
+      sReal position1, position2;
+      sReal velocity1, velocity2;
+      utils::Vector anchor, axis1, axis2;
+    };
+
     class JointInterface {
     public:
       virtual ~JointInterface() {}
@@ -64,7 +74,11 @@ namespace mars {
       virtual void reattacheJoint(void) = 0;
       virtual void getAxisTorque(utils::Vector *t) const = 0;
       virtual void getAxis2Torque(utils::Vector *t) const = 0;
-      virtual void update(void) = 0;
+      /**
+       * \brief Calculates the axis torques and the joint load and fills the
+       * state; unlike the single getters it locks the physics only once.
+       */
+      virtual void update(JointState *state) = 0;
       virtual void getJointLoad(utils::Vector *t) const = 0;
       virtual void changeStepSize(const JointData &jointS) = 0;
       virtual sReal getMotorTorque(void) const = 0;
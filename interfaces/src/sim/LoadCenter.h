@@ -62,6 +62,10 @@ namespace mars {
     class LoadHeightmapInterface {
     public:
       virtual ~LoadHeightmapInterface() {}
+      /**
+       * \brief Sets terrain->heights from the image terrain->srcname;
+       * the heights stay NULL if the image could not be read.
+       */
       virtual void readPixelData(terrainStruct *terrain) = 0;
     };
 
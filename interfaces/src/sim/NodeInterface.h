@@ -81,6 +81,24 @@ namespace mars {
       virtual void getMass(sReal *mass, sReal *inertia=0) const = 0;
       virtual const utils::Vector getContactForce(void) const = 0;
       virtual sReal getCollisionDepth(void) const = 0;
+
+      /** number of values of a body state: position (3), rotation
+       *  quaternion (w, x, y, z), linear and angular velocity (3 each)
+       *  and 1 if the body is enabled, 0 if it was disabled by the
+       *  auto disable */
+      static const int BODY_STATE_SIZE = 14;
+
+      /**
+       * \brief Writes the dynamic state of the rigid body to \c state.
+       * \return false if the node has no body (static node)
+       */
+      virtual bool getBodyState(sReal *state) const = 0;
+
+      /**
+       * \brief Restores a state read by getBodyState; the accumulated
+       * forces of the body are cleared.
+       */
+      virtual void setBodyState(const sReal *state) = 0;
     };
 
   } // end of namespace interfaces
@@ -36,6 +36,7 @@
 #include <mars/utils/Vector.h>
 
 #include <vector>
+#include <string>
 
 namespace mars {
   namespace interfaces {
@@ -56,8 +57,98 @@ namespace mars {
       sReal step_size; /**< Step size in seconds */
       utils::Vector world_gravity;
       bool fast_step;
+      /** Number of iterations and over-relaxation factor of the solver
+       *  that is used with fast_step. If quickstep_max_error (meters) is
+       *  greater than 0 the iterations are adapted between
+       *  quickstep_min_iterations and quickstep_max_iterations: they are
+       *  raised when the largest joint error after a step exceeds the
+       *  limit and lowered again after a number of steps with an error
+       *  well below it. Changes are applied by the next step. */
+      int quickstep_iterations;
+      sReal quickstep_w;
+      sReal quickstep_max_error;
+      int quickstep_min_iterations, quickstep_max_iterations;
+      /** Iterations of the last fast step and its largest joint error */
+      int quickstep_num_iterations;
+      sReal quickstep_error;
       bool draw_contact_points;
       sReal world_cfm, world_erp;
+      /** Durations of the collision detection and of the solver during
+       *  the last step in microseconds */
+      double collision_time, solver_time;
+      /** If enabled a step is split into up to max_substeps substeps when
+       *  the deepest contact penetration or the largest joint error (both
+       *  in meters) exceeds its limit. A limit <= 0 is not checked. */
+      bool adaptive_step;
+      int max_substeps;
+      sReal max_penetration, max_joint_error;
+      /** Number of substeps of the last step */
+      int num_substeps;
+      /** Broadphase of the collision space: "hash", "quadtree", "sap",
+       *  "simple" or "auto". The hash levels are the log2 of the smallest
+       *  and the largest cell size; the quadtree extents are half sizes.
+       *  With "auto" the broadphase and its parameters are chosen from the
+       *  bounding boxes of the geoms when updateBroadphase() is called. */
+      std::string broadphase;
+      int hash_min_level, hash_max_level;
+      utils::Vector quadtree_center, quadtree_extents;
+      int quadtree_depth;
+      /** Number of contact joints created in the last step and number of
+       *  heap allocations made by the contact generation since the world
+       *  was created. The latter stays constant once the contact buffers
+       *  have grown to the size the scene needs. */
+      int num_contact_joints;
+      unsigned long contact_allocations;
+      /** The contacts of a geom pair are reduced to the deepest contact
+       *  and the contacts that span the largest area, at most
+       *  max_manifold_contacts (up to 16, 4 is a good choice for box
+       *  contacts); 0 keeps all contacts. */
+      int max_manifold_contacts;
+      /** The contacts of a geom pair are reused as long as neither geom
+       *  moved further than contact_cache_distance (meters) or rotated
+       *  more than contact_cache_angle (radians) since the contacts were
+       *  generated; a distance of 0 disables the cache. Contacts may stay
+       *  up to the thresholds after the geoms separated, so they should
+       *  be small compared to the geoms. num_cached_pairs is the number
+       *  of pairs whose contacts were reused in the last step. */
+      sReal contact_cache_distance, contact_cache_angle;
+      int num_cached_pairs;
+      /** Bodies whose linear and angular velocity stay below the
+       *  thresholds for auto_disable_steps steps and auto_disable_time
+       *  seconds are disabled (not integrated) until they are touched by
+       *  an enabled body or moved. Nodes can override the settings (see
+       *  NodeData::auto_disable). Changes are applied by the next step. */
+      bool auto_disable;
+      sReal auto_disable_linear, auto_disable_angular, auto_disable_time;
+      int auto_disable_steps;
+      /** Number of bodies and of disabled bodies after the last step and
+       *  number of disabled bodies that were enabled again since the
+       *  world was created; only counted while auto_disable is set */
+      int num_bodies, num_sleeping_bodies;
+      unsigned long num_wakeups;
+      /** Number of threads that solve the islands of the world in
+       *  parallel; values below 2 step the world in the calling thread.
+       *  Changes are applied by the next step. The threads draw from the
+       *  random generator of the solver in no fixed order, thus a
+       *  deterministic run has to use one thread. */
+      int solver_threads;
+      /** The number of bodies of every island of the last step, sorted in
+       *  descending order. An island is a group of enabled bodies that are
+       *  connected by joints or contacts; ODE solves the islands
+       *  independently of each other. Only determined while
+       *  solver_threads is larger than 1, empty otherwise. */
+      std::vector<int> island_sizes;
+      /** Terrains are split into tiles of terrain_tile_size cells of
+       *  which only the tiles closer than terrain_tile_margin (meters) to
+       *  a body take part in the collision; tiles are removed when no
+       *  body was close for terrain_tile_keep_steps steps. Bodies with
+       *  ray sensors use the range of the sensors if it is larger than
+       *  the margin. 0 keeps every
+       *  terrain in one heightfield. Applied to terrains created after
+       *  the change. */
+      int terrain_tile_size;
+      sReal terrain_tile_margin;
+      int terrain_tile_keep_steps;
 
       virtual ~PhysicsInterface() {}
       virtual void initTheWorld(void) = 0;
@@ -67,6 +158,16 @@ namespace mars {
       virtual const utils::Vector getCenterOfMass(const std::vector<NodeInterface*> &nodes) const = 0;
       virtual int checkCollisions(void) = 0;
       virtual sReal getVectorCollision(const utils::Vector &pos, const utils::Vector &ray) const = 0;
+      /** Recreates the collision spaces with the current broadphase
+       *  settings and moves all geoms into them. */
+      virtual void updateBroadphase(void) = 0;
+      /** Casts the rays the sensors collected during the node update. */
+      virtual void castRays(void) = 0;
+      /** The state of the random generator the solver uses to reorder
+       *  the constraints; ODE keeps one generator for the whole process.
+       *  A run is only reproducible if it starts with the same state. */
+      virtual unsigned long getRandomSeed(void) const = 0;
+      virtual void setRandomSeed(unsigned long seed) = 0;
     };
 
   } // end of namespace interfaces
@@ -154,6 +154,21 @@ namespace mars {
        * \param index The index of the sensor to get the data 
        */
       virtual int getSensorData(unsigned long id, sReal **data) const = 0;
+
+      /**
+       * \brief Copies the sensor data for a given index into a buffer
+       * provided by the caller without allocating memory.
+       *
+       * \param id The index of the sensor to get the data
+       *
+       * \param data The buffer the data is written to.
+       *
+       * \param size The number of values \c data can hold.
+       *
+       * \returns The number of values written to \c data.
+       */
+      virtual int readSensorData(unsigned long id, sReal *data,
+                                 int size) const = 0;
   
       /**
        *\brief Returns the number of sensors that are currently present in the simulation.
@@ -45,6 +45,10 @@ namespace lib_manager {
 
 namespace mars {
 
+  namespace utils {
+    class BinaryBuffer;
+  }
+
   namespace interfaces {
 
     class SimulatorInterface {
@@ -59,6 +63,26 @@ namespace mars {
       virtual void StartSimulation() = 0;
       virtual void StopSimulation() = 0;
       virtual void resetSim(void) = 0;
+
+      /**
+       * \brief Takes a snapshot of the dynamic state of the simulation:
+       * poses and velocities of the bodies, motor controller states,
+       * controller timing, sensor buffers and the simulation time.
+       *
+       * Restoring a snapshot is much faster than resetSim since no object
+       * is recreated; the scene must not have changed in between.
+       * \return A handle for restoreState and releaseState.
+       */
+      virtual unsigned long saveState(void) = 0;
+      virtual bool restoreState(unsigned long handle) = 0;
+      virtual void releaseState(unsigned long handle) = 0;
+
+      /**
+       * \brief Like saveState but writes the snapshot as compact binary
+       * blob into a buffer owned by the caller.
+       */
+      virtual void writeState(utils::BinaryBuffer *state) = 0;
+      virtual bool readState(utils::BinaryBuffer *state) = 0;
       virtual bool isSimRunning() const = 0;
       virtual bool startStopTrigger() = 0;
       virtual void singleStep(void) = 0;
@@ -105,6 +129,12 @@ namespace mars {
       virtual void allowDraw(void) = 0;
       virtual bool getAllowDraw(void) = 0;
       virtual bool getSyncGraphics(void) = 0;
+      /**
+       * \brief Blocks until the simulation allows to draw a frame or the
+       * timeout is reached.
+       * \return true if a frame can be drawn.
+       */
+      virtual bool waitForAllowDraw(unsigned long timeoutMilliseconds) = 0;
 
       //plugins
       virtual void addPlugin(const pluginStruct& plugin) = 0;
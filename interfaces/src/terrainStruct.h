@@ -22,6 +22,7 @@
 #define MARS_CORE_TERRAIN_STRUCT_H
 
 #include "MaterialData.h"
+#include "HeightGrid.h"
 #include <string>
 
 namespace mars {
@@ -30,6 +31,9 @@ namespace mars {
 
     /**
      * terrainStruct is a struct to exchange height maps between the GUI and the simulation
+     *
+     * The heights are shared: copies of a terrainStruct reference the same
+     * HeightGrid, which is released with the last of them.
      */
     struct terrainStruct {
       terrainStruct()
@@ -38,9 +42,49 @@ namespace mars {
           scale(1.0), 
           texScaleX(0.1),
           texScaleY(0.1),
-          pixelData(NULL),
+          heights(NULL),
           mesh(0) {}
 
+      terrainStruct(const terrainStruct &other) : heights(NULL) {
+        *this = other;
+      }
+
+      ~terrainStruct() {
+        if(heights) heights->release();
+      }
+
+      terrainStruct& operator=(const terrainStruct &other) {
+        // retained first for the assignment to itself
+        if(other.heights) other.heights->retain();
+        if(heights) heights->release();
+        name = other.name;
+        srcname = other.srcname;
+        material = other.material;
+        width = other.width;
+        height = other.height;
+        targetWidth = other.targetWidth;
+        targetHeight = other.targetHeight;
+        scale = other.scale;
+        texScaleX = other.texScaleX;
+        texScaleY = other.texScaleY;
+        heights = other.heights;
+        mesh = other.mesh;
+        return *this;
+      }
+
+      /**
+       * \brief Replaces the heights and sets width and height from the
+       * grid; the terrain takes over the reference of grid.
+       */
+      void setHeights(HeightGrid *grid) {
+        if(heights) heights->release();
+        heights = grid;
+        if(grid) {
+          width = grid->getWidth();
+          height = grid->getHeight();
+        }
+      }
+
       std::string name; //the joints name
       std::string srcname;
       MaterialData material;
@@ -50,7 +94,7 @@ namespace mars {
       double targetHeight;
       double scale;
       double texScaleX, texScaleY; // texture scaling - a value of 0 will fit the complete terrain
-      double *pixelData;
+      HeightGrid *heights;
       int mesh;
 
     }; // end of struct terrainStruct
@@ -0,0 +1,301 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+ /**
+ * \file BatchSimulator.cpp
+ * \author agent
+ * \brief "BatchSimulator" steps several independent simulations in lockstep
+ * and exchanges sensor and motor values via contiguous buffers.
+ *
+ */
+
+#include "BatchSimulator.h"
+#include "ThreadPool.h"
+
+#include <lib_manager/LibManager.hpp>
+#include <mars/interfaces/sim/SimulatorInterface.h>
+#include <mars/interfaces/sim/ControlCenter.h>
+#include <mars/interfaces/sim/SensorManagerInterface.h>
+#include <mars/interfaces/sim/MotorManagerInterface.h>
+#include <mars/cfg_manager/CFGManagerInterface.h>
+#include <mars/interfaces/Logging.hpp>
+#include <mars/utils/BinaryBuffer.h>
+
+#include <cstring>
+
+namespace mars {
+  namespace sim {
+
+    using namespace std;
+    using namespace interfaces;
+
+    /**
+     * \brief One simulation of the BatchSimulator. A world is a task of
+     * the thread pool that applies the actions, steps the simulation and
+     * reads the observations.
+     */
+    struct BatchWorld : public ThreadPoolTask {
+      BatchWorld() : libManager(NULL), marsSim(NULL), control(NULL),
+                     cfg(NULL), actions(NULL), observations(NULL),
+                     layout(NULL), numSteps(0), stepMs(10.), syncMs(40.),
+                     drawMs(0.), fault(false), hasInitialState(false) {
+      }
+
+      lib_manager::LibManager *libManager;
+      SimulatorInterface *marsSim;
+      ControlCenter *control;
+      cfg_manager::CFGManagerInterface *cfg;
+      vector<unsigned long> sensorIDs;
+      vector<unsigned long> motorIDs;
+      // views into the buffers of the BatchSimulator
+      const double *actions;
+      double *observations;
+      const vector<int> *layout;
+      int numSteps;
+      double stepMs, syncMs, drawMs;
+      bool fault;
+      // snapshot after loading the scene, used by reset
+      utils::BinaryBuffer initialState;
+      bool hasInitialState;
+
+      void runTask(void) {
+        if(actions) {
+          for(size_t i=0; i<motorIDs.size(); ++i) {
+            if(motorIDs[i]) control->motors->setMotorValue(motorIDs[i],
+                                                           actions[i]);
+          }
+        }
+        for(int i=0; i<numSteps && !fault; ++i) {
+          marsSim->step();
+          // handle requests and plugins at the rate the gui would draw
+          drawMs += stepMs;
+          if(drawMs >= syncMs) {
+            marsSim->finishedDraw();
+            drawMs = 0.;
+          }
+          fault = marsSim->hasSimFault();
+        }
+        readObservations();
+      }
+
+      void readObservations(void) {
+        double *p = observations;
+        for(size_t i=0; i<sensorIDs.size(); ++i) {
+          int size = (*layout)[i];
+          int count = 0;
+          if(sensorIDs[i]) {
+            count = control->sensors->readSensorData(sensorIDs[i], p, size);
+          }
+          if(count < size) memset(p+count, 0, sizeof(double)*(size-count));
+          p += size;
+        }
+      }
+    };
+
+    BatchSimulator::BatchSimulator(int numThreads) : observationSize(0) {
+      threadPool = new ThreadPool(numThreads);
+    }
+
+    BatchSimulator::~BatchSimulator() {
+      delete threadPool;
+      for(size_t i=0; i<worlds.size(); ++i) {
+        BatchWorld *world = worlds[i];
+        if(world->marsSim) {
+          world->marsSim->exitMars();
+          world->libManager->releaseLibrary("mars_scene_loader");
+          world->libManager->releaseLibrary("mars_sim");
+          world->libManager->releaseLibrary("cfg_manager");
+          world->libManager->releaseLibrary("data_broker");
+        }
+        delete world->libManager;
+        delete world;
+      }
+    }
+
+    bool BatchSimulator::createWorlds(const string &configDir, int numWorlds,
+                                      double calcMs) {
+      // the libraries are loaded one after the other, only stepping is
+      // done in parallel
+      for(int i=0; i<numWorlds; ++i) {
+        BatchWorld *world = new BatchWorld();
+        worlds.push_back(world);
+        world->libManager = new lib_manager::LibManager();
+        world->libManager->loadConfigFile(configDir+"/core_libs-nogui.txt");
+
+        world->cfg = world->libManager->getLibraryAs<cfg_manager::CFGManagerInterface>("cfg_manager");
+        if(world->cfg) {
+          cfg_manager::cfgPropertyStruct configPath;
+          configPath = world->cfg->getOrCreateProperty("Config", "config_path",
+                                                       configDir);
+          configPath.sValue = configDir;
+          world->cfg->setProperty(configPath);
+        }
+
+        world->marsSim = world->libManager->getLibraryAs<SimulatorInterface>("mars_sim");
+        if(!world->marsSim) {
+          LOG_ERROR("BatchSimulator: could not load mars_sim for world %d", i);
+          return false;
+        }
+        world->control = world->marsSim->getControlCenter();
+        // the simulation thread is not started, the pool steps the world
+        world->marsSim->runSimulation(false);
+        if(world->cfg) {
+          if(calcMs > 0.) {
+            world->cfg->setPropertyValue("Simulator", "calc_ms", "value",
+                                         calcMs);
+          }
+          world->cfg->getPropertyValue("Simulator", "calc_ms", "value",
+                                       &world->stepMs);
+          world->cfg->getPropertyValue("Simulator", "sync time", "value",
+                                       &world->syncMs);
+        }
+      }
+      observations.resize(worlds.size()*observationSize, 0.);
+      return true;
+    }
+
+    bool BatchSimulator::loadScene(const string &filename) {
+      for(size_t i=0; i<worlds.size(); ++i) {
+        if(!worlds[i]->marsSim->loadScene(filename)) {
+          LOG_ERROR("BatchSimulator: could not load scene \"%s\"",
+                    filename.c_str());
+          return false;
+        }
+        // activate the plugins that were added while loading
+        worlds[i]->marsSim->finishedDraw();
+        resolveIDs(worlds[i]);
+        worlds[i]->marsSim->writeState(&worlds[i]->initialState);
+        worlds[i]->hasInitialState = true;
+      }
+      return true;
+    }
+
+    int BatchSimulator::addObservation(const string &sensorName, int size) {
+      if(worlds.empty() || size <= 0 ||
+         !worlds[0]->control->sensors->getSensorID(sensorName)) {
+        LOG_ERROR("BatchSimulator: no sensor \"%s\"", sensorName.c_str());
+        return -1;
+      }
+      Observation observation;
+      observation.sensorName = sensorName;
+      observation.offset = observationSize;
+      observation.size = size;
+      observationLayout.push_back(observation);
+      observationSizes.push_back(size);
+      observationSize += size;
+      observations.assign(worlds.size()*observationSize, 0.);
+      for(size_t i=0; i<worlds.size(); ++i) {
+        resolveIDs(worlds[i]);
+      }
+      return observation.offset;
+    }
+
+    int BatchSimulator::addAction(const string &motorName) {
+      if(worlds.empty() || !worlds[0]->control->motors->getID(motorName)) {
+        LOG_ERROR("BatchSimulator: no motor \"%s\"", motorName.c_str());
+        return -1;
+      }
+      actionLayout.push_back(motorName);
+      for(size_t i=0; i<worlds.size(); ++i) {
+        resolveIDs(worlds[i]);
+      }
+      return (int)actionLayout.size()-1;
+    }
+
+    void BatchSimulator::resolveIDs(BatchWorld *world) {
+      world->layout = &observationSizes;
+      world->sensorIDs.resize(observationLayout.size());
+      for(size_t i=0; i<observationLayout.size(); ++i) {
+        world->sensorIDs[i] = world->control->sensors->getSensorID(observationLayout[i].sensorName);
+      }
+      world->motorIDs.resize(actionLayout.size());
+      for(size_t i=0; i<actionLayout.size(); ++i) {
+        world->motorIDs[i] = world->control->motors->getID(actionLayout[i]);
+      }
+    }
+
+    void BatchSimulator::reset(void) {
+      for(size_t i=0; i<worlds.size(); ++i) {
+        reset((int)i);
+      }
+    }
+
+    void BatchSimulator::reset(int world) {
+      BatchWorld *w = worlds[world];
+      // restoring the snapshot is much faster than reloading the scene;
+      // after a physics error the world is reloaded to be safe
+      if(w->fault || !w->hasInitialState ||
+         !w->marsSim->readState(&w->initialState)) {
+        // the reload is done in finishedDraw since the simulation thread
+        // is not running
+        w->marsSim->resetSim();
+        w->marsSim->finishedDraw();
+        // the reload recreates the sensors and motors
+        resolveIDs(w);
+      }
+      w->drawMs = 0.;
+      w->fault = false;
+      w->observations = observationSize ?
+        &observations[world*observationSize] : NULL;
+      w->readObservations();
+    }
+
+    void BatchSimulator::step(const double *actions, int numSteps) {
+      const int actionSize = (int)actionLayout.size();
+      for(size_t i=0; i<worlds.size(); ++i) {
+        BatchWorld *world = worlds[i];
+        world->actions = actions ? actions + i*actionSize : NULL;
+        world->observations = observationSize ?
+          &observations[i*observationSize] : NULL;
+        world->numSteps = numSteps;
+        threadPool->addTask(world);
+      }
+      threadPool->waitForTasks();
+      for(size_t i=0; i<worlds.size(); ++i) {
+        worlds[i]->actions = NULL;
+      }
+    }
+
+    const double* BatchSimulator::getObservations(void) const {
+      return observations.empty() ? NULL : &observations[0];
+    }
+
+    int BatchSimulator::getNumWorlds(void) const {
+      return (int)worlds.size();
+    }
+
+    int BatchSimulator::getObservationSize(void) const {
+      return observationSize;
+    }
+
+    int BatchSimulator::getActionSize(void) const {
+      return (int)actionLayout.size();
+    }
+
+    bool BatchSimulator::hasFault(int world) const {
+      return worlds[world]->fault;
+    }
+
+    SimulatorInterface* BatchSimulator::getSimulator(int world) const {
+      return worlds[world]->marsSim;
+    }
+
+  } // end of namespace sim
+} // end of namespace mars
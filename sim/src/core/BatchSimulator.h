@@ -0,0 +1,187 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+ /**
+ * \file BatchSimulator.h
+ * \author agent
+ * \brief "BatchSimulator" steps several independent simulations in lockstep
+ * and exchanges sensor and motor values via contiguous buffers.
+ *
+ */
+
+#ifndef BATCH_SIMULATOR_H
+#define BATCH_SIMULATOR_H
+
+#ifdef _PRINT_HEADER_
+  #warning "BatchSimulator.h"
+#endif
+
+#include <string>
+#include <vector>
+
+namespace mars {
+
+  namespace interfaces {
+    class SimulatorInterface;
+  }
+
+  namespace sim {
+
+    class ThreadPool;
+    struct BatchWorld;
+
+    /**
+     * \brief The BatchSimulator runs K simulations ("worlds") without
+     * graphics, e.g. as environments for reinforcement learning.
+     *
+     * Every world is loaded by its own LibManager, so the worlds do not
+     * share any state. step() writes the actions of all worlds into the
+     * motors, steps the worlds in parallel on a ThreadPool and reads the
+     * sensors of every world into one observation buffer of the layout
+     * double[K][getObservationSize()]. The sensors are read via
+     * BaseSensor::readSensorData, thus no memory is allocated per step.
+     *
+     * Usage:
+     * \code
+     * BatchSimulator batch;
+     * batch.createWorlds(configDir, 16);
+     * batch.loadScene("robot.scn");
+     * batch.addObservation("joint_positions", 6);
+     * batch.addAction("motor_1");
+     * batch.reset();
+     * while(learning) {
+     *   batch.step(actions); // actions: double[16][getActionSize()]
+     *   learner(batch.getObservations());
+     * }
+     * \endcode
+     */
+    class BatchSimulator {
+    public:
+      /**
+       * \param numThreads The number of worker threads of the pool,
+       * see ThreadPool::ThreadPool.
+       */
+      explicit BatchSimulator(int numThreads = -1);
+      ~BatchSimulator();
+
+      /**
+       * \brief Loads \c numWorlds simulations with the libraries listed in
+       * configDir/core_libs-nogui.txt.
+       *
+       * \param calcMs The physics step size; the configured value is used
+       * if zero.
+       */
+      bool createWorlds(const std::string &configDir, int numWorlds,
+                        double calcMs = 0.);
+
+      /**
+       * \brief Loads the scene into all worlds.
+       */
+      bool loadScene(const std::string &filename);
+
+      /**
+       * \brief Appends the values of a sensor to the observation vector.
+       *
+       * Sensors that provide less values than \c size are padded with
+       * zeros, additional values are dropped.
+       *
+       * \returns The offset of the sensor values in the observation
+       * vector of a world or -1 if the sensor does not exist.
+       */
+      int addObservation(const std::string &sensorName, int size);
+
+      /**
+       * \brief Appends a motor to the action vector.
+       *
+       * \returns The index of the motor in the action vector of a world
+       * or -1 if the motor does not exist.
+       */
+      int addAction(const std::string &motorName);
+
+      /**
+       * \brief Resets all worlds to the state after loading the scenes and
+       * updates the observations.
+       *
+       * The worlds are reset from a snapshot taken by loadScene (see
+       * SimulatorInterface::saveState); a world with a physics error is
+       * reloaded instead.
+       */
+      void reset(void);
+
+      /**
+       * \brief Resets one world and updates its observations.
+       */
+      void reset(int world);
+
+      /**
+       * \brief Sets the motor values, advances every world by \c numSteps
+       * physics steps and updates the observations.
+       *
+       * \param actions The motor values of all worlds in the layout
+       * double[getNumWorlds()][getActionSize()]. If NULL the motor values
+       * are not changed.
+       */
+      void step(const double *actions, int numSteps = 1);
+
+      /**
+       * \returns The observations of all worlds in the layout
+       * double[getNumWorlds()][getObservationSize()]. The buffer stays
+       * valid until the observation layout changes.
+       */
+      const double* getObservations(void) const;
+
+      int getNumWorlds(void) const;
+      int getObservationSize(void) const;
+      int getActionSize(void) const;
+
+      /**
+       * \returns \c true if the physics of the world reported an error
+       * since its last reset.
+       */
+      bool hasFault(int world) const;
+
+      interfaces::SimulatorInterface* getSimulator(int world) const;
+
+    private:
+      struct Observation {
+        std::string sensorName;
+        int offset;
+        int size;
+      };
+
+      std::vector<BatchWorld*> worlds;
+      std::vector<Observation> observationLayout;
+      std::vector<int> observationSizes;
+      std::vector<std::string> actionLayout;
+      std::vector<double> observations;
+      ThreadPool *threadPool;
+      int observationSize;
+
+      void resolveIDs(BatchWorld *world);
+
+      // disallow copying
+      BatchSimulator(const BatchSimulator &);
+      BatchSimulator &operator=(const BatchSimulator &);
+    };
+
+  } // end of namespace sim
+} // end of namespace mars
+
+#endif  // BATCH_SIMULATOR_H
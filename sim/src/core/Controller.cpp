@@ -151,6 +151,18 @@ namespace mars {
       obj->name  = "";
     }
 
+    /**
+     * \brief Stores the time since the last controller update, so the
+     * controller is called at the same steps after a restore.
+     */
+    void Controller::saveState(utils::BinaryBuffer *buffer) const {
+      buffer->write(count_ms);
+    }
+
+    bool Controller::restoreState(utils::BinaryBuffer *buffer, bool apply) {
+      return buffer->readOrSkip(&count_ms, apply);
+    }
+
     void Controller::update(sReal time_ms) {
       std::vector<BaseSensor*>::iterator iter;
       std::vector<SimMotor*>::iterator jter;
@@ -161,8 +173,7 @@ namespace mars {
       double *pt_sensors = t_sensors;
       double t_motors[100];
       double *pt_motors = t_motors;
-      int flags = 0, count_val, i, command;
-      sReal *sens_val;
+      int flags = 0, i, command;
       char *other_stuff = 0;
       char *pt_stuff;
       unsigned long command_id = 0;
@@ -175,9 +186,8 @@ namespace mars {
         if (dylibController) {
           for (i=0; i<100; i++) t_sensors[i] = t_motors[i] = 0;
           for (iter = sensors.begin(); iter != sensors.end(); iter++) {
-            count_val = (*iter)->getSensorData(&sens_val);
-            for(i=0; i<count_val; i++) *(pt_sensors++) = (double)sens_val[i];
-            free(sens_val);
+            pt_sensors += (*iter)->readSensorData(pt_sensors,
+                                                  t_sensors+255-pt_sensors);
           }
           /*
           if (sParams.size()) {
@@ -406,7 +416,8 @@ namespace mars {
           }
           else {
             for (jter = motors.begin(); jter != motors.end(); jter++, pt_motors++)
-              (*jter)->setValue((sReal)*pt_motors);
+              control->motors->setMotorValue((*jter)->getIndex(),
+                                             (sReal)*pt_motors);
           }
         }
         else if(connected) {
@@ -465,7 +476,8 @@ namespace mars {
                  jter != motors.end(); jter++) {
               p += getSReal(p, &value);
               value *= 0.01745329251994;
-              (*jter)->setValue((sReal)value);
+              control->motors->setMotorValue((*jter)->getIndex(),
+                                             (sReal)value);
             }
           }
           //the protocol is very simple
@@ -503,7 +515,8 @@ namespace mars {
                   //assert(id=< motors.size());
                   p += getSReal(p, &value);
                   //value *= 0.01745329251994;
-                  motors[id]->setValue((sReal)value);
+                  control->motors->setMotorValue(motors[id]->getIndex(),
+                                                 (sReal)value);
 
                   // p += getChar(p, &cmd);
                   getChar(p, &cmd);
@@ -73,6 +73,8 @@ namespace mars {
                  interfaces::ControlCenter *control, int portn=1500);
       virtual ~Controller(void);
       virtual void update(interfaces::sReal time_ms);
+      void saveState(utils::BinaryBuffer *buffer) const;
+      bool restoreState(utils::BinaryBuffer *buffer, bool apply);
       virtual std::list<interfaces::sReal> getSensorValues(void);
 
       void handleError(void);
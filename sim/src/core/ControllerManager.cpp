@@ -260,6 +260,31 @@ namespace mars {
      *
      * \param calc_ms The timing value in miliseconds.
      */
+    void ControllerManager::saveState(utils::BinaryBuffer *buffer) const {
+      std::map<unsigned long, Controller*>::const_iterator iter;
+      MutexLocker locker(&iMutex);
+      buffer->write((unsigned long)simController.size());
+      for(iter = simController.begin(); iter != simController.end(); ++iter) {
+        buffer->write((unsigned long)iter->first);
+        iter->second->saveState(buffer);
+      }
+    }
+
+    bool ControllerManager::restoreState(utils::BinaryBuffer *buffer,
+                                         bool apply) {
+      std::map<unsigned long, Controller*>::iterator iter;
+      unsigned long count, id;
+      MutexLocker locker(&iMutex);
+      if(!buffer->read(&count) || count != simController.size()) return false;
+      for(iter = simController.begin(); iter != simController.end(); ++iter) {
+        if(!buffer->read(&id) || id != (unsigned long)iter->first ||
+           !iter->second->restoreState(buffer, apply)) {
+          return false;
+        }
+      }
+      return true;
+    }
+
     void ControllerManager::updateControllers(double calc_ms) {
       MutexLocker locker(&iMutex);
 
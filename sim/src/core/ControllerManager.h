@@ -182,6 +182,20 @@ namespace mars {
        */
       virtual void updateControllers(interfaces::sReal calc_ms);
 
+      /**
+       * \brief Writes the dynamic state of all controllers to a simulation
+       * snapshot.
+       */
+      void saveState(utils::BinaryBuffer *buffer) const;
+
+      /**
+       * \brief Reads a snapshot; if \c apply is false the snapshot is only
+       * checked and nothing is changed.
+       * \return false if the snapshot does not match the controllers of the
+       * current scene.
+       */
+      bool restoreState(utils::BinaryBuffer *buffer, bool apply);
+
       /**
        * \brief Resets the data of all controllers.
        */
@@ -0,0 +1,335 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+ /**
+ * \file GeometryLoader.cpp
+ * \author agent
+ * \brief "GeometryLoader" reads mesh and heightmap files for the physics
+ * without any dependency to the graphics library.
+ *
+ */
+
+#include "GeometryLoader.h"
+
+#include <mars/interfaces/NodeData.h>
+#include <mars/interfaces/terrainStruct.h>
+#include <mars/interfaces/sim/ControlCenter.h>
+#include <mars/interfaces/Logging.hpp>
+#include <mars/utils/misc.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cctype> // for tolower()
+
+namespace mars {
+  namespace sim {
+
+    using namespace std;
+    using namespace utils;
+    using namespace interfaces;
+
+    GeometryLoader::GeometryLoader() {
+    }
+
+    GeometryLoader::~GeometryLoader() {
+    }
+
+    void GeometryLoader::getPhysicsFromOBJ(NodeData *node) {
+      vector<Vector> vertices;
+      vector<Face> faces;
+      bool ok = false;
+
+      string suffix = getFilenameSuffix(node->filename);
+      std::transform(suffix.begin(), suffix.end(), suffix.begin(), ::tolower);
+
+      if(suffix == ".obj") {
+        ok = readOBJ(node->filename, node->origName, &vertices, &faces);
+      } else if(suffix == ".stl") {
+        ok = readSTL(node->filename, &vertices, &faces);
+      } else {
+        LOG_ERROR("GeometryLoader: unsupported mesh format \"%s\"",
+                  node->filename.c_str());
+      }
+      if(!ok || faces.empty()) {
+        LOG_ERROR("GeometryLoader: could not load mesh from \"%s\"",
+                  node->filename.c_str());
+        return;
+      }
+
+      // only take the vertices that are referenced by the faces into account
+      // for the bounding box, like the osg bounding box visitor does
+      vector<int> remap(vertices.size(), -1);
+      vector<Vector> used;
+      used.reserve(vertices.size());
+      for(size_t i=0; i<faces.size(); ++i) {
+        for(int k=0; k<3; ++k) {
+          int &idx = faces[i].v[k];
+          if(remap[idx] < 0) {
+            remap[idx] = (int)used.size();
+            used.push_back(vertices[idx]);
+          }
+          idx = remap[idx];
+        }
+      }
+
+      Vector bbMin = used[0], bbMax = used[0];
+      for(size_t i=1; i<used.size(); ++i) {
+        bbMin = bbMin.cwiseMin(used[i]);
+        bbMax = bbMax.cwiseMax(used[i]);
+      }
+      Vector ex = bbMax - bbMin;
+
+      double scaleX = 1, scaleY = 1, scaleZ = 1;
+      if (ex.x() != 0) scaleX = node->visual_size.x() / ex.x();
+      if (ex.y() != 0) scaleY = node->visual_size.y() / ex.y();
+      if (ex.z() != 0) scaleZ = node->visual_size.z() / ex.z();
+
+      snmesh mesh;
+      mesh.vertexcount = used.size();
+      mesh.vertices = new mydVector3[mesh.vertexcount];
+      for(int i=0; i<mesh.vertexcount; ++i) {
+        mesh.vertices[i][0] = (used[i].x() - node->pivot.x()) * scaleX;
+        mesh.vertices[i][1] = (used[i].y() - node->pivot.y()) * scaleY;
+        mesh.vertices[i][2] = (used[i].z() - node->pivot.z()) * scaleZ;
+        mesh.vertices[i][3] = 0;
+      }
+      mesh.indexcount = faces.size()*3;
+      mesh.indices = new int[mesh.indexcount];
+      for(size_t i=0; i<faces.size(); ++i) {
+        mesh.indices[i*3] = faces[i].v[0];
+        mesh.indices[i*3+1] = faces[i].v[1];
+        mesh.indices[i*3+2] = faces[i].v[2];
+      }
+      node->mesh = mesh;
+    }
+
+    bool GeometryLoader::readOBJ(const string &filename, const string &objName,
+                                 vector<Vector> *vertices,
+                                 vector<Face> *faces) {
+      ifstream file(filename.c_str());
+      if(!file.good()) return false;
+
+      vector<Face> allFaces;
+      string line, token, name;
+      vector<int> poly;
+
+      while(getline(file, line)) {
+        istringstream in(line);
+        if(!(in >> token)) continue;
+
+        if(token == "v") {
+          Vector v(0, 0, 0);
+          in >> v.x() >> v.y() >> v.z();
+          vertices->push_back(v);
+        } else if(token == "o" || token == "g") {
+          name.clear();
+          in >> name;
+        } else if(token == "f") {
+          poly.clear();
+          while(in >> token) {
+            // only the vertex index of "v/vt/vn" is needed
+            int idx = atoi(token.c_str());
+            if(idx < 0) idx += (int)vertices->size();
+            else idx -= 1;
+            if(idx < 0 || idx >= (int)vertices->size()) {
+              LOG_WARN("GeometryLoader: invalid face index in \"%s\"",
+                       filename.c_str());
+              poly.clear();
+              break;
+            }
+            poly.push_back(idx);
+          }
+          // triangulate polygons as fan
+          for(size_t i=2; i<poly.size(); ++i) {
+            Face face;
+            face.v[0] = poly[0];
+            face.v[1] = poly[i-1];
+            face.v[2] = poly[i];
+            allFaces.push_back(face);
+            if(name == objName) faces->push_back(face);
+          }
+        }
+      }
+      // no matching object: use the complete file
+      if(faces->empty()) faces->swap(allFaces);
+      return true;
+    }
+
+    bool GeometryLoader::readSTL(const string &filename,
+                                 vector<Vector> *vertices,
+                                 vector<Face> *faces) {
+      FILE *file = fopen(filename.c_str(), "rb");
+      if(!file) return false;
+
+      char header[80];
+      unsigned int numTriangles = 0;
+      fseek(file, 0, SEEK_END);
+      long fileSize = ftell(file);
+      fseek(file, 0, SEEK_SET);
+
+      bool binary = false;
+      if(fread(header, 1, 80, file) == 80 &&
+         fread(&numTriangles, 4, 1, file) == 1) {
+        // ascii files start with "solid" but some exporters also write
+        // this into the header of binary files; the size decides
+        binary = (fileSize == 84 + 50*(long)numTriangles);
+      }
+
+      if(binary) {
+        float data[12];
+        unsigned short attribute;
+        vertices->reserve(numTriangles*3);
+        faces->reserve(numTriangles);
+        for(unsigned int i=0; i<numTriangles; ++i) {
+          if(fread(data, sizeof(float), 12, file) != 12 ||
+             fread(&attribute, 2, 1, file) != 1) {
+            fclose(file);
+            return false;
+          }
+          Face face;
+          // data[0..2] is the facet normal
+          for(int k=0; k<3; ++k) {
+            face.v[k] = (int)vertices->size();
+            vertices->push_back(Vector(data[3+k*3], data[4+k*3],
+                                       data[5+k*3]));
+          }
+          faces->push_back(face);
+        }
+        fclose(file);
+        return true;
+      }
+      fclose(file);
+
+      ifstream in(filename.c_str());
+      string token;
+      int count = 0;
+      Face face;
+      while(in >> token) {
+        if(token == "vertex") {
+          Vector v;
+          in >> v.x() >> v.y() >> v.z();
+          face.v[count++] = (int)vertices->size();
+          vertices->push_back(v);
+          if(count == 3) {
+            faces->push_back(face);
+            count = 0;
+          }
+        } else if(token == "endloop") {
+          count = 0;
+        }
+      }
+      return !faces->empty();
+    }
+
+    void GeometryLoader::readPixelData(terrainStruct *terrain) {
+      string suffix = getFilenameSuffix(terrain->srcname);
+      std::transform(suffix.begin(), suffix.end(), suffix.begin(), ::tolower);
+
+      if(suffix == ".pgm") {
+        if(!readPGM(terrain->srcname, terrain)) {
+          LOG_ERROR("GeometryLoader: could not read heightmap \"%s\"",
+                    terrain->srcname.c_str());
+        }
+      } else {
+        LOG_ERROR("GeometryLoader: unsupported heightmap format \"%s\"",
+                  terrain->srcname.c_str());
+      }
+    }
+
+    /**
+     * Reads the next header value of a pgm file and skips comments.
+     */
+    static bool readPGMValue(FILE *file, int *value) {
+      int c = fgetc(file);
+      while(c != EOF) {
+        if(c == '#') {
+          while(c != EOF && c != '\n') c = fgetc(file);
+        } else if(!isspace(c)) {
+          break;
+        }
+        c = fgetc(file);
+      }
+      if(c == EOF) return false;
+      ungetc(c, file);
+      return fscanf(file, "%d", value) == 1;
+    }
+
+    bool GeometryLoader::readPGM(const string &filename,
+                                 terrainStruct *terrain) {
+      FILE *file = fopen(filename.c_str(), "rb");
+      if(!file) return false;
+
+      char magic[2];
+      int width, height, maxValue;
+      if(fread(magic, 1, 2, file) != 2 || magic[0] != 'P' ||
+         (magic[1] != '2' && magic[1] != '5') ||
+         !readPGMValue(file, &width) || !readPGMValue(file, &height) ||
+         !readPGMValue(file, &maxValue) ||
+         width <= 0 || height <= 0 || maxValue <= 0 || maxValue > 65535) {
+        fclose(file);
+        return false;
+      }
+      // exactly one whitespace separates the header from binary data
+      fgetc(file);
+
+      vector<double> image((size_t)width*height);
+      bool ok = true;
+      if(magic[1] == '5') {
+        int bytes = (maxValue > 255) ? 2 : 1;
+        vector<unsigned char> row((size_t)width*bytes);
+        for(int y=0; y<height && ok; ++y) {
+          ok = fread(&row[0], 1, row.size(), file) == row.size();
+          for(int x=0; ok && x<width; ++x) {
+            // 16 bit values are stored big endian
+            int v = (bytes == 2) ? (row[x*2] << 8) | row[x*2+1] : row[x];
+            image[(size_t)y*width+x] = (double)v / maxValue;
+          }
+        }
+      } else {
+        int v;
+        for(size_t i=0; i<image.size() && ok; ++i) {
+          ok = fscanf(file, "%d", &v) == 1;
+          image[i] = (double)v / maxValue;
+        }
+      }
+      fclose(file);
+      if(!ok) return false;
+
+      HeightGrid *grid = new HeightGrid(width, height);
+      double *heights = grid->getWritableData();
+      // same memory layout as GuiHelper::readPixelData: starting with the
+      // top row of the image, each row from right to left
+      int count = 0;
+      for(int y=0; y<height; ++y) {
+        for(int x=width-1; x>=0; --x) {
+          heights[count++] = image[(size_t)y*width+x];
+        }
+      }
+      terrain->setHeights(grid);
+      return true;
+    }
+
+  } // end of namespace sim
+} // end of namespace mars
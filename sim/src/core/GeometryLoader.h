@@ -0,0 +1,98 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+ /**
+ * \file GeometryLoader.h
+ * \author agent
+ * \brief "GeometryLoader" reads mesh and heightmap files for the physics
+ * without any dependency to the graphics library.
+ *
+ */
+
+#ifndef GEOMETRY_LOADER_H
+#define GEOMETRY_LOADER_H
+
+#ifdef _PRINT_HEADER_
+  #warning "GeometryLoader.h"
+#endif
+
+#include <mars/interfaces/sim/LoadCenter.h>
+#include <mars/interfaces/snmesh.h>
+#include <mars/utils/Vector.h>
+
+#include <string>
+#include <vector>
+
+namespace mars {
+  namespace sim {
+
+    /**
+     * \brief The GeometryLoader is the default LoadMeshInterface and
+     * LoadHeightmapInterface of the simulation.
+     *
+     * It is used when no graphics library is loaded (e.g. in headless
+     * batch runs). Meshes are read from Wavefront .obj and from ascii or
+     * binary .stl files; heightmaps are read from .pgm (P2/P5) files.
+     * The resulting data follows the conventions of
+     * graphics::GuiHelper, so a scene creates the same physics with and
+     * without mars_graphics.
+     */
+    class GeometryLoader : public interfaces::LoadMeshInterface,
+                           public interfaces::LoadHeightmapInterface {
+    public:
+      GeometryLoader();
+      virtual ~GeometryLoader();
+
+      /**
+       * \brief Fills node->mesh from node->filename.
+       *
+       * For .obj files only the object or group named node->origName is
+       * used; if no such object exists the whole file is used. The mesh is
+       * scaled to node->visual_size and shifted by node->pivot.
+       */
+      virtual void getPhysicsFromOBJ(interfaces::NodeData *node);
+
+      /**
+       * \brief Sets terrain->heights to the normalized heights (0..1)
+       * read from terrain->srcname and sets width and height.
+       *
+       * post: terrain->heights is NULL if the file could not be read
+       */
+      virtual void readPixelData(interfaces::terrainStruct *terrain);
+
+    private:
+      struct Face {
+        int v[3];
+      };
+
+      bool readOBJ(const std::string &filename, const std::string &objName,
+                   std::vector<utils::Vector> *vertices,
+                   std::vector<Face> *faces);
+      bool readSTL(const std::string &filename,
+                   std::vector<utils::Vector> *vertices,
+                   std::vector<Face> *faces);
+      bool readPGM(const std::string &filename,
+                   interfaces::terrainStruct *terrain);
+    };
+
+  } // end of namespace sim
+} // end of namespace mars
+
+#endif  // GEOMETRY_LOADER_H
@@ -0,0 +1,147 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+ /**
+ * \file HeightFile.cpp
+ * \author agent
+ * \brief "HeightFile" stores decoded heightmaps in binary files that are
+ * mapped read-only into memory.
+ *
+ */
+
+#include "HeightFile.h"
+
+#include <mars/interfaces/terrainStruct.h>
+#include <mars/interfaces/sim/LoadCenter.h>
+#include <mars/interfaces/sim/ControlCenter.h>
+#include <mars/interfaces/Logging.hpp>
+#include <mars/utils/misc.h>
+
+#include <cstdio>
+#include <cstring>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+namespace mars {
+  namespace sim {
+
+    using namespace std;
+    using namespace utils;
+    using namespace interfaces;
+
+    /**
+     * \brief The header of a height file; the heights follow as doubles.
+     * The size of the header keeps the heights aligned.
+     */
+    struct HeightFile::Header {
+      char magic[8];
+      int width, height;
+      long long sourceTime, sourceSize;
+    };
+
+    static const char heightFileMagic[8] = {'M','A','R','S','H','G','T','1'};
+
+    string HeightFile::getFileName(const string &cacheDir,
+                                   const string &srcname) {
+      // FNV-1a over the name of the image
+      unsigned long long hash = 14695981039346656037ULL;
+      for(size_t i=0; i<srcname.size(); ++i) {
+        hash ^= (unsigned char)srcname[i];
+        hash *= 1099511628211ULL;
+      }
+      char name[32];
+      sprintf(name, "%016llx.height", hash);
+      return cacheDir + "/" + name;
+    }
+
+    bool HeightFile::load(const string &cacheDir, terrainStruct *terrain,
+                          LoadHeightmapInterface *loader) {
+      Header header;
+      struct stat st;
+      memset(&header, 0, sizeof(Header));
+      memcpy(header.magic, heightFileMagic, sizeof(header.magic));
+      if(stat(terrain->srcname.c_str(), &st) == 0) {
+        header.sourceTime = (long long)st.st_mtime;
+        header.sourceSize = (long long)st.st_size;
+      }
+      string file = getFileName(cacheDir, terrain->srcname);
+      if(mapFile(file, header, terrain)) return true;
+
+      loader->readPixelData(terrain);
+      if(!terrain->heights) return false;
+      header.width = terrain->heights->getWidth();
+      header.height = terrain->heights->getHeight();
+      if(!writeFile(cacheDir, file, header, terrain->heights->getData())) {
+        LOG_WARN("HeightFile: could not write %s", file.c_str());
+        return true;
+      }
+      // the mapping replaces the decoded heights
+      mapFile(file, header, terrain);
+      return true;
+    }
+
+    bool HeightFile::mapFile(const string &file, const Header &expected,
+                             terrainStruct *terrain) {
+      FILE *f = fopen(file.c_str(), "rb");
+      if(!f) return false;
+      Header header;
+      bool ok = (fread(&header, sizeof(Header), 1, f) == 1 &&
+                 !memcmp(header.magic, expected.magic, sizeof(header.magic)) &&
+                 header.sourceTime == expected.sourceTime &&
+                 header.sourceSize == expected.sourceSize &&
+                 header.width > 0 && header.height > 0);
+      size_t count = ok ? (size_t)header.width*header.height : 0;
+      size_t length = sizeof(Header) + count*sizeof(double);
+      if(ok) {
+        fseek(f, 0, SEEK_END);
+        ok = ((size_t)ftell(f) == length);
+      }
+      fclose(f);
+      if(!ok) return false;
+      HeightGrid *grid = HeightGrid::mapFile(file, sizeof(Header),
+                                             header.width, header.height);
+      if(!grid) return false;
+      terrain->setHeights(grid);
+      return true;
+    }
+
+    bool HeightFile::writeFile(const string &cacheDir, const string &file,
+                               const Header &header,
+                               const double *heights) {
+      createDirectory(cacheDir);
+      // other simulations must never map a half written file
+      string tmpFile = file + ".tmp";
+      FILE *f = fopen(tmpFile.c_str(), "wb");
+      if(!f) return false;
+      size_t count = (size_t)header.width*header.height;
+      bool ok = (fwrite(&header, sizeof(Header), 1, f) == 1 &&
+                 fwrite(heights, sizeof(double), count, f) == count);
+      ok = (fclose(f) == 0) && ok;
+      if(ok) {
+        remove(file.c_str());
+        ok = (rename(tmpFile.c_str(), file.c_str()) == 0);
+      }
+      if(!ok) remove(tmpFile.c_str());
+      return ok;
+    }
+
+  } // end of namespace sim
+} // end of namespace mars
@@ -0,0 +1,87 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+ /**
+ * \file HeightFile.h
+ * \author agent
+ * \brief "HeightFile" stores decoded heightmaps in binary files that are
+ * mapped read-only into memory.
+ *
+ */
+
+#ifndef HEIGHT_FILE_H
+#define HEIGHT_FILE_H
+
+#ifdef _PRINT_HEADER_
+  #warning "HeightFile.h"
+#endif
+
+#include <string>
+
+namespace mars {
+
+  namespace interfaces {
+    struct terrainStruct;
+    class LoadHeightmapInterface;
+  }
+
+  namespace sim {
+
+    /**
+     * \brief A HeightFile holds the heights of a terrain in the layout of
+     * interfaces::HeightGrid.
+     *
+     * The file is created the first time a heightmap is loaded. Later
+     * loads map the file instead of decoding the image again, as long as
+     * the modification time and the size of the image are unchanged. The
+     * pages of the mapping are only read from the disk when they are
+     * used, e.g. by the active tiles of a tiled heightfield, and the
+     * system can drop them again at any time.
+     */
+    class HeightFile {
+    public:
+      /**
+       * \brief Sets terrain->heights to a mapped grid of the height file
+       * of terrain->srcname in cacheDir. The file is created with the
+       * loader if it does not exist or is outdated.
+       *
+       * If the file can not be written, the decoded data of the loader is
+       * kept. \returns false if the heightmap could not be loaded.
+       */
+      static bool load(const std::string &cacheDir,
+                       interfaces::terrainStruct *terrain,
+                       interfaces::LoadHeightmapInterface *loader);
+
+    private:
+      struct Header;
+
+      static std::string getFileName(const std::string &cacheDir,
+                                     const std::string &srcname);
+      static bool mapFile(const std::string &file, const Header &expected,
+                          interfaces::terrainStruct *terrain);
+      static bool writeFile(const std::string &cacheDir,
+                            const std::string &file, const Header &header,
+                            const double *heights);
+    }; // end of class HeightFile
+
+  } // end of namespace sim
+} // end of namespace mars
+
+#endif  // HEIGHT_FILE_H
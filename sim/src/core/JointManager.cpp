@@ -60,6 +60,7 @@ namespace mars {
     JointManager::JointManager(ControlCenter *c) {
       control = c;
       next_joint_id = 1;
+      threadPool = NULL;
     }
 
     unsigned long JointManager::addJoint(JointData *jointS, bool reload) {
@@ -257,11 +258,31 @@ namespace mars {
     void JointManager::updateJoints(sReal calc_ms) {
       MutexLocker locker(&iMutex);
       map<unsigned long, SimJoint*>::iterator iter;
+      if(threadPool) {
+        jointUpdateList.clear();
+        for(iter = simJoints.begin(); iter != simJoints.end(); iter++) {
+          jointUpdateList.push_back(iter->second);
+        }
+        updateCalcMs = calc_ms;
+        threadPool->parallelFor(jointUpdateList.size(), this);
+        return;
+      }
       for(iter = simJoints.begin(); iter != simJoints.end(); iter++) {
         iter->second->update(calc_ms);
       }
     }
 
+    void JointManager::runRange(size_t begin, size_t end) {
+      for(size_t i=begin; i<end; ++i) {
+        jointUpdateList[i]->update(updateCalcMs);
+      }
+    }
+
+    void JointManager::setThreadPool(ThreadPool *pool) {
+      MutexLocker locker(&iMutex);
+      threadPool = pool;
+    }
+
     void JointManager::clearAllJoints(bool clear_all) {
       map<unsigned long, SimJoint*>::iterator iter;
       MutexLocker locker(&iMutex);
@@ -37,6 +37,8 @@
 #include <mars/interfaces/sim/JointManagerInterface.h>
 #include <mars/utils/Mutex.h>
 
+#include "ThreadPool.h"
+
 namespace mars {
   namespace sim {
 
@@ -45,7 +47,8 @@ namespace mars {
     /**
      * The declaration of the JointManager class.
      */
-    class JointManager : public interfaces::JointManagerInterface {
+    class JointManager : public interfaces::JointManagerInterface,
+                         private ThreadPoolRangeTask {
     public:
       JointManager(interfaces::ControlCenter *c);
       virtual ~JointManager(){}
@@ -81,6 +84,12 @@ namespace mars {
                                       std::string *dataName) const;
       virtual void setOfflineValue(unsigned long id, interfaces::sReal value);
 
+      /**
+       * \brief If a pool is set, updateJoints distributes the joints over
+       * its threads. NULL restores the sequential update.
+       */
+      void setThreadPool(ThreadPool *pool);
+
       virtual interfaces::sReal getLowStop(unsigned long id) const;
       virtual interfaces::sReal getHighStop(unsigned long id) const;
       virtual interfaces::sReal getLowStop2(unsigned long id) const;
@@ -96,6 +105,11 @@ namespace mars {
       std::list<interfaces::JointData> simJointsReload;
       interfaces::ControlCenter *control;
       mutable utils::Mutex iMutex;
+      // state of the parallel update, see runRange()
+      ThreadPool *threadPool;
+      std::vector<SimJoint*> jointUpdateList;
+      interfaces::sReal updateCalcMs;
+      void runRange(size_t begin, size_t end);
       interfaces::JointManagerInterface* getJointInterface(unsigned long node_id);
       std::list<interfaces::JointData>::iterator getReloadJoint(unsigned long id);
 
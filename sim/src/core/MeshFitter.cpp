@@ -0,0 +1,443 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+ /**
+ * \file MeshFitter.cpp
+ * \author agent
+ * \brief "MeshFitter" replaces the collision meshes of mesh nodes by
+ * fitted primitives or convex hulls.
+ *
+ */
+
+#include "MeshFitter.h"
+
+#include <mars/interfaces/NodeData.h>
+#include <mars/interfaces/sim/ControlCenter.h>
+#include <mars/interfaces/Logging.hpp>
+#include <mars/utils/MutexLocker.h>
+#include <mars/utils/misc.h>
+
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <set>
+#include <utility>
+
+namespace mars {
+  namespace sim {
+
+    using namespace std;
+    using namespace utils;
+    using namespace interfaces;
+
+    // version of the cache files; increase if the fitting changes
+    static const int cacheVersion = 2;
+
+    struct HullFace {
+      int v[3];
+      Vector normal;
+      double dist;
+    };
+
+    static bool makeFace(const vector<Vector> &points, int a, int b, int c,
+                         HullFace *face) {
+      face->v[0] = a;
+      face->v[1] = b;
+      face->v[2] = c;
+      face->normal = (points[b]-points[a]).cross(points[c]-points[a]);
+      double length = face->normal.norm();
+      if(length <= 0.0) return false;
+      face->normal /= length;
+      face->dist = face->normal.dot(points[a]);
+      return true;
+    }
+
+    /**
+     * \brief Incremental convex hull. The triangles are oriented outwards.
+     * \returns false if the points are flat.
+     */
+    static bool convexHull(const vector<Vector> &points,
+                           vector<HullFace> *faces) {
+      faces->clear();
+      if(points.size() < 4) return false;
+
+      Vector bbMin = points[0], bbMax = points[0];
+      for(size_t i=1; i<points.size(); ++i) {
+        bbMin = bbMin.cwiseMin(points[i]);
+        bbMax = bbMax.cwiseMax(points[i]);
+      }
+      double eps = 1e-9 * (bbMax-bbMin).norm();
+      if(eps <= 0.0) return false;
+
+      // initial tetrahedron of extreme points
+      int i0 = 0, i1 = -1, i2 = -1, i3 = -1;
+      for(size_t i=1; i<points.size(); ++i) {
+        if(points[i].x() < points[i0].x()) i0 = i;
+      }
+      double best = eps;
+      for(size_t i=0; i<points.size(); ++i) {
+        double d = (points[i]-points[i0]).norm();
+        if(d > best) {best = d; i1 = i;}
+      }
+      if(i1 < 0) return false;
+      Vector axis = (points[i1]-points[i0]).normalized();
+      best = eps;
+      for(size_t i=0; i<points.size(); ++i) {
+        double d = axis.cross(points[i]-points[i0]).norm();
+        if(d > best) {best = d; i2 = i;}
+      }
+      if(i2 < 0) return false;
+      Vector normal = (points[i1]-points[i0]).cross(points[i2]-points[i0]);
+      normal.normalize();
+      best = eps;
+      for(size_t i=0; i<points.size(); ++i) {
+        double d = fabs(normal.dot(points[i]-points[i0]));
+        if(d > best) {best = d; i3 = i;}
+      }
+      if(i3 < 0) return false;
+
+      Vector inside = (points[i0]+points[i1]+points[i2]+points[i3])*0.25;
+      int tetra[4][3] = {{i0, i1, i2}, {i0, i3, i1},
+                         {i1, i3, i2}, {i2, i3, i0}};
+      HullFace face;
+      for(int f=0; f<4; ++f) {
+        makeFace(points, tetra[f][0], tetra[f][1], tetra[f][2], &face);
+        if(face.normal.dot(inside) > face.dist) {
+          makeFace(points, tetra[f][0], tetra[f][2], tetra[f][1], &face);
+        }
+        faces->push_back(face);
+      }
+
+      vector<HullFace> kept;
+      set<pair<int, int> > visibleEdges;
+      vector<pair<int, int> > horizon;
+      for(size_t i=0; i<points.size(); ++i) {
+        const Vector &p = points[i];
+        kept.clear();
+        visibleEdges.clear();
+        horizon.clear();
+        for(size_t f=0; f<faces->size(); ++f) {
+          const HullFace &hf = (*faces)[f];
+          if(hf.normal.dot(p) - hf.dist > eps) {
+            for(int k=0; k<3; ++k) {
+              visibleEdges.insert(make_pair(hf.v[k], hf.v[(k+1)%3]));
+            }
+          }
+          else {
+            kept.push_back(hf);
+          }
+        }
+        if(visibleEdges.empty()) continue;
+        // an edge of a visible face whose twin is not visible is on the
+        // horizon; the new faces connect it with the point
+        set<pair<int, int> >::iterator it;
+        for(it=visibleEdges.begin(); it!=visibleEdges.end(); ++it) {
+          if(!visibleEdges.count(make_pair(it->second, it->first))) {
+            horizon.push_back(*it);
+          }
+        }
+        for(size_t e=0; e<horizon.size(); ++e) {
+          if(makeFace(points, horizon[e].first, horizon[e].second, (int)i,
+                      &face)) {
+            kept.push_back(face);
+          }
+        }
+        faces->swap(kept);
+      }
+      return true;
+    }
+
+    /// volume enclosed by the triangles, positive for outward normals
+    static double signedVolume(const vector<Vector> &points,
+                               const int *indices, size_t count) {
+      double volume = 0.0;
+      for(size_t i=0; i+2<count; i+=3) {
+        volume += points[indices[i]].dot(points[indices[i+1]].cross(
+                                          points[indices[i+2]]));
+      }
+      return volume / 6.0;
+    }
+
+    MeshFitter::MeshFitter() : mode(OFF), tolerance(0.2) {
+    }
+
+    void MeshFitter::setMode(Mode mode) {
+      MutexLocker locker(&mutex);
+      this->mode = mode;
+    }
+
+    void MeshFitter::setTolerance(double tolerance) {
+      MutexLocker locker(&mutex);
+      this->tolerance = tolerance;
+    }
+
+    void MeshFitter::setCacheDir(const string &dir) {
+      MutexLocker locker(&mutex);
+      cacheDir = dir;
+    }
+
+    bool MeshFitter::modeFromString(const string &name, Mode *mode) {
+      if(name == "off") *mode = OFF;
+      else if(name == "primitive") *mode = PRIMITIVE;
+      else if(name == "hull") *mode = HULL;
+      else if(name == "auto") *mode = AUTO;
+      else return false;
+      return true;
+    }
+
+    void MeshFitter::fit(NodeData *node) {
+      MutexLocker locker(&mutex);
+      if(mode == OFF || node->physicMode != NODE_TYPE_MESH ||
+         !node->mesh.vertices || node->mesh.indexcount < 3) {
+        return;
+      }
+
+      Result result;
+      string file = getCacheFile(node);
+      if(file.empty() || !loadResult(file, &result)) {
+        computeFit(node, &result);
+        if(!file.empty()) saveResult(file, result);
+      }
+      applyResult(result, node);
+    }
+
+    void MeshFitter::computeFit(const NodeData *node, Result *result) {
+      const snmesh &mesh = node->mesh;
+      vector<Vector> points(mesh.vertexcount);
+      for(int i=0; i<mesh.vertexcount; ++i) {
+        points[i] = Vector(mesh.vertices[i][0], mesh.vertices[i][1],
+                           mesh.vertices[i][2]);
+      }
+      result->type = NODE_TYPE_MESH;
+      result->ext = node->ext;
+      result->error = 0.0;
+
+      vector<HullFace> faces;
+      if(!convexHull(points, &faces)) {
+        LOG_WARN("MeshFitter: %s: the mesh is flat, it is not fitted",
+                 node->name.c_str());
+        return;
+      }
+      vector<int> hullIndices;
+      for(size_t f=0; f<faces.size(); ++f) {
+        for(int k=0; k<3; ++k) hullIndices.push_back(faces[f].v[k]);
+      }
+      double hullVolume = signedVolume(points, &hullIndices[0],
+                                       hullIndices.size());
+      double meshVolume = fabs(signedVolume(points, mesh.indices,
+                                            mesh.indexcount));
+
+      // the smallest primitives around the origin that enclose the mesh
+      Vector half(0.0, 0.0, 0.0);
+      double sphereR = 0.0, radial = 0.0;
+      for(size_t i=0; i<points.size(); ++i) {
+        half = half.cwiseMax(points[i].cwiseAbs());
+        sphereR = max(sphereR, points[i].norm());
+        radial = max(radial, sqrt(points[i].x()*points[i].x() +
+                                  points[i].y()*points[i].y()));
+      }
+      double capsuleHalf = 0.0;
+      for(size_t i=0; i<points.size(); ++i) {
+        double d2 = points[i].x()*points[i].x() + points[i].y()*points[i].y();
+        double cap = sqrt(max(0.0, radial*radial - d2));
+        capsuleHalf = max(capsuleHalf, fabs(points[i].z()) - cap);
+      }
+
+      const int numPrimitives = 4;
+      NodeType types[numPrimitives] = {NODE_TYPE_BOX, NODE_TYPE_SPHERE,
+                                       NODE_TYPE_CYLINDER, NODE_TYPE_CAPSULE};
+      Vector exts[numPrimitives];
+      double volumes[numPrimitives], errors[numPrimitives];
+      exts[0] = half*2.0;
+      volumes[0] = 8.0*half.x()*half.y()*half.z();
+      exts[1] = Vector(sphereR, 0.0, 0.0);
+      volumes[1] = 4.0/3.0*M_PI*sphereR*sphereR*sphereR;
+      exts[2] = Vector(radial, half.z()*2.0, 0.0);
+      volumes[2] = M_PI*radial*radial*half.z()*2.0;
+      exts[3] = Vector(radial, capsuleHalf*2.0, 0.0);
+      volumes[3] = (M_PI*radial*radial*capsuleHalf*2.0 +
+                    4.0/3.0*M_PI*radial*radial*radial);
+
+      int bestPrimitive = 0;
+      for(int i=0; i<numPrimitives; ++i) {
+        errors[i] = (volumes[i] - hullVolume) / hullVolume;
+        if(errors[i] < errors[bestPrimitive]) bestPrimitive = i;
+      }
+      LOG_INFO("MeshFitter: %s: volume error box %.3f, sphere %.3f, "
+               "cylinder %.3f, capsule %.3f; hull %lu of %d triangles, "
+               "mesh volume %.3f of the hull", node->name.c_str(),
+               errors[0], errors[1], errors[2], errors[3],
+               (unsigned long)faces.size(), mesh.indexcount/3,
+               meshVolume / hullVolume);
+
+      if(mode != HULL && errors[bestPrimitive] <= tolerance) {
+        result->type = types[bestPrimitive];
+        result->ext = exts[bestPrimitive];
+        result->error = errors[bestPrimitive];
+        return;
+      }
+      if(mode == PRIMITIVE) return;
+
+      // the hull keeps only the vertices it uses
+      vector<int> remap(points.size(), -1);
+      result->indices.resize(hullIndices.size());
+      for(size_t i=0; i<hullIndices.size(); ++i) {
+        int &idx = remap[hullIndices[i]];
+        if(idx < 0) {
+          idx = (int)result->vertices.size();
+          result->vertices.push_back(points[hullIndices[i]]);
+        }
+        result->indices[i] = idx;
+      }
+      result->type = NODE_TYPE_CONVEX;
+      result->error = 1.0 - meshVolume / hullVolume;
+    }
+
+    string MeshFitter::getCacheFile(const NodeData *node) const {
+      if(cacheDir.empty()) return "";
+      // FNV-1a over the mesh data and the options
+      unsigned long long hash = 14695981039346656037ULL;
+      const unsigned char *data;
+      size_t size;
+      for(int part=0; part<4; ++part) {
+        double options[2] = {(double)mode, tolerance};
+        if(part == 0) {
+          data = (const unsigned char*)node->mesh.vertices;
+          size = node->mesh.vertexcount*sizeof(mydVector3);
+        }
+        else if(part == 1) {
+          data = (const unsigned char*)node->mesh.indices;
+          size = node->mesh.indexcount*sizeof(int);
+        }
+        else if(part == 2) {
+          data = (const unsigned char*)options;
+          size = sizeof(options);
+        }
+        else {
+          data = (const unsigned char*)&cacheVersion;
+          size = sizeof(cacheVersion);
+        }
+        for(size_t i=0; i<size; ++i) {
+          hash ^= data[i];
+          hash *= 1099511628211ULL;
+        }
+      }
+      char name[32];
+      sprintf(name, "%016llx.fit", hash);
+      return cacheDir + "/" + name;
+    }
+
+    bool MeshFitter::loadResult(const string &file, Result *result) {
+      FILE *f = fopen(file.c_str(), "r");
+      if(!f) return false;
+      int version, type;
+      unsigned long numVertices, numIndices;
+      bool ok = (fscanf(f, "mars_mesh_fit %d %d %lf %lf %lf %lf %lu %lu",
+                        &version, &type, &result->ext.x(), &result->ext.y(),
+                        &result->ext.z(), &result->error, &numVertices,
+                        &numIndices) == 8 && version == cacheVersion);
+      if(ok) {
+        result->type = (NodeType)type;
+        result->vertices.resize(numVertices);
+        result->indices.resize(numIndices);
+        for(size_t i=0; ok && i<numVertices; ++i) {
+          Vector &v = result->vertices[i];
+          ok = (fscanf(f, "%lf %lf %lf", &v.x(), &v.y(), &v.z()) == 3);
+        }
+        for(size_t i=0; ok && i<numIndices; ++i) {
+          ok = (fscanf(f, "%d", &result->indices[i]) == 1 &&
+                result->indices[i] >= 0 &&
+                result->indices[i] < (int)numVertices);
+        }
+      }
+      fclose(f);
+      if(!ok) {
+        LOG_WARN("MeshFitter: ignoring invalid cache file %s", file.c_str());
+      }
+      return ok;
+    }
+
+    void MeshFitter::saveResult(const string &file, const Result &result) {
+      createDirectory(cacheDir);
+      FILE *f = fopen(file.c_str(), "w");
+      if(!f) {
+        LOG_WARN("MeshFitter: could not write cache file %s", file.c_str());
+        return;
+      }
+      fprintf(f, "mars_mesh_fit %d %d %.17g %.17g %.17g %.17g %lu %lu\n",
+              cacheVersion, (int)result.type, result.ext.x(), result.ext.y(),
+              result.ext.z(), result.error,
+              (unsigned long)result.vertices.size(),
+              (unsigned long)result.indices.size());
+      for(size_t i=0; i<result.vertices.size(); ++i) {
+        fprintf(f, "%.17g %.17g %.17g\n", result.vertices[i].x(),
+                result.vertices[i].y(), result.vertices[i].z());
+      }
+      for(size_t i=0; i+2<result.indices.size(); i+=3) {
+        fprintf(f, "%d %d %d\n", result.indices[i], result.indices[i+1],
+                result.indices[i+2]);
+      }
+      fclose(f);
+    }
+
+    void MeshFitter::applyResult(const Result &result, NodeData *node) {
+      if(result.type == NODE_TYPE_MESH) return;
+
+      // the mesh arrays are owned by the node
+      delete[] node->mesh.vertices;
+      delete[] node->mesh.indices;
+      node->mesh.vertices = 0;
+      node->mesh.indices = 0;
+      node->mesh.vertexcount = node->mesh.indexcount = 0;
+
+      if(result.type != NODE_TYPE_CONVEX) {
+        LOG_INFO("MeshFitter: %s: replaced by a %s (volume error %.3f)",
+                 node->name.c_str(), NodeData::toString(result.type),
+                 result.error);
+        node->physicMode = result.type;
+        node->ext = result.ext;
+        return;
+      }
+
+      // the hull becomes a convex geom; convex-trimesh contacts are much
+      // cheaper than trimesh-trimesh ones
+      node->physicMode = NODE_TYPE_CONVEX;
+      snmesh &mesh = node->mesh;
+      mesh.vertexcount = (int)result.vertices.size();
+      mesh.vertices = new mydVector3[mesh.vertexcount];
+      for(int i=0; i<mesh.vertexcount; ++i) {
+        mesh.vertices[i][0] = result.vertices[i].x();
+        mesh.vertices[i][1] = result.vertices[i].y();
+        mesh.vertices[i][2] = result.vertices[i].z();
+        mesh.vertices[i][3] = 0;
+      }
+      mesh.indexcount = (int)result.indices.size();
+      mesh.indices = new int[mesh.indexcount];
+      for(int i=0; i<mesh.indexcount; ++i) {
+        mesh.indices[i] = result.indices[i];
+      }
+      LOG_INFO("MeshFitter: %s: replaced by its convex hull with %d "
+               "triangles (volume error %.3f)", node->name.c_str(),
+               mesh.indexcount/3, result.error);
+    }
+
+  } // end of namespace sim
+} // end of namespace mars
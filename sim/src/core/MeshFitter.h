@@ -0,0 +1,129 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+ /**
+ * \file MeshFitter.h
+ * \author agent
+ * \brief "MeshFitter" replaces the collision meshes of mesh nodes by
+ * fitted primitives or convex hulls.
+ *
+ */
+
+#ifndef MESH_FITTER_H
+#define MESH_FITTER_H
+
+#ifdef _PRINT_HEADER_
+  #warning "MeshFitter.h"
+#endif
+
+#include <mars/interfaces/MARSDefs.h>
+#include <mars/utils/Vector.h>
+#include <mars/utils/Mutex.h>
+
+#include <string>
+#include <vector>
+
+namespace mars {
+
+  namespace interfaces {
+    class NodeData;
+  }
+
+  namespace sim {
+
+    /**
+     * \brief The MeshFitter simplifies the physical geometry of mesh
+     * nodes after the mesh was loaded by getPhysicsFromOBJ().
+     *
+     * Modes:
+     *  - OFF: the mesh is used as it is.
+     *  - PRIMITIVE: the mesh is replaced by the box, sphere, cylinder or
+     *    capsule with the smallest volume error if the error is below the
+     *    tolerance; otherwise the mesh is kept.
+     *  - HULL: the node becomes a NODE_TYPE_CONVEX node with the convex
+     *    hull of its mesh, i.e. it collides as an ODE convex geom instead
+     *    of a trimesh. The mesh is not decomposed into several hulls;
+     *    concave meshes that need their shape for the collision have to
+     *    be split into nodes of the same group by the scene.
+     *  - AUTO: a primitive within the tolerance, otherwise the hull.
+     *
+     * The primitives are centered at the origin of the node and aligned
+     * to its axes (cylinders and capsules along z), thus they enclose the
+     * mesh without moving the node. The volume error of a primitive is
+     * (V_primitive - V_hull) / V_hull. The errors are logged for every
+     * fitted mesh.
+     *
+     * The results are stored in the cache directory, one file per mesh;
+     * the file name is a hash of the mesh data and the fitting options.
+     * An empty directory disables the cache.
+     */
+    class MeshFitter {
+    public:
+      enum Mode {
+        OFF,
+        PRIMITIVE,
+        HULL,
+        AUTO
+      };
+
+      MeshFitter();
+
+      void setMode(Mode mode);
+      /// maximal volume error of a primitive
+      void setTolerance(double tolerance);
+      void setCacheDir(const std::string &dir);
+
+      /**
+       * \returns false if the name is unknown; valid names are "off",
+       * "primitive", "hull" and "auto".
+       */
+      static bool modeFromString(const std::string &name, Mode *mode);
+
+      /**
+       * \brief Replaces node->mesh and node->physicMode by the fitted
+       * geometry; the node is not changed if nothing fits.
+       */
+      void fit(interfaces::NodeData *node);
+
+    private:
+      struct Result {
+        interfaces::NodeType type;
+        utils::Vector ext;
+        double error;
+        std::vector<utils::Vector> vertices;
+        std::vector<int> indices;
+      };
+
+      void computeFit(const interfaces::NodeData *node, Result *result);
+      bool loadResult(const std::string &file, Result *result);
+      void saveResult(const std::string &file, const Result &result);
+      std::string getCacheFile(const interfaces::NodeData *node) const;
+      void applyResult(const Result &result, interfaces::NodeData *node);
+
+      utils::Mutex mutex;
+      Mode mode;
+      double tolerance;
+      std::string cacheDir;
+    }; // end of class MeshFitter
+
+  } // end of namespace sim
+} // end of namespace mars
+
+#endif  // MESH_FITTER_H
@@ -35,6 +35,7 @@
 #include "SimMotor.h"
 #include "PhysicsMapper.h"
 #include "MotorManager.h"
+#include "StepRecorder.h"
 
 #include <stdexcept>
 
@@ -58,6 +59,8 @@ namespace mars {
     {
       control = c;
       next_motor_id = 1;
+      threadPool = NULL;
+      recorder = NULL;
     }
 
 
@@ -248,6 +251,7 @@ namespace mars {
      * \param value The new value.
      */
     void MotorManager::setMotorValue(unsigned long id, sReal value) {
+      if(recorder && !recorder->inputMotorValue(id, value)) return;
       MutexLocker locker(&iMutex);
       map<unsigned long, SimMotor*>::iterator iter = simMotors.find(id);
       if (iter != simMotors.end())
@@ -256,6 +260,7 @@ namespace mars {
 
 
     void MotorManager::setMotorValueDesiredVelocity(unsigned long id, sReal velocity) {
+      if(recorder && !recorder->inputMotorVelocity(id, velocity)) return;
       MutexLocker locker(&iMutex);
       map<unsigned long, SimMotor*>::iterator iter = simMotors.find(id);
       if (iter != simMotors.end())
@@ -420,10 +425,58 @@ namespace mars {
     void MotorManager::updateMotors(double calc_ms) {
       map<unsigned long, SimMotor*>::iterator iter;
       MutexLocker locker(&iMutex);
+      if(threadPool) {
+        motorUpdateList.clear();
+        for(iter = simMotors.begin(); iter != simMotors.end(); iter++)
+          motorUpdateList.push_back(iter->second);
+        updateCalcMs = calc_ms;
+        threadPool->parallelFor(motorUpdateList.size(), this);
+        return;
+      }
       for(iter = simMotors.begin(); iter != simMotors.end(); iter++)
         iter->second->update(calc_ms);
     }
 
+    void MotorManager::runRange(size_t begin, size_t end) {
+      for(size_t i=begin; i<end; ++i)
+        motorUpdateList[i]->update(updateCalcMs);
+    }
+
+    void MotorManager::saveState(utils::BinaryBuffer *buffer) const {
+      std::map<unsigned long, SimMotor*>::const_iterator iter;
+      MutexLocker locker(&iMutex);
+      buffer->write((unsigned long)simMotors.size());
+      for(iter = simMotors.begin(); iter != simMotors.end(); ++iter) {
+        buffer->write((unsigned long)iter->first);
+        iter->second->saveState(buffer);
+      }
+    }
+
+    bool MotorManager::restoreState(utils::BinaryBuffer *buffer,
+                                    bool apply) {
+      std::map<unsigned long, SimMotor*>::iterator iter;
+      unsigned long count, id;
+      MutexLocker locker(&iMutex);
+      if(!buffer->read(&count) || count != simMotors.size()) return false;
+      for(iter = simMotors.begin(); iter != simMotors.end(); ++iter) {
+        if(!buffer->read(&id) || id != (unsigned long)iter->first ||
+           !iter->second->restoreState(buffer, apply)) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    void MotorManager::setThreadPool(ThreadPool *pool) {
+      MutexLocker locker(&iMutex);
+      threadPool = pool;
+    }
+
+    void MotorManager::setStepRecorder(StepRecorder *recorder) {
+      MutexLocker locker(&iMutex);
+      this->recorder = recorder;
+    }
+
 
     sReal MotorManager::getActualPosition(unsigned long motorId) const {
       MutexLocker locker(&iMutex);
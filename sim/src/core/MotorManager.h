@@ -40,12 +40,16 @@
 
 #include <mars/interfaces/sim/ControlCenter.h>
 #include <mars/interfaces/sim/MotorManagerInterface.h>
+#include <mars/utils/BinaryBuffer.h>
 #include <mars/utils/Mutex.h>
 
+#include "ThreadPool.h"
+
 namespace mars {
   namespace sim {
 
     class SimMotor;
+    class StepRecorder;
 
     /**
      * \brief "MotorManager" imlements the interfaces for all motor 
@@ -57,7 +61,8 @@ namespace mars {
      * is only guaranteed by calling it within the main thread (update 
      * callback from \c gui_thread).
      */
-    class MotorManager : public interfaces::MotorManagerInterface {
+    class MotorManager : public interfaces::MotorManagerInterface,
+                         private ThreadPoolRangeTask {
     public:
 
       /**
@@ -263,6 +268,32 @@ namespace mars {
        */
       virtual void updateMotors(interfaces::sReal calc_ms);
 
+      /**
+       * \brief If a pool is set, updateMotors distributes the motors over
+       * its threads. NULL restores the sequential update.
+       */
+      void setThreadPool(ThreadPool *pool);
+
+      /**
+       * \brief If a recorder is set, the motor values are passed to it
+       * before they are set.
+       */
+      void setStepRecorder(StepRecorder *recorder);
+
+      /**
+       * \brief Writes the dynamic state of all motors to a simulation
+       * snapshot.
+       */
+      void saveState(utils::BinaryBuffer *buffer) const;
+
+      /**
+       * \brief Reads a snapshot; if \c apply is false the snapshot is only
+       * checked and nothing is changed.
+       * \return false if the snapshot does not match the motors of the
+       * current scene.
+       */
+      bool restoreState(utils::BinaryBuffer *buffer, bool apply);
+
       /**
        * \returns the actual position of the motor with the given Id.
        *          returns 0 if a motor with the given Id doesn't exist.
@@ -329,6 +360,15 @@ namespace mars {
       //! a mutex for the motor containters
       mutable utils::Mutex iMutex;
 
+      //! records the motor values, see setStepRecorder()
+      StepRecorder *recorder;
+
+      //! the pool for the parallel update, see runRange()
+      ThreadPool *threadPool;
+      std::vector<SimMotor*> motorUpdateList;
+      interfaces::sReal updateCalcMs;
+      void runRange(size_t begin, size_t end);
+
     }; // class MotorManager
 
   } // end of namespace sim
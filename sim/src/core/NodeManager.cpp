@@ -30,6 +30,9 @@
 #include "NodeManager.h"
 #include "JointManager.h"
 #include "PhysicsMapper.h"
+#include "StepRecorder.h"
+#include "MeshFitter.h"
+#include "HeightFile.h"
 
 #include <mars/interfaces/sim/LoadCenter.h>
 #include <mars/interfaces/sim/SimulatorInterface.h>
@@ -63,7 +66,10 @@ namespace mars {
                                                  update_all_nodes(false),
                                                  visual_rep(1),
                                                  maxGroupID(0),
-                                                control(c)
+                                                control(c),
+                                                recorder(NULL),
+                                                meshFitter(NULL),
+                                                threadPool(NULL)
     {
       if(control->graphics) {
         GraphicsUpdateInterface *gui = static_cast<GraphicsUpdateInterface*>(this);
@@ -113,13 +119,15 @@ namespace mars {
             LOG_ERROR("NodeManager:: loadCenter is missing, can not create Node");
             return INVALID_ID;
           }
-          reloadNode.terrain = new(terrainStruct);
-          *(reloadNode.terrain) = *(nodeS->terrain);
-          control->loadCenter->loadHeightmap->readPixelData(reloadNode.terrain);
-          if(!reloadNode.terrain->pixelData) {
-            LOG_ERROR("NodeManager::addNode: could not load image for terrain");
-            return INVALID_ID;
+          if(!nodeS->terrain->heights) {
+            loadHeightmap(nodeS->terrain);
+            if(!nodeS->terrain->heights) {
+              LOG_ERROR("NodeManager::addNode: could not load image for terrain");
+              return INVALID_ID;
+            }
           }
+          // the copy shares the heights of the node
+          reloadNode.terrain = new terrainStruct(*(nodeS->terrain));
         }
         simNodesReload.push_back(reloadNode);
 
@@ -148,15 +156,16 @@ namespace mars {
           return INVALID_ID;
         }
         control->loadCenter->loadMesh->getPhysicsFromOBJ(nodeS);
+        if(meshFitter) meshFitter->fit(nodeS);
       }
       if((nodeS->physicMode == NODE_TYPE_TERRAIN) && nodeS->terrain ) {
         if(!control->loadCenter || !control->loadCenter->loadHeightmap) {
           LOG_ERROR("NodeManager:: loadCenter is missing, can not create Node");
           return INVALID_ID;
         }
-        if(!nodeS->terrain->pixelData) {
-          control->loadCenter->loadHeightmap->readPixelData(nodeS->terrain);
-          if(!nodeS->terrain->pixelData) {
+        if(!nodeS->terrain->heights) {
+          loadHeightmap(nodeS->terrain);
+          if(!nodeS->terrain->heights) {
             LOG_ERROR("NodeManager::addNode: could not load image for terrain");
             return INVALID_ID;
           }
@@ -211,7 +220,8 @@ namespace mars {
           physicalRep.visual_size = physicalRep.ext;
 
           if(nodeS->physicMode != NODE_TYPE_TERRAIN) {
-            if(nodeS->physicMode != NODE_TYPE_MESH) {
+            if(nodeS->physicMode != NODE_TYPE_MESH &&
+               nodeS->physicMode != NODE_TYPE_CONVEX) {
               physicalRep.filename = "PRIMITIVE";
               //physicalRep.filename = nodeS->filename;
               if(nodeS->physicMode > 0 && nodeS->physicMode < NUMBER_OF_NODE_TYPES){
@@ -718,6 +728,7 @@ namespace mars {
      *\brief Adds a off-center Force to the node with the given id.
      */
     void NodeManager::applyForce(NodeId id, const Vector &force, const Vector &pos) {
+      if(recorder && !recorder->inputForce(id, force, &pos)) return;
       MutexLocker locker(&iMutex);
       NodeMap::iterator iter = simNodes.find(id);
       if (iter != simNodes.end())
@@ -727,6 +738,7 @@ namespace mars {
      *\brief Adds a Force to the node with the given id.
      */
     void NodeManager::applyForce(NodeId id, const Vector &force) {
+      if(recorder && !recorder->inputForce(id, force, NULL)) return;
       MutexLocker locker(&iMutex);
       NodeMap::iterator iter = simNodes.find(id);
       if (iter != simNodes.end())
@@ -737,6 +749,7 @@ namespace mars {
      *\brief Adds a Torque to the node with the given id.
      */
     void NodeManager::applyTorque(NodeId id, const Vector &torque) {
+      if(recorder && !recorder->inputTorque(id, torque)) return;
       MutexLocker locker(&iMutex);
       NodeMap::iterator iter = simNodes.find(id);
       if (iter != simNodes.end())
@@ -1079,13 +1092,7 @@ namespace mars {
           tmp.c_params.friction_direction1 = friction;
         }
         if(tmp.terrain) {
-          tmp.terrain = new(terrainStruct);
-          *(tmp.terrain) = *(iter->terrain);
-          tmp.terrain->pixelData = (double*)calloc((tmp.terrain->width*
-                                                     tmp.terrain->height),
-                                                    sizeof(double));
-          memcpy(tmp.terrain->pixelData, iter->terrain->pixelData,
-                 (tmp.terrain->width*tmp.terrain->height)*sizeof(double));
+          tmp.terrain = new terrainStruct(*(iter->terrain));
         }
         iMutex.unlock();
         addNode(&tmp, true);
@@ -1152,11 +1159,84 @@ namespace mars {
     void NodeManager::updateDynamicNodes(sReal calc_ms, bool physics_thread) {
       MutexLocker locker(&iMutex);
       NodeMap::iterator iter;
+      if(threadPool) {
+        // the nodes are independent of each other; the manager stays
+        // locked until all of them are updated
+        nodeUpdateList.clear();
+        for(iter = simNodesDyn.begin(); iter != simNodesDyn.end(); iter++) {
+          nodeUpdateList.push_back(iter->second);
+        }
+        updateCalcMs = calc_ms;
+        updatePhysicsThread = physics_thread;
+        threadPool->parallelFor(nodeUpdateList.size(), this);
+        return;
+      }
       for(iter = simNodesDyn.begin(); iter != simNodesDyn.end(); iter++) {
         iter->second->update(calc_ms, physics_thread);
       }
     }
 
+    void NodeManager::runRange(size_t begin, size_t end) {
+      for(size_t i=begin; i<end; ++i) {
+        nodeUpdateList[i]->update(updateCalcMs, updatePhysicsThread);
+      }
+    }
+
+    void NodeManager::saveState(utils::BinaryBuffer *buffer) const {
+      NodeMap::const_iterator iter;
+      MutexLocker locker(&iMutex);
+      buffer->write((unsigned long)simNodes.size());
+      for(iter = simNodes.begin(); iter != simNodes.end(); ++iter) {
+        buffer->write((unsigned long)iter->first);
+        iter->second->saveState(buffer);
+      }
+    }
+
+    bool NodeManager::restoreState(utils::BinaryBuffer *buffer,
+                                   bool apply) {
+      NodeMap::iterator iter;
+      unsigned long count, id;
+      MutexLocker locker(&iMutex);
+      if(!buffer->read(&count) || count != simNodes.size()) return false;
+      for(iter = simNodes.begin(); iter != simNodes.end(); ++iter) {
+        if(!buffer->read(&id) || id != (unsigned long)iter->first ||
+           !iter->second->restoreState(buffer, apply)) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    void NodeManager::setThreadPool(ThreadPool *pool) {
+      MutexLocker locker(&iMutex);
+      threadPool = pool;
+    }
+
+    void NodeManager::setStepRecorder(StepRecorder *recorder) {
+      MutexLocker locker(&iMutex);
+      this->recorder = recorder;
+    }
+
+    void NodeManager::setMeshFitter(MeshFitter *fitter) {
+      MutexLocker locker(&iMutex);
+      meshFitter = fitter;
+    }
+
+    void NodeManager::setHeightCacheDir(const std::string &dir) {
+      MutexLocker locker(&iMutex);
+      heightCacheDir = dir;
+    }
+
+    void NodeManager::loadHeightmap(terrainStruct *terrain) {
+      LoadHeightmapInterface *loader = control->loadCenter->loadHeightmap;
+      if(heightCacheDir.empty()) {
+        loader->readPixelData(terrain);
+      }
+      else {
+        HeightFile::load(heightCacheDir, terrain, loader);
+      }
+    }
+
     void NodeManager::preGraphicsUpdate() {
       NodeMap::iterator iter;
       if(!control->graphics)
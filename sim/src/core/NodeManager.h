@@ -32,16 +32,21 @@
   #warning "NodeManager.h"
 #endif
 
+#include <mars/utils/BinaryBuffer.h>
 #include <mars/utils/Mutex.h>
 #include <mars/interfaces/graphics/GraphicsUpdateInterface.h>
 #include <mars/interfaces/sim/ControlCenter.h>
 #include <mars/interfaces/sim/NodeManagerInterface.h>
 
+#include "ThreadPool.h"
+
 namespace mars {
   namespace sim {
 
     class SimJoint;
     class SimNode;
+    class StepRecorder;
+    class MeshFitter;
 
     typedef std::map<interfaces::NodeId, SimNode*> NodeMap;
 
@@ -50,7 +55,8 @@ namespace mars {
      *
      */
     class NodeManager : public interfaces::NodeManagerInterface,
-                        public interfaces::GraphicsUpdateInterface {
+                        public interfaces::GraphicsUpdateInterface,
+                        private ThreadPoolRangeTask {
     public:
       NodeManager(interfaces::ControlCenter *c);
       virtual ~NodeManager(){}
@@ -155,6 +161,45 @@ namespace mars {
                                 unsigned long excludeJointId);
       virtual unsigned long getMaxGroupID() { return maxGroupID; }
 
+      /**
+       * \brief If a pool is set, updateDynamicNodes distributes the nodes
+       * over its threads. NULL restores the sequential update.
+       */
+      void setThreadPool(ThreadPool *pool);
+
+      /**
+       * \brief If a recorder is set, the forces and torques are passed
+       * to it before they are applied.
+       */
+      void setStepRecorder(StepRecorder *recorder);
+
+      /**
+       * \brief If a fitter is set, the meshes of new mesh nodes are
+       * passed to it after they are loaded.
+       */
+      void setMeshFitter(MeshFitter *fitter);
+
+      /**
+       * \brief If a directory is set, the heightmaps of new terrains are
+       * stored in height files in it and mapped from there (see
+       * HeightFile); an empty string decodes every heightmap again.
+       */
+      void setHeightCacheDir(const std::string &dir);
+
+      /**
+       * \brief Writes the dynamic state of all nodes to a simulation
+       * snapshot.
+       */
+      void saveState(utils::BinaryBuffer *buffer) const;
+
+      /**
+       * \brief Reads a snapshot; if \c apply is false the snapshot is only
+       * checked and nothing is changed.
+       * \return false if the snapshot does not match the nodes of the
+       * current scene.
+       */
+      bool restoreState(utils::BinaryBuffer *buffer, bool apply);
+
     private:
       interfaces::NodeId next_node_id;
       bool update_all_nodes;
@@ -168,8 +213,19 @@ namespace mars {
       mutable utils::Mutex iMutex;
 
       interfaces::ControlCenter *control;
+      StepRecorder *recorder;
+      MeshFitter *meshFitter;
+      std::string heightCacheDir;
+
+      // state of the parallel update, see runRange()
+      ThreadPool *threadPool;
+      std::vector<SimNode*> nodeUpdateList;
+      interfaces::sReal updateCalcMs;
+      bool updatePhysicsThread;
+      void runRange(size_t begin, size_t end);
 
       std::list<interfaces::NodeData>::iterator getReloadNode(interfaces::NodeId id);
+      void loadHeightmap(interfaces::terrainStruct *terrain);
 
       // interfaces::NodeInterface* getNodeInterface(NodeId node_id);
       struct Params; // see below.
@@ -0,0 +1,252 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+ /**
+ * \file RealtimeScheduler.cpp
+ * \author agent
+ * \brief "RealtimeScheduler" paces the simulation steps to the wall clock
+ * and keeps statistics about missed deadlines.
+ *
+ */
+
+#include "RealtimeScheduler.h"
+
+#include <mars/utils/misc.h>
+#include <mars/data_broker/DataBrokerInterface.h>
+#include <mars/interfaces/sim/ControlCenter.h>
+#include <mars/interfaces/Logging.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+
+#ifdef __linux__
+  #include <pthread.h>
+  #include <sched.h>
+  #include <time.h>
+#endif
+
+namespace mars {
+  namespace sim {
+
+    using namespace std;
+
+    // upper bounds of the lateness histogram bins in microseconds
+    static const long long histogramBounds[RealtimeScheduler::numHistogramBins-1] = {
+      50, 100, 250, 500, 1000, 2500, 5000
+    };
+
+    // stretching of the period per miss in the SLOW_DOWN policy
+    static const double slowDownFactor = 1.1;
+    static const double recoverFactor = 0.99;
+    static const double maxPeriodScale = 10.0;
+
+    RealtimeScheduler::RealtimeScheduler()
+      : periodUs(10000), nextDeadline(0), periodScale(1.0), policy(SKIP),
+        maxBurst(10), needsInit(true), catchingUp(false), steps(0), misses(0),
+        skipped(0), lastLateness(0.0), maxLateness(0.0), publishedSteps(0),
+        dbId(0) {
+      memset(histogram, 0, sizeof(histogram));
+      dbPackage.add("steps", (long)0);
+      dbPackage.add("misses", (long)0);
+      dbPackage.add("skipped", (long)0);
+      dbPackage.add("lateness", 0.0);
+      dbPackage.add("maxLateness", 0.0);
+      dbPackage.add("realtimeFactor", 1.0);
+      char name[32];
+      for(int i=0; i<numHistogramBins-1; ++i) {
+        sprintf(name, "hist%lld", histogramBounds[i]);
+        dbPackage.add(name, (long)0);
+      }
+      dbPackage.add("histInf", (long)0);
+    }
+
+    void RealtimeScheduler::setPeriod(double milliseconds) {
+      periodUs = (long long)(milliseconds*1000.0);
+      if(periodUs < 1) periodUs = 1;
+    }
+
+    void RealtimeScheduler::setPolicy(Policy policy) {
+      this->policy = policy;
+      periodScale = 1.0;
+    }
+
+    void RealtimeScheduler::setMaxBurst(int steps) {
+      maxBurst = steps < 1 ? 1 : steps;
+    }
+
+    bool RealtimeScheduler::policyFromString(const string &name,
+                                             Policy *policy) {
+      if(name == "skip") *policy = SKIP;
+      else if(name == "burst") *policy = BURST;
+      else if(name == "slow down") *policy = SLOW_DOWN;
+      else return false;
+      return true;
+    }
+
+    void RealtimeScheduler::reset() {
+      needsInit = true;
+      catchingUp = false;
+    }
+
+    void RealtimeScheduler::sleepUntil(long long time) {
+#ifdef __linux__
+      // getTimeMicroseconds() uses CLOCK_MONOTONIC as well
+      struct timespec ts;
+      ts.tv_sec = time / 1000000;
+      ts.tv_nsec = (time % 1000000) * 1000;
+      while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, 0) == EINTR) {}
+#else
+      long long diff = time - utils::getTimeMicroseconds();
+      if(diff >= 1000) utils::msleep((unsigned int)(diff/1000));
+#endif
+    }
+
+    void RealtimeScheduler::addLateness(long long lateness) {
+      int bin = 0;
+      while(bin < numHistogramBins-1 && lateness >= histogramBounds[bin]) {
+        ++bin;
+      }
+      ++histogram[bin];
+      lastLateness = (double)lateness;
+      if(lastLateness > maxLateness) maxLateness = lastLateness;
+    }
+
+    void RealtimeScheduler::waitForNextStep() {
+      long long now = utils::getTimeMicroseconds();
+      long long period = (long long)(periodUs*periodScale);
+
+      if(needsInit) {
+        needsInit = false;
+        nextDeadline = now + period;
+      }
+      ++steps;
+      if(now < nextDeadline) {
+        catchingUp = false;
+        sleepUntil(nextDeadline);
+        addLateness(utils::getTimeMicroseconds() - nextDeadline);
+        if(policy == SLOW_DOWN && periodScale > 1.0) {
+          periodScale *= recoverFactor;
+          if(periodScale < 1.0) periodScale = 1.0;
+        }
+        nextDeadline += period;
+        return;
+      }
+
+      // the deadline is missed; the late steps of a burst belong to the
+      // miss that started it
+      long long lateness = now - nextDeadline;
+      if(!catchingUp) ++misses;
+      addLateness(lateness);
+      switch(policy) {
+      case BURST:
+        if(lateness <= maxBurst*period) {
+          // the next steps start immediately until the timeline is reached
+          catchingUp = true;
+          nextDeadline += period;
+          break;
+        }
+        catchingUp = false;
+        // fall through: the lag is too large to be caught up
+      case SKIP:
+        skipped += (long)(lateness / period);
+        nextDeadline = now + period;
+        break;
+      case SLOW_DOWN:
+        periodScale *= slowDownFactor;
+        if(periodScale > maxPeriodScale) periodScale = maxPeriodScale;
+        nextDeadline = now + (long long)(periodUs*periodScale);
+        break;
+      }
+    }
+
+    void RealtimeScheduler::publish(data_broker::DataBrokerInterface *dataBroker,
+                                    int interval) {
+      if(!dataBroker || interval <= 0 || steps - publishedSteps < interval) {
+        return;
+      }
+      publishedSteps = steps;
+      dbPackage.set(0, steps);
+      dbPackage.set(1, misses);
+      dbPackage.set(2, skipped);
+      dbPackage.set(3, lastLateness);
+      dbPackage.set(4, maxLateness);
+      dbPackage.set(5, 1.0/periodScale);
+      for(int i=0; i<numHistogramBins; ++i) {
+        dbPackage.set(6+i, histogram[i]);
+      }
+      if(dbId) {
+        dataBroker->pushData(dbId, dbPackage);
+      }
+      else {
+        dbId = dataBroker->pushData("mars_sim", "realtime", dbPackage, NULL,
+                                    data_broker::DATA_PACKAGE_READ_FLAG);
+      }
+    }
+
+    bool RealtimeScheduler::setThreadPriority(int priority) {
+#ifdef __linux__
+      struct sched_param param;
+      int schedPolicy = priority > 0 ? SCHED_FIFO : SCHED_OTHER;
+      param.sched_priority = priority > 0 ? priority : 0;
+      int retval = pthread_setschedparam(pthread_self(), schedPolicy, &param);
+      if(retval != 0) {
+        LOG_ERROR("RealtimeScheduler: could not set the priority %d: %s",
+                  priority, strerror(retval));
+        return false;
+      }
+      return true;
+#else
+      if(priority > 0) {
+        LOG_WARN("RealtimeScheduler: thread priorities are only "
+                 "supported on linux");
+      }
+      return priority <= 0;
+#endif
+    }
+
+    bool RealtimeScheduler::setThreadAffinity(int cpu) {
+#ifdef __linux__
+      cpu_set_t cpus;
+      CPU_ZERO(&cpus);
+      if(cpu < 0) {
+        for(int i=0; i<CPU_SETSIZE; ++i) CPU_SET(i, &cpus);
+      }
+      else {
+        CPU_SET(cpu, &cpus);
+      }
+      int retval = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+      if(retval != 0) {
+        LOG_ERROR("RealtimeScheduler: could not pin the thread to "
+                  "cpu %d: %s", cpu, strerror(retval));
+        return false;
+      }
+      return true;
+#else
+      if(cpu >= 0) {
+        LOG_WARN("RealtimeScheduler: cpu pinning is only supported "
+                 "on linux");
+      }
+      return cpu < 0;
+#endif
+    }
+
+  } // end of namespace sim
+} // end of namespace mars
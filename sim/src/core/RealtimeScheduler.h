@@ -0,0 +1,148 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+ /**
+ * \file RealtimeScheduler.h
+ * \author agent
+ * \brief "RealtimeScheduler" paces the simulation steps to the wall clock
+ * and keeps statistics about missed deadlines.
+ *
+ */
+
+#ifndef REALTIME_SCHEDULER_H
+#define REALTIME_SCHEDULER_H
+
+#ifdef _PRINT_HEADER_
+  #warning "RealtimeScheduler.h"
+#endif
+
+#include <mars/data_broker/DataPackage.h>
+
+#include <string>
+
+namespace mars {
+
+  namespace data_broker {
+    class DataBrokerInterface;
+  }
+
+  namespace sim {
+
+    /**
+     * \brief The RealtimeScheduler starts every step at a fixed deadline
+     * on the monotonic clock: deadline(n+1) = deadline(n) + period.
+     *
+     * A step whose deadline has already passed when waitForNextStep() is
+     * called is a deadline miss. What happens then depends on the policy:
+     *  - SKIP: the missed periods are dropped and the timeline restarts
+     *    at the current time; the simulation falls behind the wall clock.
+     *  - BURST: the steps run without sleeping until the timeline is
+     *    caught up again. If the lag exceeds maxBurst periods the
+     *    remaining lag is dropped as with SKIP.
+     *  - SLOW_DOWN: the period is stretched with every miss and shrinks
+     *    back to the nominal period while the steps are in time, thus
+     *    the simulation runs slower than real time under load.
+     *
+     * The statistics are published as DataBroker package
+     * "mars_sim"/"realtime" with the items steps, misses, skipped,
+     * lateness, maxLateness, realtimeFactor and the lateness histogram
+     * hist<bound> (the number of steps started less than bound
+     * microseconds after their deadline). The scheduler is only used by
+     * the physics thread.
+     */
+    class RealtimeScheduler {
+    public:
+      enum Policy {
+        SKIP,
+        BURST,
+        SLOW_DOWN
+      };
+
+      static const int numHistogramBins = 8;
+
+      RealtimeScheduler();
+
+      /**
+       * \param milliseconds The nominal duration of one step.
+       */
+      void setPeriod(double milliseconds);
+      void setPolicy(Policy policy);
+      void setMaxBurst(int steps);
+
+      /**
+       * \returns false if the name is unknown; valid names are "skip",
+       * "burst" and "slow down".
+       */
+      static bool policyFromString(const std::string &name, Policy *policy);
+
+      /**
+       * \brief Restarts the timeline, e.g. after the simulation was
+       * paused. The statistics are kept.
+       */
+      void reset();
+
+      /**
+       * \brief Sleeps until the deadline of the next step.
+       */
+      void waitForNextStep();
+
+      /**
+       * \brief Publishes the statistics if at least \c interval steps
+       * were made since the last publication.
+       */
+      void publish(data_broker::DataBrokerInterface *dataBroker,
+                   int interval);
+
+      /**
+       * \brief Runs the calling thread with the SCHED_FIFO policy and the
+       * given priority (1-99); 0 restores the normal scheduling.
+       * \returns false if the priority could not be set, e.g. because of
+       * missing permissions.
+       */
+      static bool setThreadPriority(int priority);
+
+      /**
+       * \brief Pins the calling thread to the given cpu; -1 allows all
+       * cpus.
+       */
+      static bool setThreadAffinity(int cpu);
+
+    private:
+      void sleepUntil(long long time);
+      void addLateness(long long lateness);
+
+      long long periodUs, nextDeadline;
+      double periodScale;
+      Policy policy;
+      int maxBurst;
+      bool needsInit, catchingUp;
+
+      long steps, misses, skipped;
+      long histogram[numHistogramBins];
+      double lastLateness, maxLateness;
+      long publishedSteps;
+      unsigned long dbId;
+      data_broker::DataPackage dbPackage;
+    }; // end of class RealtimeScheduler
+
+  } // end of namespace sim
+} // end of namespace mars
+
+#endif  // REALTIME_SCHEDULER_H
@@ -233,6 +233,57 @@ namespace mars {
       return 0;
     }
 
+    /**
+     * \brief Writes the id and the state of every sensor to the buffer.
+     *
+     * \param buffer The buffer of the snapshot.
+     */
+    void SensorManager::saveState(utils::BinaryBuffer *buffer) const {
+      std::map<unsigned long, BaseSensor*>::const_iterator iter;
+      MutexLocker locker(&iMutex);
+      buffer->write((unsigned long)simSensors.size());
+      for(iter = simSensors.begin(); iter != simSensors.end(); ++iter) {
+        buffer->write((unsigned long)iter->first);
+        iter->second->saveState(buffer);
+      }
+    }
+
+    bool SensorManager::restoreState(utils::BinaryBuffer *buffer,
+                                     bool apply) {
+      std::map<unsigned long, BaseSensor*>::iterator iter;
+      unsigned long count, id;
+      MutexLocker locker(&iMutex);
+      if(!buffer->read(&count) || count != simSensors.size()) return false;
+      for(iter = simSensors.begin(); iter != simSensors.end(); ++iter) {
+        if(!buffer->read(&id) || id != (unsigned long)iter->first ||
+           !iter->second->restoreState(buffer, apply)) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    /**
+     * \brief This function copies the sensor data for a given index into
+     * a buffer without allocating memory.
+     *
+     * \param data The buffer the sensor data is written to.
+     *
+     * \param size The number of values \c data can hold.
+     */
+    int SensorManager::readSensorData(unsigned long id, sReal *data,
+                                      int size) const {
+      MutexLocker locker(&iMutex);
+      map<unsigned long, BaseSensor*>::const_iterator iter;
+
+      iter = simSensors.find(id);
+      if (iter != simSensors.end())
+        return iter->second->readSensorData(data, size);
+
+      LOG_DEBUG("Cannot Find Sensor wirh id: %lu\n",id);
+      return 0;
+    }
+
 
     /**
      *\brief Returns the number of sensors that are currently present in the simulation.
@@ -168,6 +168,22 @@ namespace mars {
        * \param index The index of the sensor to get the data 
        */
       virtual int getSensorData(unsigned long id, interfaces::sReal **data) const;
+      virtual int readSensorData(unsigned long id, interfaces::sReal *data,
+                                 int size) const;
+
+      /**
+       * \brief Writes the dynamic state of all sensors to a simulation
+       * snapshot.
+       */
+      void saveState(utils::BinaryBuffer *buffer) const;
+
+      /**
+       * \brief Reads a snapshot; if \c apply is false the snapshot is only
+       * checked and nothing is changed.
+       * \return false if the snapshot does not match the sensors of the
+       * current scene.
+       */
+      bool restoreState(utils::BinaryBuffer *buffer, bool apply);
 
       /**
        *\brief Returns the number of sensors that are currently present in the simulation.
@@ -203,26 +203,28 @@ namespace mars {
     void SimJoint::update(sReal calc_ms){
       CPP_UNUSED(calc_ms);
       if (my_interface) {
+        // the physics is locked once for all values of the step
+        JointState state;
+        my_interface->update(&state);
         // update the position and rotation of the node
-        actualAngle1 = (sJoint.angle1_offset + invert*my_interface->getPosition());
-        actualAngle2 = (sJoint.angle2_offset + invert*my_interface->getPosition2());
+        actualAngle1 = (sJoint.angle1_offset + invert*state.position1);
+        actualAngle2 = (sJoint.angle2_offset + invert*state.position2);
 
-        my_interface->getAnchor(&anchor);
-        my_interface->getAxis(&axis1);
-        my_interface->getAxis2(&axis2);
+        anchor = state.anchor;
+        axis1 = state.axis1;
+        axis2 = state.axis2;
         my_interface->getForce1(&f1);
         my_interface->getForce2(&f2);
         my_interface->getTorque1(&t1);
         my_interface->getTorque2(&t2);
-        my_interface->update();
         my_interface->getAxisTorque(&axis1_torque);
         my_interface->getAxis2Torque(&axis2_torque);
         my_interface->getJointLoad(&joint_load);
         axis1_torque *= invert;
         axis2_torque *= invert;
         joint_load *= invert;
-        speed1 = invert*my_interface->getVelocity();
-        speed2 = invert*my_interface->getVelocity2();
+        speed1 = invert*state.velocity1;
+        speed2 = invert*state.velocity2;
         motor_torque = invert*my_interface->getMotorTorque();
       }
     }
@@ -439,6 +439,44 @@ namespace mars {
       }
     }
 
+    void SimMotor::saveState(utils::BinaryBuffer *buffer) const {
+      buffer->write(sMotor.value);
+      buffer->write(activated);
+      buffer->write(time);
+      buffer->write(desired_position);
+      buffer->write(desired_velocity);
+      buffer->write(actual_position);
+      buffer->write(actual_velocity);
+      buffer->write(last_error);
+      buffer->write(integ_error);
+      buffer->write(pwm);
+      buffer->write(current);
+      buffer->write(torque);
+      buffer->write(i_current);
+      buffer->write(last_current);
+      buffer->write(last_velocity);
+      buffer->write(joint_velocity);
+    }
+
+    bool SimMotor::restoreState(utils::BinaryBuffer *buffer, bool apply) {
+      return (buffer->readOrSkip(&sMotor.value, apply) &&
+              buffer->readOrSkip(&activated, apply) &&
+              buffer->readOrSkip(&time, apply) &&
+              buffer->readOrSkip(&desired_position, apply) &&
+              buffer->readOrSkip(&desired_velocity, apply) &&
+              buffer->readOrSkip(&actual_position, apply) &&
+              buffer->readOrSkip(&actual_velocity, apply) &&
+              buffer->readOrSkip(&last_error, apply) &&
+              buffer->readOrSkip(&integ_error, apply) &&
+              buffer->readOrSkip(&pwm, apply) &&
+              buffer->readOrSkip(&current, apply) &&
+              buffer->readOrSkip(&torque, apply) &&
+              buffer->readOrSkip(&i_current, apply) &&
+              buffer->readOrSkip(&last_current, apply) &&
+              buffer->readOrSkip(&last_velocity, apply) &&
+              buffer->readOrSkip(&joint_velocity, apply));
+    }
+
     void SimMotor::setValue(sReal value) {
       switch (sMotor.type) {
       case MOTOR_TYPE_PID:
@@ -31,6 +31,7 @@
 #include <mars/data_broker/ReceiverInterface.h>
 #include <mars/data_broker/DataPackage.h>
 #include <mars/interfaces/MotorData.h>
+#include <mars/utils/BinaryBuffer.h>
 
 #include <iostream>
 
@@ -267,6 +268,14 @@ namespace mars {
       //  void setSMotor(const MotorData &sMotor);
       const interfaces::MotorData getSMotor(void) const;
       void update(interfaces::sReal time_ms);
+
+      /**
+       * writes the controller state of the motor (set point, integrated
+       * error, ...) to a simulation snapshot
+       */
+      void saveState(utils::BinaryBuffer *buffer) const;
+      /// only checks the snapshot if apply is false
+      bool restoreState(utils::BinaryBuffer *buffer, bool apply);
       unsigned long getIndex(void) const;
       unsigned long getJointIndex(void) const;
       void getCoreExchange(interfaces::core_objects_exchange* obj) const;
@@ -149,7 +149,7 @@ namespace mars {
         sNode.c_params.friction_direction1 = 0;
       }
       if (sNode.terrain) {
-        if(sNode.terrain->pixelData) free(sNode.terrain->pixelData);
+        // releases the heights
         delete sNode.terrain;
         sNode.terrain = 0;
       }
@@ -671,6 +671,51 @@ namespace mars {
       }
     }
 
+    void SimNode::saveState(utils::BinaryBuffer *buffer) const {
+      MutexLocker locker(&iMutex);
+      sReal bodyState[NodeInterface::BODY_STATE_SIZE];
+      bool hasBody = my_interface && my_interface->getBodyState(bodyState);
+      buffer->write(hasBody);
+      if(hasBody) {
+        buffer->write(bodyState, sizeof(bodyState));
+      }
+      buffer->write(sNode.pos);
+      buffer->write(sNode.rot);
+      buffer->write(l_vel);
+      buffer->write(last_l_vel);
+      buffer->write(a_vel);
+      buffer->write(last_a_vel);
+      buffer->write(l_acc);
+      buffer->write(a_acc);
+      buffer->write(f);
+      buffer->write(t);
+      buffer->write(ground_contact);
+      buffer->write(ground_contact_force);
+    }
+
+    bool SimNode::restoreState(utils::BinaryBuffer *buffer, bool apply) {
+      MutexLocker locker(&iMutex);
+      sReal bodyState[NodeInterface::BODY_STATE_SIZE];
+      bool hasBody;
+      if(!buffer->read(&hasBody)) return false;
+      if(hasBody) {
+        if(!buffer->read(bodyState, sizeof(bodyState))) return false;
+        if(apply && my_interface) my_interface->setBodyState(bodyState);
+      }
+      return (buffer->readOrSkip(&sNode.pos, apply) &&
+              buffer->readOrSkip(&sNode.rot, apply) &&
+              buffer->readOrSkip(&l_vel, apply) &&
+              buffer->readOrSkip(&last_l_vel, apply) &&
+              buffer->readOrSkip(&a_vel, apply) &&
+              buffer->readOrSkip(&last_a_vel, apply) &&
+              buffer->readOrSkip(&l_acc, apply) &&
+              buffer->readOrSkip(&a_acc, apply) &&
+              buffer->readOrSkip(&f, apply) &&
+              buffer->readOrSkip(&t, apply) &&
+              buffer->readOrSkip(&ground_contact, apply) &&
+              buffer->readOrSkip(&ground_contact_force, apply));
+    }
+
     void SimNode::setLinearVelocity(const Vector &vel) {
       MutexLocker locker(&iMutex);
       if (my_interface) {
@@ -25,6 +25,7 @@
   #warning "SimNode.h"
 #endif
 
+#include <mars/utils/BinaryBuffer.h>
 #include <mars/utils/Mutex.h>
 #include <mars/utils/Vector.h>
 #include <mars/data_broker/ProducerInterface.h>
@@ -165,6 +166,8 @@ namespace mars {
       
       // manipulation
       void update(interfaces::sReal calc_ms, bool physics_thread = true); ///< Updates the values of the node from the physical layer.
+      void saveState(utils::BinaryBuffer *buffer) const; ///< Writes the dynamic state of the node and its body.
+      bool restoreState(utils::BinaryBuffer *buffer, bool apply); ///< Restores a state written by saveState; only checks it if apply is false.
       void rotateAtPoint(const utils::Vector &rotation_point, const utils::Quaternion &rotation, bool move_group);
       void changeNode(interfaces::NodeData *node);
       void clearRelativePosition(void);
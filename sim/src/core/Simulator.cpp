@@ -35,8 +35,17 @@
 #include "ControllerManager.h"
 #include "EntityManager.h"
 #include "Controller.h"
+#include "GeometryLoader.h"
+#include "MeshFitter.h"
+#include "ThreadPool.h"
+#include "TaskGraph.h"
+#include "StepProfiler.h"
+#include "StepRecorder.h"
+#include "RealtimeScheduler.h"
 
 #include <mars/utils/misc.h>
+#include <mars/utils/MutexLocker.h>
+#include <mars/utils/TraceRecorder.h>
 #include <mars/interfaces/SceneParseException.h>
 #include <mars/interfaces/graphics/GraphicsManagerInterface.h>
 #include <mars/interfaces/sim/LoadCenter.h>
@@ -50,6 +59,7 @@
 #include <stdexcept>
 #include <algorithm>
 #include <cctype> // for tolower()
+#include <cstdio>
 
 #ifdef __linux__
 #include <time.h>
@@ -71,18 +81,23 @@ namespace mars {
       exit(signal);
     }
 
+    // islands whose sizes are published by mars_sim/islands
+    static const int numPublishedIslands = 8;
+
 
     Simulator *Simulator::activeSimulator = 0;
+    utils::Mutex Simulator::instanceMutex;
+    int Simulator::nextInstanceId = 0;
+    std::set<data_broker::DataBrokerInterface*> Simulator::dataBrokers;
 
     Simulator::Simulator(lib_manager::LibManager *theManager) :
       lib_manager::LibInterface(theManager),
       exit_sim(false), allow_draw(true),
-      sync_graphics(false), physics_mutex_count(0), physics(0) {
+      sync_graphics(false), physics_mutex_count(0), physics_unlock_count(0),
+      physics(0) {
 
       config_dir = DEFAULT_CONFIG_DIR;
       calc_time = 0;
-      avg_log_time = 0;
-      count = 0;
       config_dir = ".";
 
       std_port = 1600;
@@ -105,16 +120,81 @@ namespace mars {
       arg_run    = 0;
       arg_grid   = 0;
       arg_ortho  = 0;
-      Simulator::activeSimulator = this; // set this Simulator object to the active one
+      realtimeScheduler = new RealtimeScheduler();
+      realtimeNeedsInit = true;
+      threadSettingsChanged = false;
+      realtimePriority = 0;
+      realtimeCpu = -1;
+      updatePool = NULL;
+      updateGraph = NULL;
+      updateThreads = 0;
+      updateThreadsChanged = false;
+      broadphaseChanged = false;
+      profiler = new StepProfiler();
+      // the profiling takes a lock per sample, thus it is opt-in
+      profileInterval = 0;
+      profileCount = 0;
+      tracing = false;
+      nextStateId = 0;
+      recorder = NULL;
+      deterministic = false;
+      recording = replaying = false;
+      recorderActive = recorderChanged = false;
+      stageStep = profiler->addStage("step");
+      stageCollision = profiler->addStage("collision");
+      stageSolver = profiler->addStage("solver");
+      stageNodes = profiler->addStage("nodes");
+      stageJoints = profiler->addStage("joints");
+      stageMotors = profiler->addStage("motors");
+      stageRays = profiler->addStage("rays");
+      stageControllers = profiler->addStage("controllers");
+      stageSimTimer = profiler->addStage("simTimer");
+
+      // several simulators can run in one process (each one loaded by its
+      // own LibManager); the first one stays the active simulator
+      instanceMutex.lock();
+      instanceId = nextInstanceId++;
+      if(!Simulator::activeSimulator) {
+        Simulator::activeSimulator = this;
+      }
+      instanceMutex.unlock();
 
       gravity = Vector(0.0, 0.0, -9.81); // set gravity to earth conditions
 
       // build the factories
       control = new ControlCenter();
       control->loadCenter = new LoadCenter();
+      // graphics-free default loader, replaced if mars_graphics is loaded
+      geometryLoader = new GeometryLoader();
+      control->loadCenter->loadMesh = geometryLoader;
+      control->loadCenter->loadHeightmap = geometryLoader;
+      meshFitter = new MeshFitter();
       control->sim = (SimulatorInterface*)this;
       control->cfg = 0;//defaultCFG;
       dbSimTimePackage.add("simTime", 0.);
+      // number of solver steps of the last step and since the start
+      dbSubstepsPackage.add("substeps", (int)1);
+      dbSubstepsPackage.add("solverSteps", (long)0);
+      // iterations and joint error of the last fast step
+      dbQuickStepPackage.add("iterations", (int)20);
+      dbQuickStepPackage.add("error", 0.0);
+      // contact joints of the last step and heap allocations of the
+      // contact generation since the start
+      dbContactsPackage.add("joints", (int)0);
+      dbContactsPackage.add("allocations", (long)0);
+      // geom pairs whose cached contacts were used in the last step
+      dbContactsPackage.add("cached", (int)0);
+      // bodies, disabled bodies of the last step and wakeups since the start
+      dbSleepPackage.add("bodies", (int)0);
+      dbSleepPackage.add("sleeping", (int)0);
+      dbSleepPackage.add("wakeups", (long)0);
+      // number of islands of the last step and the sizes of the largest
+      dbIslandsPackage.add("islands", (int)0);
+      for(int i=0; i<numPublishedIslands; ++i) {
+        char name[16];
+        sprintf(name, "island%d", i);
+        dbIslandsPackage.add(name, (int)0);
+      }
       // load optional libs
       checkOptionalDependency("data_broker");
       checkOptionalDependency("cfg_manager");
@@ -155,10 +235,31 @@ namespace mars {
       while(((Thread*)this)->isRunning())
         utils::msleep(1);
       fprintf(stderr, "Delete mars_sim\n");
+      setTracing(false);
+      if(recorder) {
+        static_cast<NodeManager*>(control->nodes)->setStepRecorder(NULL);
+        static_cast<MotorManager*>(control->motors)->setStepRecorder(NULL);
+        delete recorder;
+      }
 
       if (control->controllers) delete control->controllers;
 
-      if(control->cfg) {
+      instanceMutex.lock();
+      if(Simulator::activeSimulator == this) {
+        Simulator::activeSimulator = 0;
+      }
+      if(control->dataBroker) {
+        dataBrokers.erase(control->dataBroker);
+        // the other instances keep logging to one of their DataBrokers
+        if(ControlCenter::theDataBroker == control->dataBroker) {
+          ControlCenter::setLogDataBroker(dataBrokers.empty() ? NULL :
+                                          *dataBrokers.begin());
+        }
+      }
+      instanceMutex.unlock();
+
+      // additional instances share the configuration of the first one
+      if(control->cfg && instanceId == 0) {
         string saveFile = configPath.sValue;
         saveFile.append("/mars_Config.yaml");
         control->cfg->writeConfig(saveFile.c_str(), "Config");
@@ -180,6 +281,21 @@ namespace mars {
       libManager->releaseLibrary("cfg_manager");
       libManager->releaseLibrary("data_broker");
       libManager->releaseLibrary("log_console");
+      delete geometryLoader;
+      delete meshFitter;
+      delete updateGraph;
+      for(size_t i=0; i<updateTasks.size(); ++i) {
+        delete updateTasks[i];
+      }
+      if(physics) static_cast<WorldPhysics*>(physics)->setThreadPool(NULL);
+      delete updatePool;
+      delete profiler;
+      delete realtimeScheduler;
+      std::map<unsigned long, BinaryBuffer*>::iterator stateIt;
+      for(stateIt = savedStates.begin(); stateIt != savedStates.end();
+          ++stateIt) {
+        delete stateIt->second;
+      }
     }
 
     void Simulator::newLibLoaded(const std::string &libName) {
@@ -190,7 +306,14 @@ namespace mars {
       if(libName == "data_broker") {
         control->dataBroker = libManager->getLibraryAs<data_broker::DataBrokerInterface>("data_broker");
         if(control->dataBroker) {
-          ControlCenter::theDataBroker = control->dataBroker;
+          // the log messages of all simulators are sent to the first
+          // DataBroker
+          instanceMutex.lock();
+          dataBrokers.insert(control->dataBroker);
+          if(!ControlCenter::theDataBroker) {
+            ControlCenter::setLogDataBroker(control->dataBroker);
+          }
+          instanceMutex.unlock();
           // create streams
           getTimeMutex.lock();
           dbSimTimeId = control->dataBroker->pushData("mars_sim", "simTime",
@@ -198,6 +321,26 @@ namespace mars {
                                                       NULL,
                                                       data_broker::DATA_PACKAGE_READ_FLAG);
           getTimeMutex.unlock();
+          dbSubstepsId = control->dataBroker->pushData("mars_sim", "substeps",
+                                                       dbSubstepsPackage,
+                                                       NULL,
+                                                       data_broker::DATA_PACKAGE_READ_FLAG);
+          dbQuickStepId = control->dataBroker->pushData("mars_sim", "quickstep",
+                                                        dbQuickStepPackage,
+                                                        NULL,
+                                                        data_broker::DATA_PACKAGE_READ_FLAG);
+          dbContactsId = control->dataBroker->pushData("mars_sim", "contacts",
+                                                       dbContactsPackage,
+                                                       NULL,
+                                                       data_broker::DATA_PACKAGE_READ_FLAG);
+          dbSleepId = control->dataBroker->pushData("mars_sim", "sleep",
+                                                    dbSleepPackage,
+                                                    NULL,
+                                                    data_broker::DATA_PACKAGE_READ_FLAG);
+          dbIslandsId = control->dataBroker->pushData("mars_sim", "islands",
+                                                      dbIslandsPackage,
+                                                      NULL,
+                                                      data_broker::DATA_PACKAGE_READ_FLAG);
           control->dataBroker->createTimer("mars_sim/simTimer");
           control->dataBroker->createTrigger("mars_sim/prePhysicsUpdate");
           control->dataBroker->createTrigger("mars_sim/postPhysicsUpdate");
@@ -251,6 +394,8 @@ namespace mars {
       }
 
       control->nodes = new NodeManager(control);
+      static_cast<NodeManager*>(control->nodes)->setMeshFitter(meshFitter);
+      static_cast<NodeManager*>(control->nodes)->setHeightCacheDir(cfgTerrainCache.sValue);
       control->joints = new JointManager(control);
       control->motors = new MotorManager(control);
       control->sensors = new SensorManager(control);
@@ -260,19 +405,46 @@ namespace mars {
       control->controllers->setDefaultPort(std_port);
       control->nodes->setVisualRep(0, cfgVisRep.iValue);
 
+      // every instance records its own world (see getInstanceFile)
+      recorder = new StepRecorder(control);
+      static_cast<NodeManager*>(control->nodes)->setStepRecorder(recorder);
+      static_cast<MotorManager*>(control->motors)->setStepRecorder(recorder);
+
       if (control->graphics) {
         control->graphics->addGraphicsUpdateInterface((GraphicsUpdateInterface*)this);
       }
       // init the physics-engine
       //Convention startPhysics function
       physics = PhysicsMapper::newWorldPhysics(control);
+      setBroadphase();
       physics->initTheWorld();
       // the physics step_size is in seconds
       physics->step_size = calc_ms/1000.;
       physics->fast_step = false;
+      physics->quickstep_iterations = cfgQuickStepIterations.iValue;
+      physics->quickstep_w = cfgQuickStepW.dValue;
+      physics->quickstep_max_error = cfgQuickStepMaxError.dValue;
+      physics->quickstep_min_iterations = cfgQuickStepMinIterations.iValue;
+      physics->quickstep_max_iterations = cfgQuickStepMaxIterations.iValue;
 
       physics->world_erp = cfgWorldErp.dValue;
       physics->world_cfm = cfgWorldCfm.dValue;
+      physics->adaptive_step = cfgAdaptiveStep.bValue;
+      physics->max_substeps = cfgMaxSubsteps.iValue;
+      physics->max_penetration = cfgMaxPenetration.dValue;
+      physics->max_joint_error = cfgMaxJointError.dValue;
+      physics->max_manifold_contacts = cfgMaxManifoldContacts.iValue;
+      physics->contact_cache_distance = cfgContactCacheDistance.dValue;
+      physics->contact_cache_angle = cfgContactCacheAngle.dValue;
+      physics->auto_disable = cfgAutoDisable.bValue;
+      physics->auto_disable_linear = cfgAutoDisableLinear.dValue;
+      physics->auto_disable_angular = cfgAutoDisableAngular.dValue;
+      physics->auto_disable_steps = cfgAutoDisableSteps.iValue;
+      physics->auto_disable_time = cfgAutoDisableTime.dValue;
+      updateSolverThreads();
+      physics->terrain_tile_size = cfgTerrainTileSize.iValue;
+      physics->terrain_tile_margin = cfgTerrainTileMargin.dValue;
+      physics->terrain_tile_keep_steps = cfgTerrainTileKeepSteps.iValue;
 
       gravity.x() = cfgGX.dValue;
       gravity.y() = cfgGY.dValue;
@@ -321,7 +493,13 @@ namespace mars {
        */
     void Simulator::run() {
 
+      TraceRecorder::setThreadName("mars_sim physics");
       while (!kill_sim) {
+        if(threadSettingsChanged) {
+          threadSettingsChanged = false;
+          RealtimeScheduler::setThreadPriority(realtimePriority);
+          RealtimeScheduler::setThreadAffinity(realtimeCpu);
+        }
         stepping_mutex.lock();
         if(simulationStatus == STOPPING)
           simulationStatus = STOPPED;
@@ -332,11 +510,13 @@ namespace mars {
             stepping_mutex.unlock();
             break;
           }
+          // the time of the pause is no deadline miss
+          realtimeNeedsInit = true;
         }
 
         if (sync_graphics && !sync_count) {
-            msleep(2);
             stepping_mutex.unlock();
+            waitForFinishedDraw();
             continue;
         }
 
@@ -345,13 +525,13 @@ namespace mars {
         }
         stepping_mutex.unlock();
 
-        if(my_real_time) {
+        if(my_real_time && !isDeterministic()) {
           myRealTime();
-        } else if(physics_mutex_count > 0) {
+        } else {
           // if not in realtime this thread would lock the physicsThread right
-          // after releasing it. If an other thread is trying to lock
-          // it (physics_mutex_count > 0) we sleep so it has a chance.
-          msleep(1);
+          // after releasing it. If other threads are trying to lock it we
+          // wait until they had their turn.
+          waitForPhysicsLockers();
         }
         step();
       }
@@ -363,7 +543,8 @@ namespace mars {
 
     void Simulator::step(bool setState) {
       std::vector<pluginStruct>::iterator p_iter;
-      long time;
+      StepProfiler *stepProfiler = activeProfiler();
+      ScopedTrace trace("mars_sim", "Simulator::step");
 
       Status oldState;
 
@@ -374,46 +555,74 @@ namespace mars {
         simulationStatus = STEPPING;
       }
 
-#ifdef DEBUG_TIME
-      long startTime = utils::getTime();
+      if(recorderChanged) {
+        updateRecorder();
+      }
 
-#endif
-      if(control->dataBroker) {
-        control->dataBroker->trigger("mars_sim/prePhysicsUpdate");
+      if(broadphaseChanged) {
+        broadphaseChanged = false;
+        physics->updateBroadphase();
       }
-      physics->stepTheWorld();
-#ifdef DEBUG_TIME
-      LOG_DEBUG("Step World: %ld", getTimeDiff(startTime));
-#endif
 
-      control->nodes->updateDynamicNodes(calc_ms); //Moved update to here, otherwise RaySensor is one step behind the world every time
-      control->joints->updateJoints(calc_ms);
-      control->motors->updateMotors(calc_ms);
-      control->controllers->updateControllers(calc_ms);
+      long long stepStartTime = 0;
+      if(stepProfiler) {
+        stepStartTime = utils::getTimeMicroseconds();
+      }
 
-      if(show_time)
-        time = utils::getTime();
+      if(control->dataBroker) {
+        control->dataBroker->trigger("mars_sim/prePhysicsUpdate");
+      }
+      if(recorderActive) {
+        recorder->beginStep();
+      }
+      {
+        ScopedTrace worldTrace("mars_sim", "stepTheWorld");
+        physics->stepTheWorld();
+      }
+      if(stepProfiler) {
+        stepProfiler->addSample(stageCollision, physics->collision_time);
+        stepProfiler->addSample(stageSolver, physics->solver_time);
+      }
+      if(physics->adaptive_step && control->dataBroker) {
+        dbSubstepsPackage[0].i = physics->num_substeps;
+        dbSubstepsPackage[1].l += physics->num_substeps;
+        control->dataBroker->pushData(dbSubstepsId, dbSubstepsPackage);
+      }
+      if(physics->fast_step && physics->quickstep_max_error > 0 &&
+         control->dataBroker) {
+        dbQuickStepPackage[0].i = physics->quickstep_num_iterations;
+        dbQuickStepPackage[1].d = physics->quickstep_error;
+        control->dataBroker->pushData(dbQuickStepId, dbQuickStepPackage);
+      }
 
+      if(updateThreadsChanged) {
+        setupUpdatePipeline();
+      }
+      //Moved update to here, otherwise RaySensor is one step behind the world every time
+      if(updateGraph && !isDeterministic()) {
+        updateGraph->run();
+      }
+      else {
+        updateNodes();
+        updateRays();
+        updateJoints();
+        updateMotors();
+        updateControllers();
+      }
+      if(recorderActive) {
+        recorder->afterUpdate();
+      }
 
       getTimeMutex.lock();
       dbSimTimePackage[0].d += calc_ms;
       getTimeMutex.unlock();
       if(control->dataBroker) {
+        ScopedStepTimer timer(stepProfiler, stageSimTimer);
         control->dataBroker->pushData(dbSimTimeId,
                                       dbSimTimePackage);
         control->dataBroker->stepTimer("mars_sim/simTimer", calc_ms);
       }
 
-      if(show_time) {
-        avg_log_time += getTimeDiff(time);
-        if(++count > 100) {
-          avg_log_time /= count;
-          count = 0;
-          fprintf(stderr, "debug_log_time: %g\n", avg_log_time);
-          avg_log_time = 0.0;
-        }
-      }
-
       pluginLocker.lockForRead();
 
       // It is possible for plugins to call switchPluginUpdateMode during
@@ -421,25 +630,15 @@ namespace mars {
       // We use erased_active to notify this loop about an erasure.
       for(unsigned int i = 0; i < activePlugins.size();) {
         erased_active = false;
-        if(show_time)
-          time = utils::getTime();
-
-        activePlugins[i].p_interface->update(calc_ms);
+        {
+          ScopedStepTimer timer(stepProfiler,
+                                stepProfiler ? getPluginStage(&pluginStages,
+                                                              activePlugins[i],
+                                                              "plugin/") : 0);
+          activePlugins[i].p_interface->update(calc_ms);
+        }
 
         if(!erased_active) {
-          if(show_time) {
-            time = getTimeDiff(time);
-            activePlugins[i].timer += time;
-            activePlugins[i].t_count++;
-            if(activePlugins[i].t_count > 20) {
-              activePlugins[i].timer /= activePlugins[i].t_count;
-              activePlugins[i].t_count = 0;
-              fprintf(stderr, "debug_time: %s: %g\n",
-                      activePlugins[i].name.c_str(),
-                      activePlugins[i].timer);
-              activePlugins[i].timer = 0.0;
-            }
-          }
           ++i;
         }
       }
@@ -447,7 +646,9 @@ namespace mars {
       if (sync_graphics) {
         calc_time += calc_ms;
         if (calc_time >= sync_time) {
+          drawMutex.lock();
           sync_count = 0;
+          drawMutex.unlock();
           if(control->graphics)
             this->allowDraw();
           calc_time = 0;
@@ -461,9 +662,290 @@ namespace mars {
         simulationStatus = oldState;
       }
 
+      if(recorderActive) {
+        collectState(&hashState);
+        recorder->endStep(StepRecorder::hash(hashState.getData()));
+      }
+
+      if(stepProfiler) {
+        stepProfiler->addSample(stageStep,
+                                utils::getTimeDiffMicroseconds(stepStartTime));
+        if(++profileCount >= profileInterval) {
+          profileCount = 0;
+          stepProfiler->publish(control->dataBroker);
+          if(control->dataBroker) {
+            dbContactsPackage[0].i = physics->num_contact_joints;
+            dbContactsPackage[1].l = (long)physics->contact_allocations;
+            dbContactsPackage[2].i = physics->num_cached_pairs;
+            control->dataBroker->pushData(dbContactsId, dbContactsPackage);
+            dbSleepPackage[0].i = physics->num_bodies;
+            dbSleepPackage[1].i = physics->num_sleeping_bodies;
+            dbSleepPackage[2].l = (long)physics->num_wakeups;
+            control->dataBroker->pushData(dbSleepId, dbSleepPackage);
+            const std::vector<int> &islands = physics->island_sizes;
+            dbIslandsPackage[0].i = (int)islands.size();
+            for(int i=0; i<numPublishedIslands; ++i) {
+              dbIslandsPackage[i+1].i = i < (int)islands.size() ? islands[i] : 0;
+            }
+            control->dataBroker->pushData(dbIslandsId, dbIslandsPackage);
+          }
+          if(show_time) {
+            stepProfiler->print();
+          }
+        }
+      }
+
       physicsThreadUnlock();
     }
 
+    void Simulator::updateNodes(void) {
+      ScopedStepTimer timer(activeProfiler(), stageNodes);
+      control->nodes->updateDynamicNodes(calc_ms);
+    }
+
+    void Simulator::updateRays(void) {
+      // the sensors of the nodes collected their rays during the update
+      ScopedStepTimer timer(activeProfiler(), stageRays);
+      physics->castRays();
+    }
+
+    void Simulator::updateJoints(void) {
+      ScopedStepTimer timer(activeProfiler(), stageJoints);
+      control->joints->updateJoints(calc_ms);
+    }
+
+    void Simulator::updateMotors(void) {
+      ScopedStepTimer timer(activeProfiler(), stageMotors);
+      control->motors->updateMotors(calc_ms);
+    }
+
+    void Simulator::updateControllers(void) {
+      ScopedStepTimer timer(activeProfiler(), stageControllers);
+      control->controllers->updateControllers(calc_ms);
+    }
+
+    /**
+     * \brief Starts or stops the recording or replay after the "record" or
+     * "replay" setting changed. A replay has priority over a recording.
+     * Called from step(), so no update is running.
+     */
+    void Simulator::updateRecorder(void) {
+      recorderChanged = false;
+      if(!recorder) return;
+      unsigned long seed;
+      if(replaying) {
+        if(!recorder->isReplaying() &&
+           recorder->startReplay(getInstanceFile(replayFile), &seed)) {
+          physics->setRandomSeed(seed);
+        }
+      }
+      else if(recording) {
+        if(!recorder->isRecording()) {
+          // the DataBroker items are given as "group/name;group/name"
+          recorder->clearDataItems();
+          size_t start = 0;
+          while(start < recordDataItems.size()) {
+            size_t end = recordDataItems.find(';', start);
+            if(end == string::npos) end = recordDataItems.size();
+            string item = recordDataItems.substr(start, end-start);
+            size_t slash = item.find('/');
+            if(slash != string::npos) {
+              recorder->addDataItem(item.substr(0, slash),
+                                    item.substr(slash+1));
+            }
+            start = end+1;
+          }
+          // the replay starts the solver with the same random state
+          seed = physics->getRandomSeed();
+          if(recorder->startRecording(getInstanceFile(recordFile), seed)) {
+            physics->setRandomSeed(seed);
+          }
+        }
+      }
+      else {
+        recorder->stop();
+      }
+      recorderActive = recorder->isRecording() || recorder->isReplaying();
+      updateSolverThreads();
+    }
+
+    /**
+     * \brief The instances share the cfg, thus the additional instances
+     * append their id to the file names: "mars_record.bin" becomes
+     * "mars_record_1.bin" for the second instance.
+     */
+    std::string Simulator::getInstanceFile(const std::string &file) const {
+      if(!instanceId) return file;
+      std::stringstream str;
+      str << "_" << instanceId;
+      size_t dot = file.rfind('.');
+      size_t slash = file.find_last_of("/\\");
+      if(dot == string::npos || (slash != string::npos && dot < slash)) {
+        return file + str.str();
+      }
+      return file.substr(0, dot) + str.str() + file.substr(dot);
+    }
+
+    /**
+     * \brief In deterministic mode the update runs sequentially and the
+     * steps are not synchronized with the wall clock. A recording or
+     * replay always runs in deterministic mode.
+     */
+    bool Simulator::isDeterministic(void) const {
+      return deterministic || recorderActive;
+    }
+
+    /**
+     * \brief The threaded island solve draws from the random generator of
+     * the physics in no fixed order, thus the world is solved by one
+     * thread in deterministic mode.
+     */
+    void Simulator::updateSolverThreads(void) {
+      physics->solver_threads = isDeterministic() ? 1 : cfgSolverThreads.iValue;
+    }
+
+    /**
+     * \brief Passes the broadphase settings of the cfg to the physics;
+     * they are used by the next initTheWorld() or updateBroadphase().
+     */
+    void Simulator::setBroadphase(void) {
+      physics->broadphase = cfgBroadphase.sValue;
+      physics->hash_min_level = cfgHashMinLevel.iValue;
+      physics->hash_max_level = cfgHashMaxLevel.iValue;
+      physics->quadtree_center = Vector(cfgQuadtreeCX.dValue,
+                                        cfgQuadtreeCY.dValue,
+                                        cfgQuadtreeCZ.dValue);
+      physics->quadtree_extents = Vector(cfgQuadtreeEX.dValue,
+                                         cfgQuadtreeEY.dValue,
+                                         cfgQuadtreeEZ.dValue);
+      physics->quadtree_depth = cfgQuadtreeDepth.iValue;
+    }
+
+    void Simulator::setRealtimePolicy(const std::string &name) {
+      RealtimeScheduler::Policy policy;
+      if(RealtimeScheduler::policyFromString(name, &policy)) {
+        realtimeScheduler->setPolicy(policy);
+      }
+      else {
+        LOG_ERROR("Simulator: unknown realtime policy \"%s\"", name.c_str());
+      }
+    }
+
+    void Simulator::setMeshFitMode(const std::string &name) {
+      MeshFitter::Mode mode;
+      if(MeshFitter::modeFromString(name, &mode)) {
+        meshFitter->setMode(mode);
+      }
+      else {
+        LOG_ERROR("Simulator: unknown mesh fitting mode \"%s\"", name.c_str());
+      }
+    }
+
+    /**
+     * \brief Starts or stops the trace recording. The trace is written to
+     * the "trace file" when the recording is stopped.
+     */
+    void Simulator::setTracing(bool enable) {
+      if(enable == tracing) return;
+      tracing = enable;
+      TraceRecorder::setEnabled(enable);
+      if(!enable) {
+        if(TraceRecorder::writeFile(traceFile)) {
+          LOG_INFO("Simulator: wrote trace to \"%s\" (%lu events dropped)",
+                   traceFile.c_str(), TraceRecorder::getNumDroppedEvents());
+        }
+      }
+    }
+
+    /**
+     * \brief Returns the profiler if profiling is enabled, otherwise NULL.
+     */
+    StepProfiler* Simulator::activeProfiler(void) const {
+      return profileInterval > 0 ? profiler : NULL;
+    }
+
+    /**
+     * \brief Returns the profiler stage of a plugin; the stage is created
+     * on the first call.
+     */
+    int Simulator::getPluginStage(std::map<PluginInterface*, int> *stages,
+                                  const pluginStruct &plugin,
+                                  const std::string &prefix) {
+      std::map<PluginInterface*, int>::iterator it;
+      it = stages->find(plugin.p_interface);
+      if(it != stages->end()) return it->second;
+      int stage = profiler->addStage(prefix + plugin.name);
+      (*stages)[plugin.p_interface] = stage;
+      return stage;
+    }
+
+    /**
+     * \brief Creates the thread pool and the task graph for the update
+     * after the physics step according to the "update threads" property.
+     *
+     * The nodes and joints are independent of each other and are updated
+     * in parallel, the motors need the updated joints and the controllers
+     * need the updated motors. The managers additionally distribute their
+     * objects over the pool. Reading the physics state only takes the
+     * world lock for reading, thus the node and joint updates really run
+     * concurrently; setting the motor values and damping nodes write to
+     * the physics and are serialized by the world lock. Called from
+     * step(), so no update is running.
+     */
+    void Simulator::setupUpdatePipeline(void) {
+      NodeManager *nodeManager = static_cast<NodeManager*>(control->nodes);
+      JointManager *jointManager = static_cast<JointManager*>(control->joints);
+      MotorManager *motorManager = static_cast<MotorManager*>(control->motors);
+      WorldPhysics *worldPhysics = static_cast<WorldPhysics*>(physics);
+
+      updateThreadsChanged = false;
+      nodeManager->setThreadPool(NULL);
+      jointManager->setThreadPool(NULL);
+      motorManager->setThreadPool(NULL);
+      worldPhysics->setThreadPool(NULL);
+      delete updateGraph;
+      updateGraph = NULL;
+      for(size_t i=0; i<updateTasks.size(); ++i) {
+        delete updateTasks[i];
+      }
+      updateTasks.clear();
+      delete updatePool;
+      updatePool = NULL;
+
+      if(updateThreads == 0) {
+        return;
+      }
+
+      updatePool = new ThreadPool(updateThreads);
+      nodeManager->setThreadPool(updatePool);
+      jointManager->setThreadPool(updatePool);
+      motorManager->setThreadPool(updatePool);
+      worldPhysics->setThreadPool(updatePool);
+
+      updateTasks.push_back(new ThreadPoolMemberTask<Simulator>(this, &Simulator::updateNodes));
+      updateTasks.push_back(new ThreadPoolMemberTask<Simulator>(this, &Simulator::updateJoints));
+      updateTasks.push_back(new ThreadPoolMemberTask<Simulator>(this, &Simulator::updateMotors));
+      updateTasks.push_back(new ThreadPoolMemberTask<Simulator>(this, &Simulator::updateControllers));
+      updateTasks.push_back(new ThreadPoolMemberTask<Simulator>(this, &Simulator::updateRays));
+
+      updateGraph = new TaskGraph(updatePool);
+      int nodesTask = updateGraph->addTask(updateTasks[0]);
+      int jointsTask = updateGraph->addTask(updateTasks[1]);
+      int motorsTask = updateGraph->addTask(updateTasks[2]);
+      int controllersTask = updateGraph->addTask(updateTasks[3]);
+      int raysTask = updateGraph->addTask(updateTasks[4]);
+      updateGraph->addDependency(motorsTask, nodesTask);
+      updateGraph->addDependency(motorsTask, jointsTask);
+      updateGraph->addDependency(controllersTask, motorsTask);
+      // the rays are cast in parallel to the joint and motor updates;
+      // their physics accesses wait for the locked narrowphase
+      updateGraph->addDependency(raysTask, nodesTask);
+      updateGraph->addDependency(controllersTask, raysTask);
+
+      LOG_INFO("Simulator: update after physics step uses %d threads",
+               updatePool->getNumThreads()+1);
+    }
+
     /**
      * \return \c true if started, \c false if stopped
      */
@@ -511,64 +993,18 @@ namespace mars {
 
     }
 
-    //consider the case where the time step is smaller than 1 ms
+    /**
+     * \brief Waits for the deadline of the next step, see
+     * RealtimeScheduler for the handling of missed deadlines.
+     */
     void Simulator::myRealTime() {
-#ifdef __linux__  //__unix__, wenn Darwin das mitmacht.
-      //used to remember last time this function was called
-      //and as absolute (minimum) wake-up time.
-      static struct timespec ts;
-      static bool tsNeedsInit = true;
-      if (tsNeedsInit)
-        {
-          int retval = clock_gettime(CLOCK_MONOTONIC, &ts);
-          if (retval != 0)
-            {
-              throw std::runtime_error("clock_gettime(CLOCK_MONOTONIC, ...) failed");
-            }
-          tsNeedsInit = false;
-        }
-
-      //schedule minimum sleep time
-      ts.tv_nsec += calc_ms * 1000000;
-
-      //the nsec value may not exceed one second
-      while (ts.tv_nsec > 1000000000)
-        {
-          ts.tv_nsec -= 1000000000;
-          ts.tv_sec += 1;
-        }
-
-      //sleep...
-      int retval = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, 0);
-      if (retval != 0)
-        {
-          std::cerr << "WARNING: Your system is too slow!" << std::endl;
-        }
-
-      //remember time
-      retval = clock_gettime(CLOCK_MONOTONIC, &ts);
-      if (retval != 0)
-        {
-          throw std::runtime_error("clock_gettime(CLOCK_MONOTONIC, ...) failed");
-        }
-#else
-      static long myTime = utils::getTime();
-      long timeDiff = getTimeDiff(myTime);
-
-      if(show_time) {
-        fprintf(stderr, "timeDiff: %ld\n", timeDiff);
-      }
-      if(timeDiff < calc_ms) {
-        long valSleep = calc_ms - timeDiff;
-        msleep(valSleep);
-        myTime = utils::getTime();
-        if(show_time) {
-          fprintf(stderr, "sleep time: %ld\n", valSleep);
-        }
-      } else {
-        myTime += timeDiff;
+      if(realtimeNeedsInit) {
+        realtimeScheduler->reset();
+        realtimeNeedsInit = false;
       }
-#endif
+      realtimeScheduler->setPeriod(calc_ms);
+      realtimeScheduler->waitForNextStep();
+      realtimeScheduler->publish(control->dataBroker, profileInterval);
     }
 
 
@@ -584,9 +1020,13 @@ namespace mars {
 #ifdef __linux__
         std::stringstream str;
         str << "/tmp/mars/" << (int) getpid() << "/";
+        if(instanceId) str << instanceId << "/";
         return str.str();
 #else
-        return configPath.sValue + std::string("/tmp/");
+        std::stringstream str;
+        str << configPath.sValue << "/tmp/";
+        if(instanceId) str << instanceId << "/";
+        return str.str();
 #endif
         
     }
@@ -657,6 +1097,8 @@ namespace mars {
         startStopTrigger();//if the simulation has been stopped for loading, now it continues
       }
       sceneHasChanged(false);
+      // choose the broadphase for the new geoms before the next step
+      if(physics->broadphase == "auto") broadphaseChanged = true;
       //load_actual = 0;
       return 1;
     }
@@ -682,8 +1124,6 @@ namespace mars {
 
 
     void Simulator::finishedDraw(void) {
-      long time;
-
       processRequests();
 
       if (reloadSim) {
@@ -714,8 +1154,11 @@ namespace mars {
           StartSimulation();
         }
       }
+      drawMutex.lock();
       allow_draw = 0;
       sync_count = 1;
+      drawWc.wakeAll();
+      drawMutex.unlock();
 
       /** NO idea what the following commented section should be good for
           the erased_active is pretty much useless
@@ -746,25 +1189,13 @@ namespace mars {
 
 
       pluginLocker.lockForRead();
+      StepProfiler *guiProfiler = activeProfiler();
       for (unsigned int i=0; i<guiPlugins.size(); i++) {
-        if(show_time)
-          time = utils::getTime();
-
+        ScopedStepTimer timer(guiProfiler,
+                              guiProfiler ? getPluginStage(&guiPluginStages,
+                                                           guiPlugins[i],
+                                                           "gui_plugin/") : 0);
         guiPlugins[i].p_interface->update(0);
-
-        if(show_time) {
-          time = getTimeDiff(time);
-          guiPlugins[i].timer_gui += time;
-          guiPlugins[i].t_count_gui++;
-          if(guiPlugins[i].t_count_gui > 20) {
-            guiPlugins[i].timer_gui /= guiPlugins[i].t_count_gui;
-            guiPlugins[i].t_count_gui = 0;
-            fprintf(stderr, "debug_time_gui: %s: %g\n",
-                    guiPlugins[i].name.data(),
-                    guiPlugins[i].timer_gui);
-            guiPlugins[i].timer_gui = 0.0;
-          }
-        }
       }
       pluginLocker.unlock();
       // process ice events
@@ -810,6 +1241,105 @@ namespace mars {
       stepping_mutex.unlock();
     }
 
+    unsigned long Simulator::saveState(void) {
+      BinaryBuffer *state = new BinaryBuffer();
+      writeState(state);
+      MutexLocker locker(&stateMutex);
+      savedStates[++nextStateId] = state;
+      return nextStateId;
+    }
+
+    bool Simulator::restoreState(unsigned long handle) {
+      MutexLocker locker(&stateMutex);
+      std::map<unsigned long, BinaryBuffer*>::iterator it;
+      it = savedStates.find(handle);
+      if(it == savedStates.end()) {
+        LOG_ERROR("Simulator: no saved state with handle %lu", handle);
+        return false;
+      }
+      return readState(it->second);
+    }
+
+    void Simulator::releaseState(unsigned long handle) {
+      MutexLocker locker(&stateMutex);
+      std::map<unsigned long, BinaryBuffer*>::iterator it;
+      it = savedStates.find(handle);
+      if(it != savedStates.end()) {
+        delete it->second;
+        savedStates.erase(it);
+      }
+    }
+
+    /**
+     * \brief Writes the state of the nodes, motors, controllers and sensors.
+     *
+     * Joints have no state of their own, they follow the bodies. Must not
+     * be called from within the simulation step (e.g. by a plugin update).
+     */
+    void Simulator::writeState(BinaryBuffer *state) {
+      physicsThreadLock();
+      collectState(state);
+      physicsThreadUnlock();
+    }
+
+    /**
+     * \brief Reads a snapshot written by collectState from the beginning.
+     * If \c apply is false the snapshot is only checked against the
+     * current scene and nothing is changed.
+     */
+    bool Simulator::parseState(BinaryBuffer *state, bool apply) {
+      double simTime;
+      unsigned long seed;
+
+      state->rewind();
+      if(!state->read(&simTime) || !state->readOrSkip(&calc_time, apply) ||
+         !state->read(&seed)) {
+        return false;
+      }
+      if(apply) {
+        getTimeMutex.lock();
+        dbSimTimePackage[0].d = simTime;
+        getTimeMutex.unlock();
+        physics->setRandomSeed(seed);
+      }
+      return (static_cast<NodeManager*>(control->nodes)->restoreState(state, apply) &&
+              static_cast<MotorManager*>(control->motors)->restoreState(state, apply) &&
+              static_cast<ControllerManager*>(control->controllers)->restoreState(state, apply) &&
+              static_cast<SensorManager*>(control->sensors)->restoreState(state, apply) &&
+              state->atEnd());
+    }
+
+    /**
+     * \brief Writes the state without locking the physics thread, thus it
+     * can be used within the simulation step.
+     */
+    void Simulator::collectState(BinaryBuffer *state) {
+      state->clear();
+      getTimeMutex.lock();
+      state->write(dbSimTimePackage[0].d);
+      getTimeMutex.unlock();
+      state->write(calc_time);
+      // the solver continues with the same random state after a restore
+      state->write(physics->getRandomSeed());
+      static_cast<NodeManager*>(control->nodes)->saveState(state);
+      static_cast<MotorManager*>(control->motors)->saveState(state);
+      static_cast<ControllerManager*>(control->controllers)->saveState(state);
+      static_cast<SensorManager*>(control->sensors)->saveState(state);
+    }
+
+    bool Simulator::readState(BinaryBuffer *state) {
+      bool ok;
+
+      physicsThreadLock();
+      // the whole snapshot is checked before anything is changed
+      ok = parseState(state, false) && parseState(state, true);
+      physicsThreadUnlock();
+      if(!ok) {
+        LOG_ERROR("Simulator: the saved state does not match the scene");
+      }
+      return ok;
+    }
+
 
     void Simulator::reloadWorld(void) {
       control->nodes->reloadNodes();
@@ -897,16 +1427,47 @@ namespace mars {
       physicsCountMutex.lock();
       physics_mutex_count++;
       physicsCountMutex.unlock();
+      ScopedTrace trace("mars_sim", "physicsThreadLock");
       physicsMutex.lock();
     }
 
     void Simulator::physicsThreadUnlock(void) {
       // physics_mutex_count is used to see how many threads are trying to
       // acquire the lock. Also see Simulator::run() on how this is used.
+      physicsMutex.unlock();
       physicsCountMutex.lock();
       physics_mutex_count--;
+      physics_unlock_count++;
+      physicsCountWc.wakeAll();
       physicsCountMutex.unlock();
-      physicsMutex.unlock();
+    }
+
+    /**
+     * \brief Called by the simulation thread between two steps. Waits
+     * until every thread that is currently trying to lock the physics
+     * thread got the lock once. Threads that start to wait later do not
+     * delay the next step.
+     */
+    void Simulator::waitForPhysicsLockers(void) {
+      physicsCountMutex.lock();
+      unsigned long target = physics_unlock_count + physics_mutex_count;
+      while(physics_mutex_count > 0 && physics_unlock_count < target &&
+            !kill_sim) {
+        physicsCountWc.wait(&physicsCountMutex);
+      }
+      physicsCountMutex.unlock();
+    }
+
+    /**
+     * \brief Called by the simulation thread if it has to wait until the
+     * graphics finished the frame (sync_graphics).
+     */
+    void Simulator::waitForFinishedDraw(void) {
+      drawMutex.lock();
+      while(sync_graphics && !sync_count && !kill_sim) {
+        drawWc.wait(&drawMutex);
+      }
+      drawMutex.unlock();
     }
 
     PhysicsInterface* Simulator::getPhysics(void) const {
@@ -922,6 +1483,9 @@ namespace mars {
       kill_sim = 1;
       stepping_wc.wakeAll();
       stepping_mutex.unlock();
+      drawMutex.lock();
+      drawWc.wakeAll();
+      drawMutex.unlock();
       if(isCurrentThread()) {
         return;
       }
@@ -1125,7 +1689,10 @@ namespace mars {
 
 
     void Simulator::setSyncThreads(bool value) {
+      drawMutex.lock();
       sync_graphics = value;
+      drawWc.wakeAll();
+      drawMutex.unlock();
     }
 
     /**
@@ -1140,7 +1707,23 @@ namespace mars {
      * This method is used for gui and simulation synchronization.
      */
     void Simulator::allowDraw(void) {
+      drawMutex.lock();
       allow_draw = 1;
+      drawWc.wakeAll();
+      drawMutex.unlock();
+    }
+
+    /**
+     * \brief Lets the drawing thread wait for the next frame instead of
+     * polling getAllowDraw().
+     * \return true if a frame can be drawn.
+     */
+    bool Simulator::waitForAllowDraw(unsigned long timeoutMilliseconds) {
+      MutexLocker locker(&drawMutex);
+      if(sync_graphics && !allow_draw && !kill_sim) {
+        drawWc.wait(&drawMutex, timeoutMilliseconds);
+      }
+      return allow_draw || !sync_graphics;
     }
 
     /**
@@ -1211,8 +1794,57 @@ namespace mars {
         return;
       }
 
+      if(_property.paramId == cfgQuickStepIterations.paramId) {
+        if(physics) physics->quickstep_iterations = _property.iValue;
+        return;
+      }
+
+      if(_property.paramId == cfgQuickStepW.paramId) {
+        if(physics) physics->quickstep_w = _property.dValue;
+        return;
+      }
+
+      if(_property.paramId == cfgQuickStepMaxError.paramId) {
+        if(physics) physics->quickstep_max_error = _property.dValue;
+        return;
+      }
+
+      if(_property.paramId == cfgQuickStepMinIterations.paramId) {
+        if(physics) physics->quickstep_min_iterations = _property.iValue;
+        return;
+      }
+
+      if(_property.paramId == cfgQuickStepMaxIterations.paramId) {
+        if(physics) physics->quickstep_max_iterations = _property.iValue;
+        return;
+      }
+
       if(_property.paramId == cfgRealtime.paramId) {
         my_real_time = _property.bValue;
+        realtimeNeedsInit = true;
+        return;
+      }
+
+      if(_property.paramId == cfgRealtimePolicy.paramId) {
+        setRealtimePolicy(_property.sValue);
+        return;
+      }
+
+      if(_property.paramId == cfgRealtimeMaxBurst.paramId) {
+        realtimeScheduler->setMaxBurst(_property.iValue);
+        return;
+      }
+
+      // the scheduling of the physics thread is changed by the thread
+      if(_property.paramId == cfgRealtimePriority.paramId) {
+        realtimePriority = _property.iValue;
+        threadSettingsChanged = true;
+        return;
+      }
+
+      if(_property.paramId == cfgRealtimeCpu.paramId) {
+        realtimeCpu = _property.iValue;
+        threadSettingsChanged = true;
         return;
       }
 
@@ -1264,11 +1896,232 @@ namespace mars {
         return;
       }
 
+      if(_property.paramId == cfgAdaptiveStep.paramId) {
+        physics->adaptive_step = _property.bValue;
+        return;
+      }
+
+      if(_property.paramId == cfgMaxSubsteps.paramId) {
+        physics->max_substeps = _property.iValue;
+        return;
+      }
+
+      if(_property.paramId == cfgMaxPenetration.paramId) {
+        physics->max_penetration = _property.dValue;
+        return;
+      }
+
+      if(_property.paramId == cfgMaxJointError.paramId) {
+        physics->max_joint_error = _property.dValue;
+        return;
+      }
+
+      if(_property.paramId == cfgMaxManifoldContacts.paramId) {
+        physics->max_manifold_contacts = _property.iValue;
+        return;
+      }
+
+      if(_property.paramId == cfgContactCacheDistance.paramId) {
+        physics->contact_cache_distance = _property.dValue;
+        return;
+      }
+
+      if(_property.paramId == cfgContactCacheAngle.paramId) {
+        physics->contact_cache_angle = _property.dValue;
+        return;
+      }
+
+      if(_property.paramId == cfgAutoDisable.paramId) {
+        physics->auto_disable = _property.bValue;
+        return;
+      }
+
+      if(_property.paramId == cfgAutoDisableLinear.paramId) {
+        physics->auto_disable_linear = _property.dValue;
+        return;
+      }
+
+      if(_property.paramId == cfgAutoDisableAngular.paramId) {
+        physics->auto_disable_angular = _property.dValue;
+        return;
+      }
+
+      if(_property.paramId == cfgAutoDisableSteps.paramId) {
+        physics->auto_disable_steps = _property.iValue;
+        return;
+      }
+
+      if(_property.paramId == cfgAutoDisableTime.paramId) {
+        physics->auto_disable_time = _property.dValue;
+        return;
+      }
+
+      if(_property.paramId == cfgSolverThreads.paramId) {
+        cfgSolverThreads.iValue = _property.iValue;
+        updateSolverThreads();
+        return;
+      }
+
+      // the collision spaces are rebuilt by the next step()
+      if(_property.paramId == cfgBroadphase.paramId) {
+        physics->broadphase = _property.sValue;
+        broadphaseChanged = true;
+        return;
+      }
+
+      if(_property.paramId == cfgHashMinLevel.paramId) {
+        physics->hash_min_level = _property.iValue;
+        broadphaseChanged = true;
+        return;
+      }
+
+      if(_property.paramId == cfgHashMaxLevel.paramId) {
+        physics->hash_max_level = _property.iValue;
+        broadphaseChanged = true;
+        return;
+      }
+
+      if(_property.paramId == cfgQuadtreeCX.paramId) {
+        physics->quadtree_center.x() = _property.dValue;
+        broadphaseChanged = true;
+        return;
+      }
+
+      if(_property.paramId == cfgQuadtreeCY.paramId) {
+        physics->quadtree_center.y() = _property.dValue;
+        broadphaseChanged = true;
+        return;
+      }
+
+      if(_property.paramId == cfgQuadtreeCZ.paramId) {
+        physics->quadtree_center.z() = _property.dValue;
+        broadphaseChanged = true;
+        return;
+      }
+
+      if(_property.paramId == cfgQuadtreeEX.paramId) {
+        physics->quadtree_extents.x() = _property.dValue;
+        broadphaseChanged = true;
+        return;
+      }
+
+      if(_property.paramId == cfgQuadtreeEY.paramId) {
+        physics->quadtree_extents.y() = _property.dValue;
+        broadphaseChanged = true;
+        return;
+      }
+
+      if(_property.paramId == cfgQuadtreeEZ.paramId) {
+        physics->quadtree_extents.z() = _property.dValue;
+        broadphaseChanged = true;
+        return;
+      }
+
+      if(_property.paramId == cfgQuadtreeDepth.paramId) {
+        physics->quadtree_depth = _property.iValue;
+        broadphaseChanged = true;
+        return;
+      }
+
+      if(_property.paramId == cfgMeshFit.paramId) {
+        setMeshFitMode(_property.sValue);
+        return;
+      }
+
+      if(_property.paramId == cfgMeshFitTolerance.paramId) {
+        meshFitter->setTolerance(_property.dValue);
+        return;
+      }
+
+      if(_property.paramId == cfgMeshFitCache.paramId) {
+        meshFitter->setCacheDir(_property.sValue);
+        return;
+      }
+
+      if(_property.paramId == cfgTerrainTileSize.paramId) {
+        physics->terrain_tile_size = _property.iValue;
+        return;
+      }
+
+      if(_property.paramId == cfgTerrainTileMargin.paramId) {
+        physics->terrain_tile_margin = _property.dValue;
+        return;
+      }
+
+      if(_property.paramId == cfgTerrainTileKeepSteps.paramId) {
+        physics->terrain_tile_keep_steps = _property.iValue;
+        return;
+      }
+
+      if(_property.paramId == cfgTerrainCache.paramId) {
+        if(control->nodes) {
+          static_cast<NodeManager*>(control->nodes)->setHeightCacheDir(_property.sValue);
+        }
+        return;
+      }
+
       if(_property.paramId == cfgVisRep.paramId) {
         control->nodes->setVisualRep(0, _property.iValue);
         return;
       }
 
+      if(_property.paramId == cfgUpdateThreads.paramId) {
+        // applied by the next step()
+        updateThreads = _property.iValue;
+        updateThreadsChanged = true;
+        return;
+      }
+
+      if(_property.paramId == cfgProfileInterval.paramId) {
+        profileInterval = _property.iValue;
+        profileCount = 0;
+        return;
+      }
+
+      if(_property.paramId == cfgTrace.paramId) {
+        setTracing(_property.bValue);
+        return;
+      }
+
+      if(_property.paramId == cfgTraceFile.paramId) {
+        traceFile = _property.sValue;
+        return;
+      }
+
+      if(_property.paramId == cfgDeterministic.paramId) {
+        deterministic = _property.bValue;
+        updateSolverThreads();
+        return;
+      }
+
+      // the recorder is started or stopped by the next step()
+      if(_property.paramId == cfgRecord.paramId) {
+        recording = _property.bValue;
+        recorderChanged = true;
+        return;
+      }
+
+      if(_property.paramId == cfgRecordFile.paramId) {
+        recordFile = _property.sValue;
+        return;
+      }
+
+      if(_property.paramId == cfgRecordData.paramId) {
+        recordDataItems = _property.sValue;
+        return;
+      }
+
+      if(_property.paramId == cfgReplay.paramId) {
+        replaying = _property.bValue;
+        recorderChanged = true;
+        return;
+      }
+
+      if(_property.paramId == cfgReplayFile.paramId) {
+        replayFile = _property.sValue;
+        return;
+      }
+
     }
 
     void Simulator::initCfgParams(void) {
@@ -1279,10 +2132,44 @@ namespace mars {
       calc_ms = cfgCalcMs.dValue;
       cfgFaststep = control->cfg->getOrCreateProperty("Simulator", "faststep",
                                                       false, this);
+      // solver of the faststep; a max error > 0 adapts the iterations
+      cfgQuickStepIterations = control->cfg->getOrCreateProperty("Simulator",
+                                                                 "quickstep iterations",
+                                                                 (int)20, this);
+      cfgQuickStepW = control->cfg->getOrCreateProperty("Simulator", "quickstep w",
+                                                        1.3, this);
+      cfgQuickStepMaxError = control->cfg->getOrCreateProperty("Simulator",
+                                                               "quickstep max error",
+                                                               0.0, this);
+      cfgQuickStepMinIterations = control->cfg->getOrCreateProperty("Simulator",
+                                                                    "quickstep min iterations",
+                                                                    (int)5, this);
+      cfgQuickStepMaxIterations = control->cfg->getOrCreateProperty("Simulator",
+                                                                    "quickstep max iterations",
+                                                                    (int)100, this);
       cfgRealtime = control->cfg->getOrCreateProperty("Simulator", "realtime calc",
                                                       false, this);
       my_real_time = cfgRealtime.bValue;
 
+      // handling of missed deadlines in realtime mode: "skip", "burst"
+      // (at most "realtime max burst" steps) or "slow down"
+      cfgRealtimePolicy = control->cfg->getOrCreateProperty("Simulator", "realtime policy",
+                                                            "skip", this);
+      setRealtimePolicy(cfgRealtimePolicy.sValue);
+      cfgRealtimeMaxBurst = control->cfg->getOrCreateProperty("Simulator", "realtime max burst",
+                                                              (int)10, this);
+      realtimeScheduler->setMaxBurst(cfgRealtimeMaxBurst.iValue);
+
+      // SCHED_FIFO priority (1-99, 0: normal scheduling) and cpu (-1: all)
+      // of the physics thread
+      cfgRealtimePriority = control->cfg->getOrCreateProperty("Simulator", "realtime priority",
+                                                              (int)0, this);
+      realtimePriority = cfgRealtimePriority.iValue;
+      cfgRealtimeCpu = control->cfg->getOrCreateProperty("Simulator", "realtime cpu",
+                                                         (int)-1, this);
+      realtimeCpu = cfgRealtimeCpu.iValue;
+      threadSettingsChanged = (realtimePriority != 0 || realtimeCpu >= 0);
+
       cfgDebugTime = control->cfg->getOrCreateProperty("Simulator", "debug time",
                                                        false, this);
 
@@ -1310,6 +2197,90 @@ namespace mars {
       cfgWorldCfm = control->cfg->getOrCreateProperty("Simulator", "world cfm",
                                                       1e-10, this);
 
+      // splits a step of calc_ms into up to "max substeps" substeps if the
+      // contact penetration or the joint error (in meters) is too large
+      cfgAdaptiveStep = control->cfg->getOrCreateProperty("Simulator", "adaptive step",
+                                                          false, this);
+
+      cfgMaxSubsteps = control->cfg->getOrCreateProperty("Simulator", "max substeps",
+                                                         (int)8, this);
+
+      cfgMaxPenetration = control->cfg->getOrCreateProperty("Simulator", "max penetration",
+                                                            0.005, this);
+
+      cfgMaxJointError = control->cfg->getOrCreateProperty("Simulator", "max joint error",
+                                                           0.01, this);
+
+      // contacts per geom pair after the reduction (0 keeps all) and the
+      // pose changes up to which the contacts of a pair are reused
+      // (0 generates them every step)
+      cfgMaxManifoldContacts = control->cfg->getOrCreateProperty("Simulator",
+                                                                 "max manifold contacts",
+                                                                 (int)0, this);
+      cfgContactCacheDistance = control->cfg->getOrCreateProperty("Simulator",
+                                                                  "contact cache distance",
+                                                                  0.0, this);
+      cfgContactCacheAngle = control->cfg->getOrCreateProperty("Simulator",
+                                                               "contact cache angle",
+                                                               0.0, this);
+
+      // bodies at rest are disabled by ODE until they are touched by an
+      // enabled body; the thresholds can be overridden per node
+      cfgAutoDisable = control->cfg->getOrCreateProperty("Simulator", "auto disable",
+                                                         false, this);
+      cfgAutoDisableLinear = control->cfg->getOrCreateProperty("Simulator",
+                                                               "auto disable linear",
+                                                               0.01, this);
+      cfgAutoDisableAngular = control->cfg->getOrCreateProperty("Simulator",
+                                                                "auto disable angular",
+                                                                0.01, this);
+      cfgAutoDisableSteps = control->cfg->getOrCreateProperty("Simulator",
+                                                              "auto disable steps",
+                                                              (int)10, this);
+      cfgAutoDisableTime = control->cfg->getOrCreateProperty("Simulator",
+                                                             "auto disable time",
+                                                             0.0, this);
+
+      // threads that solve the independent islands of the world (e.g.
+      // several robots) in parallel; 1 solves in the simulation thread
+      cfgSolverThreads = control->cfg->getOrCreateProperty("Simulator", "solver threads",
+                                                           (int)1, this);
+
+      // collision broadphase: "hash", "quadtree", "sap", "simple" or "auto"
+      // (chosen from the bounding boxes of the geoms after a scene load);
+      // static geoms are kept in a separate space in all modes
+      cfgBroadphase = control->cfg->getOrCreateProperty("Simulator", "broadphase",
+                                                        "hash", this);
+
+      // log2 of the smallest and largest hash cell size
+      cfgHashMinLevel = control->cfg->getOrCreateProperty("Simulator", "hash min level",
+                                                          (int)-3, this);
+
+      cfgHashMaxLevel = control->cfg->getOrCreateProperty("Simulator", "hash max level",
+                                                          (int)10, this);
+
+      // center and half sizes of the area covered by the quadtree
+      cfgQuadtreeCX = control->cfg->getOrCreateProperty("Simulator", "quadtree center x",
+                                                        0.0, this);
+
+      cfgQuadtreeCY = control->cfg->getOrCreateProperty("Simulator", "quadtree center y",
+                                                        0.0, this);
+
+      cfgQuadtreeCZ = control->cfg->getOrCreateProperty("Simulator", "quadtree center z",
+                                                        0.0, this);
+
+      cfgQuadtreeEX = control->cfg->getOrCreateProperty("Simulator", "quadtree extent x",
+                                                        100.0, this);
+
+      cfgQuadtreeEY = control->cfg->getOrCreateProperty("Simulator", "quadtree extent y",
+                                                        100.0, this);
+
+      cfgQuadtreeEZ = control->cfg->getOrCreateProperty("Simulator", "quadtree extent z",
+                                                        10.0, this);
+
+      cfgQuadtreeDepth = control->cfg->getOrCreateProperty("Simulator", "quadtree depth",
+                                                           (int)6, this);
+
       cfgVisRep = control->cfg->getOrCreateProperty("Simulator", "visual rep.",
                                                     (int)1, this);
 
@@ -1318,6 +2289,81 @@ namespace mars {
 
       control->cfg->getOrCreateProperty("Simulator", "onPhysicsError",
                                         "abort", this);
+
+      // 0: sequential update, -1: one thread per cpu core
+      cfgUpdateThreads = control->cfg->getOrCreateProperty("Simulator", "update threads",
+                                                           (int)0, this);
+      updateThreads = cfgUpdateThreads.iValue;
+      updateThreadsChanged = (updateThreads != 0);
+
+      // number of steps between two publications of the profiling
+      // statistics (mars_sim/profile/*), 0 (the default) disables the
+      // profiling
+      cfgProfileInterval = control->cfg->getOrCreateProperty("Simulator", "profile interval",
+                                                             (int)profileInterval, this);
+      profileInterval = cfgProfileInterval.iValue;
+
+      // records a Chrome trace (chrome://tracing) of the simulation,
+      // DataBroker and draw threads; the file is written when the
+      // recording is switched off or the simulation is closed
+      cfgTraceFile = control->cfg->getOrCreateProperty("Simulator", "trace file",
+                                                       "mars_trace.json", this);
+      traceFile = cfgTraceFile.sValue;
+      cfgTrace = control->cfg->getOrCreateProperty("Simulator", "trace",
+                                                   false, this);
+      setTracing(cfgTrace.bValue);
+
+      // sequential update without wall clock coupling
+      cfgDeterministic = control->cfg->getOrCreateProperty("Simulator", "deterministic",
+                                                           false, this);
+      deterministic = cfgDeterministic.bValue;
+
+      // records the inputs of every step to "record file" or replays
+      // them from "replay file" (see StepRecorder); "record data" lists
+      // the DataBroker packages to record as "group/name;group/name"
+      cfgRecordFile = control->cfg->getOrCreateProperty("Simulator", "record file",
+                                                        "mars_record.bin", this);
+      recordFile = cfgRecordFile.sValue;
+      cfgRecordData = control->cfg->getOrCreateProperty("Simulator", "record data",
+                                                        "", this);
+      recordDataItems = cfgRecordData.sValue;
+      cfgReplayFile = control->cfg->getOrCreateProperty("Simulator", "replay file",
+                                                        "mars_record.bin", this);
+      replayFile = cfgReplayFile.sValue;
+
+      cfgRecord = control->cfg->getOrCreateProperty("Simulator", "record",
+                                                    false, this);
+      recording = cfgRecord.bValue;
+      cfgReplay = control->cfg->getOrCreateProperty("Simulator", "replay",
+                                                    false, this);
+      replaying = cfgReplay.bValue;
+      recorderChanged = recording || replaying;
+
+      // replaces the collision meshes of new mesh nodes: "off",
+      // "primitive", "hull" or "auto" (see MeshFitter); the results are
+      // cached per mesh in "mesh fitting cache" ("" disables the cache)
+      cfgMeshFit = control->cfg->getOrCreateProperty("Simulator", "mesh fitting",
+                                                     "off", this);
+      setMeshFitMode(cfgMeshFit.sValue);
+      cfgMeshFitTolerance = control->cfg->getOrCreateProperty("Simulator", "mesh fitting tolerance",
+                                                              0.2, this);
+      meshFitter->setTolerance(cfgMeshFitTolerance.dValue);
+      cfgMeshFitCache = control->cfg->getOrCreateProperty("Simulator", "mesh fitting cache",
+                                                          "mesh_fit_cache", this);
+      meshFitter->setCacheDir(cfgMeshFitCache.sValue);
+
+      // terrains are split into tiles of "terrain tile size" cells that
+      // only collide near bodies (0 disables the tiles); the decoded
+      // heightmaps are mapped from height files in "terrain cache" (""
+      // decodes them on every load)
+      cfgTerrainTileSize = control->cfg->getOrCreateProperty("Simulator", "terrain tile size",
+                                                             (int)0, this);
+      cfgTerrainTileMargin = control->cfg->getOrCreateProperty("Simulator", "terrain tile margin",
+                                                               5.0, this);
+      cfgTerrainTileKeepSteps = control->cfg->getOrCreateProperty("Simulator", "terrain tile keep steps",
+                                                                  (int)100, this);
+      cfgTerrainCache = control->cfg->getOrCreateProperty("Simulator", "terrain cache",
+                                                          "", this);
       show_time = cfgDebugTime.bValue;
 
     }
@@ -35,6 +35,7 @@
 #include <mars/data_broker/DataPackage.h>
 #include <mars/data_broker/ReceiverInterface.h>
 #include <mars/cfg_manager/CFGManagerInterface.h>
+#include <mars/utils/BinaryBuffer.h>
 #include <mars/utils/Thread.h>
 #include <mars/utils/Mutex.h>
 #include <mars/utils/WaitCondition.h>
@@ -46,11 +47,26 @@
 #include <mars/interfaces/graphics/GraphicsUpdateInterface.h>
 
 #include <iostream>
+#include <map>
+#include <set>
+
+#ifdef __linux__
+#include <time.h>
+#endif
 
 
 namespace mars {
   namespace sim {
 
+    class GeometryLoader;
+    class MeshFitter;
+    class ThreadPool;
+    class ThreadPoolTask;
+    class TaskGraph;
+    class StepProfiler;
+    class StepRecorder;
+    class RealtimeScheduler;
+
     /**
      *\brief The Simulator class implements the main functions of the MARS simulation.
      *
@@ -80,6 +96,7 @@ namespace mars {
 
       Simulator(lib_manager::LibManager *theManager); ///< Constructor of the \c class Simulator.
       virtual ~Simulator();
+      /// the first created simulator of the process
       static Simulator *activeSimulator;
 
 
@@ -126,6 +143,11 @@ namespace mars {
       }
 
       virtual void resetSim(void);
+      virtual unsigned long saveState(void);
+      virtual bool restoreState(unsigned long handle);
+      virtual void releaseState(unsigned long handle);
+      virtual void writeState(utils::BinaryBuffer *state);
+      virtual bool readState(utils::BinaryBuffer *state);
       virtual bool isSimRunning() const;
       bool startStopTrigger(); ///< Starts and pauses the simulation.
       virtual void singleStep(void);
@@ -169,6 +191,7 @@ namespace mars {
       virtual void postGraphicsUpdate(void);
       virtual void finishedDraw(void);
       void allowDraw(void); ///< Allows the osgWidget to draw a frame.
+      virtual bool waitForAllowDraw(unsigned long timeoutMilliseconds);
 
       virtual bool getAllowDraw(void) {
         return allow_draw;
@@ -254,12 +277,14 @@ namespace mars {
       utils::Mutex coreMutex;
       utils::Mutex physicsMutex;
       utils::Mutex physicsCountMutex;
+      utils::WaitCondition physicsCountWc; ///< Signals unlocks of the physics thread.
+      utils::Mutex drawMutex;
+      utils::WaitCondition drawWc; ///< Signals the handoff between physics and drawing.
       utils::Mutex stepping_mutex; ///< Used for preventing active waiting for a single step or start event.
       utils::WaitCondition stepping_wc; ///< Used for preventing active waiting for a single step or start event.
       utils::Mutex getTimeMutex;
       int physics_mutex_count;
-      double avg_log_time;
-      int count;
+      unsigned long physics_unlock_count;
       interfaces::sReal calc_time;
       
       // physics
@@ -270,7 +295,84 @@ namespace mars {
       utils::Vector gravity;
       unsigned long dbPhysicsUpdateId;
       unsigned long dbSimTimeId;
+      unsigned long dbSubstepsId;
+      unsigned long dbQuickStepId;
+      unsigned long dbContactsId;
+      unsigned long dbSleepId;
+      unsigned long dbIslandsId;
       unsigned long realStartTime;
+      GeometryLoader *geometryLoader;
+      MeshFitter *meshFitter;
+      void setRealtimePolicy(const std::string &name);
+      void setMeshFitMode(const std::string &name);
+      void waitForPhysicsLockers(void);
+      void waitForFinishedDraw(void);
+      RealtimeScheduler *realtimeScheduler;
+      bool realtimeNeedsInit;
+      bool threadSettingsChanged;
+      int realtimePriority, realtimeCpu;
+
+      // parallel update of nodes, joints, motors and controllers
+      void setupUpdatePipeline(void);
+      void updateNodes(void);
+      void updateRays(void);
+      void updateJoints(void);
+      void updateMotors(void);
+      void updateControllers(void);
+      ThreadPool *updatePool;
+      TaskGraph *updateGraph;
+      std::vector<ThreadPoolTask*> updateTasks;
+      int updateThreads;
+      bool updateThreadsChanged;
+
+      // broadphase of the collision detection
+      void setBroadphase(void);
+      bool broadphaseChanged;
+
+      // profiling of the simulation step
+      StepProfiler *activeProfiler(void) const;
+      int getPluginStage(std::map<interfaces::PluginInterface*, int> *stages,
+                         const interfaces::pluginStruct &plugin,
+                         const std::string &prefix);
+      StepProfiler *profiler;
+      std::map<interfaces::PluginInterface*, int> pluginStages;
+      std::map<interfaces::PluginInterface*, int> guiPluginStages;
+      int profileInterval; ///< Steps between two publications, 0 disables profiling.
+      int profileCount;
+      int stageStep, stageCollision, stageSolver, stageNodes;
+      int stageJoints, stageMotors, stageControllers, stageSimTimer;
+      int stageRays;
+
+      // snapshots of the simulation state
+      std::map<unsigned long, utils::BinaryBuffer*> savedStates;
+      unsigned long nextStateId;
+      utils::Mutex stateMutex;
+
+      // trace recording (see utils::TraceRecorder)
+      void setTracing(bool enable);
+      bool tracing;
+      std::string traceFile;
+
+      // record and replay of the inputs (see StepRecorder)
+      void collectState(utils::BinaryBuffer *state);
+      bool parseState(utils::BinaryBuffer *state, bool apply);
+      void updateRecorder(void);
+      std::string getInstanceFile(const std::string &file) const;
+      bool isDeterministic(void) const;
+      void updateSolverThreads(void);
+      StepRecorder *recorder;
+      utils::BinaryBuffer hashState;
+      bool deterministic, recording, replaying;
+      bool recorderActive, recorderChanged;
+      std::string recordFile, replayFile, recordDataItems;
+
+      // instances
+      static utils::Mutex instanceMutex;
+      static int nextInstanceId;
+      // the DataBrokers of all instances; the log messages are sent to one
+      // of them (see ControlCenter::setLogDataBroker)
+      static std::set<data_broker::DataBrokerInterface*> dataBrokers;
+      int instanceId;
 
       // plugins
       std::vector<interfaces::pluginStruct> allPlugins;
@@ -288,6 +390,10 @@ namespace mars {
       void initCfgParams(void);
       std::string config_dir;
       cfg_manager::cfgPropertyStruct cfgCalcMs, cfgFaststep;
+      cfg_manager::cfgPropertyStruct cfgQuickStepIterations, cfgQuickStepW;
+      cfg_manager::cfgPropertyStruct cfgQuickStepMaxError;
+      cfg_manager::cfgPropertyStruct cfgQuickStepMinIterations;
+      cfg_manager::cfgPropertyStruct cfgQuickStepMaxIterations;
       cfg_manager::cfgPropertyStruct cfgRealtime, cfgDebugTime;
       cfg_manager::cfgPropertyStruct cfgSyncGui, cfgDrawContact;
       cfg_manager::cfgPropertyStruct cfgGX, cfgGY, cfgGZ;
@@ -296,10 +402,38 @@ namespace mars {
       cfg_manager::cfgPropertyStruct cfgSyncTime;
       cfg_manager::cfgPropertyStruct configPath;
       cfg_manager::cfgPropertyStruct cfgUseNow;
+      cfg_manager::cfgPropertyStruct cfgUpdateThreads;
+      cfg_manager::cfgPropertyStruct cfgProfileInterval;
+      cfg_manager::cfgPropertyStruct cfgTrace, cfgTraceFile;
+      cfg_manager::cfgPropertyStruct cfgDeterministic;
+      cfg_manager::cfgPropertyStruct cfgAdaptiveStep, cfgMaxSubsteps;
+      cfg_manager::cfgPropertyStruct cfgMaxPenetration, cfgMaxJointError;
+      cfg_manager::cfgPropertyStruct cfgMaxManifoldContacts;
+      cfg_manager::cfgPropertyStruct cfgContactCacheDistance, cfgContactCacheAngle;
+      cfg_manager::cfgPropertyStruct cfgAutoDisable, cfgAutoDisableLinear;
+      cfg_manager::cfgPropertyStruct cfgAutoDisableAngular, cfgAutoDisableSteps;
+      cfg_manager::cfgPropertyStruct cfgAutoDisableTime, cfgSolverThreads;
+      cfg_manager::cfgPropertyStruct cfgBroadphase, cfgHashMinLevel;
+      cfg_manager::cfgPropertyStruct cfgHashMaxLevel, cfgQuadtreeDepth;
+      cfg_manager::cfgPropertyStruct cfgQuadtreeCX, cfgQuadtreeCY, cfgQuadtreeCZ;
+      cfg_manager::cfgPropertyStruct cfgQuadtreeEX, cfgQuadtreeEY, cfgQuadtreeEZ;
+      cfg_manager::cfgPropertyStruct cfgRealtimePolicy, cfgRealtimeMaxBurst;
+      cfg_manager::cfgPropertyStruct cfgRealtimePriority, cfgRealtimeCpu;
+      cfg_manager::cfgPropertyStruct cfgRecord, cfgRecordFile, cfgRecordData;
+      cfg_manager::cfgPropertyStruct cfgReplay, cfgReplayFile;
+      cfg_manager::cfgPropertyStruct cfgMeshFit, cfgMeshFitTolerance;
+      cfg_manager::cfgPropertyStruct cfgMeshFitCache;
+      cfg_manager::cfgPropertyStruct cfgTerrainTileSize, cfgTerrainTileMargin;
+      cfg_manager::cfgPropertyStruct cfgTerrainTileKeepSteps, cfgTerrainCache;
       
       // data
       data_broker::DataPackage dbPhysicsUpdatePackage;
       data_broker::DataPackage dbSimTimePackage;
+      data_broker::DataPackage dbSubstepsPackage;
+      data_broker::DataPackage dbQuickStepPackage;
+      data_broker::DataPackage dbContactsPackage;
+      data_broker::DataPackage dbSleepPackage;
+      data_broker::DataPackage dbIslandsPackage;
       
       // IceServer comServer;
 
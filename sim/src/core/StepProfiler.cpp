@@ -0,0 +1,164 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+ /**
+ * \file StepProfiler.cpp
+ * \author agent
+ * \brief "StepProfiler" collects the durations of the stages of a
+ * simulation step and publishes statistics via the DataBroker.
+ *
+ */
+
+#include "StepProfiler.h"
+
+#include <mars/utils/MutexLocker.h>
+#include <mars/data_broker/DataBrokerInterface.h>
+
+#include <algorithm>
+#include <cstdio>
+
+namespace mars {
+  namespace sim {
+
+    using namespace std;
+    using namespace utils;
+
+    StepProfiler::StepProfiler(size_t windowSize) : windowSize(windowSize) {
+      if(this->windowSize < 1) this->windowSize = 1;
+      sorted.reserve(this->windowSize);
+    }
+
+    StepProfiler::~StepProfiler() {
+      for(size_t i=0; i<stages.size(); ++i) {
+        delete stages[i];
+      }
+    }
+
+    int StepProfiler::addStage(const string &name) {
+      MutexLocker locker(&mutex);
+      for(size_t i=0; i<stages.size(); ++i) {
+        if(stages[i]->name == name) return (int)i;
+      }
+      Stage *stage = new Stage();
+      stage->name = name;
+      stage->samples.resize(windowSize, 0.0);
+      stage->next = 0;
+      stage->count = 0;
+      stage->publishedCount = 0;
+      stage->dbId = 0;
+      stage->dbPackage.add("count", (long)0);
+      stage->dbPackage.add("last", 0.0);
+      stage->dbPackage.add("min", 0.0);
+      stage->dbPackage.add("mean", 0.0);
+      stage->dbPackage.add("p99", 0.0);
+      stage->dbPackage.add("max", 0.0);
+      stages.push_back(stage);
+      return (int)stages.size()-1;
+    }
+
+    void StepProfiler::addSample(int stage, double microseconds) {
+      MutexLocker locker(&mutex);
+      Stage *s = stages[stage];
+      s->samples[s->next] = microseconds;
+      s->next = (s->next+1) % windowSize;
+      ++s->count;
+    }
+
+    void StepProfiler::computeStatistics(const Stage &stage,
+                                         Statistics *statistics) const {
+      size_t n = stage.count < windowSize ? stage.count : windowSize;
+      statistics->count = stage.count;
+      statistics->last = statistics->min = statistics->mean = 0.0;
+      statistics->p99 = statistics->max = 0.0;
+      if(n == 0) return;
+
+      statistics->last = stage.samples[(stage.next+windowSize-1) % windowSize];
+      // the window is not in order of time, which does not matter here
+      sorted.assign(stage.samples.begin(), stage.samples.begin()+n);
+      std::sort(sorted.begin(), sorted.end());
+      double sum = 0.0;
+      for(size_t i=0; i<n; ++i) {
+        sum += sorted[i];
+      }
+      statistics->min = sorted.front();
+      statistics->max = sorted.back();
+      statistics->mean = sum / n;
+      statistics->p99 = sorted[(size_t)(0.99*(n-1)+0.5)];
+    }
+
+    void StepProfiler::getStatistics(int stage,
+                                     Statistics *statistics) const {
+      MutexLocker locker(&mutex);
+      computeStatistics(*stages[stage], statistics);
+    }
+
+    int StepProfiler::getNumStages(void) const {
+      MutexLocker locker(&mutex);
+      return (int)stages.size();
+    }
+
+    const string& StepProfiler::getStageName(int stage) const {
+      MutexLocker locker(&mutex);
+      return stages[stage]->name;
+    }
+
+    void StepProfiler::publish(data_broker::DataBrokerInterface *dataBroker) {
+      Statistics statistics;
+      if(!dataBroker) return;
+
+      MutexLocker locker(&mutex);
+      for(size_t i=0; i<stages.size(); ++i) {
+        Stage *stage = stages[i];
+        if(stage->count == stage->publishedCount) continue;
+        stage->publishedCount = stage->count;
+
+        computeStatistics(*stage, &statistics);
+        stage->dbPackage.set(0, (long)statistics.count);
+        stage->dbPackage.set(1, statistics.last);
+        stage->dbPackage.set(2, statistics.min);
+        stage->dbPackage.set(3, statistics.mean);
+        stage->dbPackage.set(4, statistics.p99);
+        stage->dbPackage.set(5, statistics.max);
+        if(stage->dbId) {
+          dataBroker->pushData(stage->dbId, stage->dbPackage);
+        }
+        else {
+          stage->dbId = dataBroker->pushData("mars_sim",
+                                             "profile/" + stage->name,
+                                             stage->dbPackage, NULL,
+                                             data_broker::DATA_PACKAGE_READ_FLAG);
+        }
+      }
+    }
+
+    void StepProfiler::print(void) const {
+      Statistics statistics;
+      MutexLocker locker(&mutex);
+      for(size_t i=0; i<stages.size(); ++i) {
+        computeStatistics(*stages[i], &statistics);
+        fprintf(stderr, "debug_time: %-30s mean: %9.1f min: %9.1f "
+                "p99: %9.1f max: %9.1f us\n", stages[i]->name.c_str(),
+                statistics.mean, statistics.min, statistics.p99,
+                statistics.max);
+      }
+    }
+
+  } // end of namespace sim
+} // end of namespace mars
@@ -0,0 +1,144 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+ /**
+ * \file StepProfiler.h
+ * \author agent
+ * \brief "StepProfiler" collects the durations of the stages of a
+ * simulation step and publishes statistics via the DataBroker.
+ *
+ */
+
+#ifndef STEP_PROFILER_H
+#define STEP_PROFILER_H
+
+#ifdef _PRINT_HEADER_
+  #warning "StepProfiler.h"
+#endif
+
+#include <mars/utils/Mutex.h>
+#include <mars/utils/misc.h>
+#include <mars/data_broker/DataPackage.h>
+
+#include <string>
+#include <vector>
+
+namespace mars {
+
+  namespace data_broker {
+    class DataBrokerInterface;
+  }
+
+  namespace sim {
+
+    /**
+     * \brief The StepProfiler keeps the last samples of every stage in a
+     * ring buffer and computes min, mean, p99 and max over this window.
+     *
+     * The statistics of a stage "name" are published as DataBroker
+     * package "mars_sim"/"profile/name" with the items count, last,
+     * min, mean, p99 and max. All durations are in microseconds.
+     * Adding a sample is cheap; the statistics are only computed by
+     * publish().
+     */
+    class StepProfiler {
+    public:
+      struct Statistics {
+        unsigned long count;
+        double last, min, mean, p99, max;
+      };
+
+      /**
+       * \param windowSize The number of samples per stage the statistics
+       * are computed from.
+       */
+      explicit StepProfiler(size_t windowSize = 256);
+      ~StepProfiler();
+
+      /**
+       * \returns The index of the stage; a stage that already exists is
+       * not added again.
+       */
+      int addStage(const std::string &name);
+
+      void addSample(int stage, double microseconds);
+
+      void getStatistics(int stage, Statistics *statistics) const;
+      int getNumStages(void) const;
+      const std::string& getStageName(int stage) const;
+
+      /**
+       * \brief Pushes the statistics of all stages with new samples.
+       */
+      void publish(data_broker::DataBrokerInterface *dataBroker);
+
+      /**
+       * \brief Prints the statistics of all stages to stderr.
+       */
+      void print(void) const;
+
+    private:
+      struct Stage {
+        std::string name;
+        std::vector<double> samples;
+        size_t next;
+        unsigned long count;
+        unsigned long publishedCount;
+        unsigned long dbId;
+        data_broker::DataPackage dbPackage;
+      };
+
+      void computeStatistics(const Stage &stage,
+                             Statistics *statistics) const;
+
+      size_t windowSize;
+      std::vector<Stage*> stages;
+      mutable std::vector<double> sorted;
+      mutable utils::Mutex mutex;
+    };
+
+    /**
+     * \brief Measures the lifetime of the object and adds it as sample to
+     * a stage of the profiler. Does nothing if the profiler is NULL.
+     */
+    class ScopedStepTimer {
+    public:
+      ScopedStepTimer(StepProfiler *profiler, int stage)
+        : profiler(profiler), stage(stage) {
+        if(profiler) startTime = utils::getTimeMicroseconds();
+      }
+
+      ~ScopedStepTimer() {
+        if(profiler) {
+          profiler->addSample(stage,
+                              utils::getTimeDiffMicroseconds(startTime));
+        }
+      }
+
+    private:
+      StepProfiler *profiler;
+      int stage;
+      long long startTime;
+    };
+
+  } // end of namespace sim
+} // end of namespace mars
+
+#endif  // STEP_PROFILER_H
@@ -0,0 +1,575 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+ /**
+ * \file StepRecorder.cpp
+ * \author agent
+ * \brief "StepRecorder" logs the external inputs of every simulation step
+ * to a file and feeds them back to replay a simulation run.
+ *
+ */
+
+#include "StepRecorder.h"
+
+#include <mars/interfaces/sim/ControlCenter.h>
+#include <mars/interfaces/sim/MotorManagerInterface.h>
+#include <mars/interfaces/sim/NodeManagerInterface.h>
+#include <mars/interfaces/Logging.hpp>
+#include <mars/utils/MutexLocker.h>
+#include <mars/cfg_manager/CFGManagerInterface.h>
+#include <mars/data_broker/DataBrokerInterface.h>
+
+#include <cstring>
+
+namespace mars {
+  namespace sim {
+
+    using namespace std;
+    using namespace utils;
+    using namespace interfaces;
+
+    static const char recordMagic[8] = {'M', 'A', 'R', 'S', 'R', 'E', 'C', '3'};
+
+    static void writeString(BinaryBuffer *buffer, const string &s) {
+      buffer->write((unsigned long)s.size());
+      buffer->write(s.data(), s.size());
+    }
+
+    static bool readString(BinaryBuffer *buffer, string *s) {
+      unsigned long size;
+      if(!buffer->read(&size)) return false;
+      if(size > buffer->size()) return false;
+      s->resize(size);
+      return size == 0 || buffer->read(&(*s)[0], size);
+    }
+
+    static bool isRecordedType(data_broker::DataType type) {
+      switch(type) {
+      case data_broker::INT_TYPE:
+      case data_broker::LONG_TYPE:
+      case data_broker::FLOAT_TYPE:
+      case data_broker::DOUBLE_TYPE:
+      case data_broker::BOOL_TYPE:
+      case data_broker::STRING_TYPE:
+        return true;
+      default:
+        return false;
+      }
+    }
+
+    StepRecorder::StepRecorder(ControlCenter *control)
+      : control(control), mutex(MUTEX_TYPE_RECURSIVE), mode(IDLE),
+        applying(false), inStep(false), step(0), firstMismatch(-1),
+        file(NULL), nextRecord(0) {
+    }
+
+    StepRecorder::~StepRecorder() {
+      stop();
+    }
+
+    bool StepRecorder::startRecording(const string &filename,
+                                      unsigned long seed) {
+      stop();
+      MutexLocker locker(&mutex);
+      file = fopen(filename.c_str(), "wb");
+      if(!file) {
+        LOG_ERROR("StepRecorder: could not open \"%s\"", filename.c_str());
+        return false;
+      }
+      fwrite(recordMagic, 1, sizeof(recordMagic), file);
+      fwrite(&seed, sizeof(seed), 1, file);
+      mode = RECORDING;
+      step = 0;
+      warnedDataItems.clear();
+      inStep = false;
+      registerToCFG();
+      if(control->dataBroker) {
+        for(size_t i=0; i<dataItems.size(); ++i) {
+          control->dataBroker->registerSyncReceiver(this, dataItems[i].first,
+                                                    dataItems[i].second);
+        }
+      }
+      LOG_INFO("StepRecorder: recording to \"%s\"", filename.c_str());
+      return true;
+    }
+
+    bool StepRecorder::startReplay(const string &filename,
+                                   unsigned long *seed) {
+      stop();
+      MutexLocker locker(&mutex);
+      FILE *in = fopen(filename.c_str(), "rb");
+      if(!in) {
+        LOG_ERROR("StepRecorder: could not open \"%s\"", filename.c_str());
+        return false;
+      }
+      vector<char> data;
+      char chunk[65536];
+      size_t n;
+      while((n = fread(chunk, 1, sizeof(chunk), in)) > 0) {
+        data.insert(data.end(), chunk, chunk+n);
+      }
+      fclose(in);
+
+      BinaryBuffer buffer;
+      buffer.setData(data);
+      char magic[sizeof(recordMagic)];
+      if(!buffer.read(magic, sizeof(magic)) ||
+         memcmp(magic, recordMagic, sizeof(magic)) != 0 ||
+         !buffer.read(seed)) {
+        LOG_ERROR("StepRecorder: \"%s\" is no record file", filename.c_str());
+        return false;
+      }
+      records.clear();
+      stateHashes.clear();
+      Record r;
+      while(!buffer.atEnd()) {
+        if(!readRecord(&buffer, &r)) {
+          // the file of a crashed run may end with an incomplete record
+          LOG_WARN("StepRecorder: \"%s\" is truncated after %lu steps",
+                   filename.c_str(), (unsigned long)stateHashes.size());
+          break;
+        }
+        // the hashes are written once per step in order of the steps
+        if(r.type == RECORD_STATE_HASH) stateHashes.push_back(r.hash);
+        else records.push_back(r);
+      }
+      mode = REPLAYING;
+      step = 0;
+      inStep = false;
+      firstMismatch = -1;
+      nextRecord = 0;
+      LOG_INFO("StepRecorder: replaying \"%s\" (%lu steps)",
+               filename.c_str(), (unsigned long)stateHashes.size());
+      return true;
+    }
+
+    void StepRecorder::stop() {
+      MutexLocker locker(&mutex);
+      if(mode == RECORDING) {
+        unregisterFromCFG();
+        if(control->dataBroker) {
+          for(size_t i=0; i<dataItems.size(); ++i) {
+            control->dataBroker->unregisterSyncReceiver(this,
+                                                        dataItems[i].first,
+                                                        dataItems[i].second);
+          }
+        }
+        fclose(file);
+        file = NULL;
+        LOG_INFO("StepRecorder: recorded %lld steps", step);
+      }
+      else if(mode == REPLAYING) {
+        records.clear();
+        stateHashes.clear();
+        if(firstMismatch < 0) {
+          LOG_INFO("StepRecorder: replayed %lld steps without mismatch", step);
+        }
+      }
+      mode = IDLE;
+    }
+
+    bool StepRecorder::isRecording() const {
+      MutexLocker locker(&mutex);
+      return mode == RECORDING;
+    }
+
+    bool StepRecorder::isReplaying() const {
+      MutexLocker locker(&mutex);
+      return mode == REPLAYING;
+    }
+
+    void StepRecorder::addDataItem(const string &groupName,
+                                   const string &dataName) {
+      MutexLocker locker(&mutex);
+      dataItems.push_back(make_pair(groupName, dataName));
+    }
+
+    void StepRecorder::clearDataItems() {
+      MutexLocker locker(&mutex);
+      dataItems.clear();
+    }
+
+    long long StepRecorder::getFirstMismatch() const {
+      MutexLocker locker(&mutex);
+      return firstMismatch;
+    }
+
+    /**
+     * Must be called with the locked mutex. Live inputs are dropped
+     * during a replay, only the inputs applied from the log pass.
+     */
+    bool StepRecorder::inputAllowed() {
+      return mode != REPLAYING || applying;
+    }
+
+    /**
+     * Inputs arriving while a step is processed (e.g. from a controller or
+     * a plugin update) are replayed after the update of the step.
+     */
+    void StepRecorder::writeRecord(unsigned char type) {
+      // the record buffer already contains the payload
+      unsigned char header[2*sizeof(unsigned char)+sizeof(long long)];
+      header[0] = type;
+      header[1] = (inStep && type != RECORD_STATE_HASH) ? PHASE_UPDATE
+                                                        : PHASE_BEGIN;
+      memcpy(header+2, &step, sizeof(step));
+      fwrite(header, 1, sizeof(header), file);
+      if(record.size()) {
+        fwrite(&record.getData()[0], 1, record.size(), file);
+      }
+    }
+
+    bool StepRecorder::inputMotorValue(unsigned long id, sReal value) {
+      MutexLocker locker(&mutex);
+      if(mode == RECORDING) {
+        record.clear();
+        record.write(id);
+        record.write((double)value);
+        writeRecord(RECORD_MOTOR_VALUE);
+      }
+      return inputAllowed();
+    }
+
+    bool StepRecorder::inputMotorVelocity(unsigned long id, sReal velocity) {
+      MutexLocker locker(&mutex);
+      if(mode == RECORDING) {
+        record.clear();
+        record.write(id);
+        record.write((double)velocity);
+        writeRecord(RECORD_MOTOR_VELOCITY);
+      }
+      return inputAllowed();
+    }
+
+    bool StepRecorder::inputForce(NodeId id, const Vector &force,
+                                  const Vector *pos) {
+      MutexLocker locker(&mutex);
+      if(mode == RECORDING) {
+        record.clear();
+        record.write((unsigned long)id);
+        record.write(force);
+        if(pos) {
+          record.write(*pos);
+          writeRecord(RECORD_FORCE_AT);
+        }
+        else {
+          writeRecord(RECORD_FORCE);
+        }
+      }
+      return inputAllowed();
+    }
+
+    bool StepRecorder::inputTorque(NodeId id, const Vector &torque) {
+      MutexLocker locker(&mutex);
+      if(mode == RECORDING) {
+        record.clear();
+        record.write((unsigned long)id);
+        record.write(torque);
+        writeRecord(RECORD_TORQUE);
+      }
+      return inputAllowed();
+    }
+
+    bool StepRecorder::readRecord(BinaryBuffer *buffer, Record *r) {
+      unsigned long count;
+      int type;
+      if(!buffer->read(&r->type) || !buffer->read(&r->phase) ||
+         !buffer->read(&r->step)) {
+        return false;
+      }
+      switch(r->type) {
+      case RECORD_MOTOR_VALUE:
+      case RECORD_MOTOR_VELOCITY:
+        return buffer->read(&r->id) && buffer->read(&r->value);
+      case RECORD_FORCE:
+      case RECORD_TORQUE:
+        return buffer->read(&r->id) && buffer->read(&r->v1);
+      case RECORD_FORCE_AT:
+        return (buffer->read(&r->id) && buffer->read(&r->v1) &&
+                buffer->read(&r->v2));
+      case RECORD_STATE_HASH:
+        return buffer->read(&r->hash);
+      case RECORD_CFG:
+        if(!readString(buffer, &r->groupName) ||
+           !readString(buffer, &r->dataName) || !buffer->read(&type)) {
+          return false;
+        }
+        r->property.propertyIndex = 0;
+        r->property.propertyType = (cfg_manager::cfgPropertyType)type;
+        switch(r->property.propertyType) {
+        case cfg_manager::intProperty:
+          return buffer->read(&r->property.iValue);
+        case cfg_manager::doubleProperty:
+          return buffer->read(&r->property.dValue);
+        case cfg_manager::boolProperty:
+          return buffer->read(&r->property.bValue);
+        case cfg_manager::stringProperty:
+          return readString(buffer, &r->property.sValue);
+        default:
+          return false;
+        }
+      case RECORD_DATA:
+        if(!readString(buffer, &r->groupName) ||
+           !readString(buffer, &r->dataName) || !buffer->read(&count)) {
+          return false;
+        }
+        r->package.clear();
+        for(unsigned long i=0; i<count; ++i) {
+          data_broker::DataItem item;
+          string name;
+          if(!readString(buffer, &name) || !buffer->read(&type)) return false;
+          item.setName(name);
+          item.type = (data_broker::DataType)type;
+          bool ok;
+          switch(item.type) {
+          case data_broker::INT_TYPE: ok = buffer->read(&item.i); break;
+          case data_broker::LONG_TYPE: ok = buffer->read(&item.l); break;
+          case data_broker::FLOAT_TYPE: ok = buffer->read(&item.f); break;
+          case data_broker::DOUBLE_TYPE: ok = buffer->read(&item.d); break;
+          case data_broker::BOOL_TYPE: ok = buffer->read(&item.b); break;
+          case data_broker::STRING_TYPE: ok = readString(buffer, &item.s); break;
+          default: ok = false;
+          }
+          if(!ok) return false;
+          r->package.add(item);
+        }
+        return true;
+      default:
+        return false;
+      }
+    }
+
+    void StepRecorder::applyRecord(const Record &r) {
+      switch(r.type) {
+      case RECORD_MOTOR_VALUE:
+        control->motors->setMotorValue(r.id, r.value);
+        break;
+      case RECORD_MOTOR_VELOCITY:
+        control->motors->setMotorValueDesiredVelocity(r.id, r.value);
+        break;
+      case RECORD_FORCE:
+        control->nodes->applyForce(r.id, r.v1);
+        break;
+      case RECORD_FORCE_AT:
+        control->nodes->applyForce(r.id, r.v1, r.v2);
+        break;
+      case RECORD_TORQUE:
+        control->nodes->applyTorque(r.id, r.v1);
+        break;
+      case RECORD_CFG:
+        if(control->cfg) {
+          cfg_manager::cfgPropertyStruct property = r.property;
+          property.paramId = control->cfg->getParamId(r.groupName, r.dataName);
+          if(!property.paramId || !control->cfg->setProperty(property)) {
+            LOG_WARN("StepRecorder: could not set cfg property %s/%s",
+                     r.groupName.c_str(), r.dataName.c_str());
+          }
+        }
+        break;
+      case RECORD_DATA:
+        if(control->dataBroker) {
+          control->dataBroker->pushData(r.groupName, r.dataName, r.package,
+                                        this, data_broker::DATA_PACKAGE_NO_FLAG);
+        }
+        break;
+      }
+    }
+
+    /**
+     * Applies the records up to the given phase of the current step. The
+     * records are stored in the order they were given.
+     */
+    void StepRecorder::applyRecords(unsigned char phase) {
+      applying = true;
+      while(nextRecord < records.size() &&
+            (records[nextRecord].step < step ||
+             (records[nextRecord].step == step &&
+              records[nextRecord].phase <= phase))) {
+        applyRecord(records[nextRecord++]);
+      }
+      applying = false;
+    }
+
+    void StepRecorder::beginStep() {
+      MutexLocker locker(&mutex);
+      if(mode == REPLAYING) {
+        applyRecords(PHASE_BEGIN);
+      }
+      inStep = true;
+    }
+
+    void StepRecorder::afterUpdate() {
+      MutexLocker locker(&mutex);
+      if(mode == REPLAYING) {
+        applyRecords(PHASE_UPDATE);
+      }
+    }
+
+    void StepRecorder::endStep(unsigned long long stateHash) {
+      MutexLocker locker(&mutex);
+      inStep = false;
+      if(mode == RECORDING) {
+        record.clear();
+        record.write(stateHash);
+        writeRecord(RECORD_STATE_HASH);
+        // keep the log of a crashing run
+        fflush(file);
+      }
+      else if(mode == REPLAYING) {
+        if(step < (long long)stateHashes.size()) {
+          if(stateHashes[step] != stateHash && firstMismatch < 0) {
+            firstMismatch = step;
+            LOG_ERROR("StepRecorder: the state of step %lld differs from "
+                      "the recording", step);
+          }
+        }
+        else if(step == (long long)stateHashes.size()) {
+          LOG_INFO("StepRecorder: end of the recording reached after "
+                   "%lld steps", step);
+        }
+      }
+      ++step;
+    }
+
+    unsigned long long StepRecorder::hash(const vector<char> &data) {
+      unsigned long long h = 14695981039346656037ULL;
+      for(size_t i=0; i<data.size(); ++i) {
+        h ^= (unsigned char)data[i];
+        h *= 1099511628211ULL;
+      }
+      return h;
+    }
+
+    /**
+     * The settings of the recorder and the profiling do not affect the
+     * simulation and are not recorded.
+     */
+    bool StepRecorder::recordParam(cfg_manager::cfgParamId id) const {
+      cfg_manager::cfgParamInfo info = control->cfg->getParamInfo(id);
+      if(info.group != "Simulator") return true;
+      const char *excluded[] = {"record", "replay", "trace", "profile",
+                                "debug time"};
+      for(size_t i=0; i<sizeof(excluded)/sizeof(excluded[0]); ++i) {
+        if(info.name.compare(0, strlen(excluded[i]), excluded[i]) == 0) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    void StepRecorder::registerToCFG() {
+      if(!control->cfg) return;
+      vector<cfg_manager::cfgParamInfo> params;
+      control->cfg->getAllParams(&params);
+      control->cfg->registerToCFG(this);
+      for(size_t i=0; i<params.size(); ++i) {
+        cfgParamCreated(params[i].id);
+      }
+    }
+
+    void StepRecorder::unregisterFromCFG() {
+      if(!control->cfg) return;
+      control->cfg->unregisterFromCFG(this);
+      set<cfg_manager::cfgParamId>::iterator it;
+      for(it = cfgParams.begin(); it != cfgParams.end(); ++it) {
+        control->cfg->unregisterFromParam(*it, this);
+      }
+      cfgParams.clear();
+    }
+
+    void StepRecorder::cfgParamCreated(cfg_manager::cfgParamId _id) {
+      MutexLocker locker(&mutex);
+      if(mode != RECORDING || cfgParams.count(_id) || !recordParam(_id)) {
+        return;
+      }
+      if(control->cfg->registerToParam(_id, this)) {
+        cfgParams.insert(_id);
+      }
+    }
+
+    void StepRecorder::cfgUpdateProperty(cfg_manager::cfgPropertyStruct _property) {
+      MutexLocker locker(&mutex);
+      if(mode != RECORDING || !cfgParams.count(_property.paramId)) return;
+      cfg_manager::cfgParamInfo info;
+      info = control->cfg->getParamInfo(_property.paramId);
+      record.clear();
+      writeString(&record, info.group);
+      writeString(&record, info.name);
+      record.write((int)_property.propertyType);
+      switch(_property.propertyType) {
+      case cfg_manager::intProperty:
+        record.write(_property.iValue);
+        break;
+      case cfg_manager::doubleProperty:
+        record.write(_property.dValue);
+        break;
+      case cfg_manager::boolProperty:
+        record.write(_property.bValue);
+        break;
+      case cfg_manager::stringProperty:
+        writeString(&record, _property.sValue);
+        break;
+      default:
+        return;
+      }
+      writeRecord(RECORD_CFG);
+    }
+
+    void StepRecorder::receiveData(const data_broker::DataInfo &info,
+                                   const data_broker::DataPackage &package,
+                                   int callbackParam) {
+      MutexLocker locker(&mutex);
+      if(mode != RECORDING) return;
+      // items of other types can not be read back and are not recorded
+      unsigned long count = 0;
+      for(size_t i=0; i<package.size(); ++i) {
+        if(isRecordedType(package[i].type)) ++count;
+      }
+      if(count < package.size() &&
+         warnedDataItems.insert(info.groupName+"/"+info.dataName).second) {
+        LOG_WARN("StepRecorder: %lu items of %s/%s have an unsupported "
+                 "type and are not recorded",
+                 (unsigned long)package.size()-count,
+                 info.groupName.c_str(), info.dataName.c_str());
+      }
+      record.clear();
+      writeString(&record, info.groupName);
+      writeString(&record, info.dataName);
+      record.write(count);
+      for(size_t i=0; i<package.size(); ++i) {
+        const data_broker::DataItem &item = package[i];
+        if(!isRecordedType(item.type)) continue;
+        writeString(&record, item.getName());
+        record.write((int)item.type);
+        switch(item.type) {
+        case data_broker::INT_TYPE: record.write(item.i); break;
+        case data_broker::LONG_TYPE: record.write(item.l); break;
+        case data_broker::FLOAT_TYPE: record.write(item.f); break;
+        case data_broker::DOUBLE_TYPE: record.write(item.d); break;
+        case data_broker::BOOL_TYPE: record.write(item.b); break;
+        case data_broker::STRING_TYPE: writeString(&record, item.s); break;
+        default: break;
+        }
+      }
+      writeRecord(RECORD_DATA);
+    }
+
+  } // end of namespace sim
+} // end of namespace mars
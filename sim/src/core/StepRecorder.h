@@ -0,0 +1,234 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+ /**
+ * \file StepRecorder.h
+ * \author agent
+ * \brief "StepRecorder" logs the external inputs of every simulation step
+ * to a file and feeds them back to replay a simulation run.
+ *
+ */
+
+#ifndef STEP_RECORDER_H
+#define STEP_RECORDER_H
+
+#ifdef _PRINT_HEADER_
+  #warning "StepRecorder.h"
+#endif
+
+#include <mars/interfaces/MARSDefs.h>
+#include <mars/utils/Vector.h>
+#include <mars/utils/Mutex.h>
+#include <mars/utils/BinaryBuffer.h>
+#include <mars/cfg_manager/CFGClient.h>
+#include <mars/data_broker/ReceiverInterface.h>
+#include <mars/data_broker/DataPackage.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <set>
+
+namespace mars {
+
+  namespace interfaces {
+    class ControlCenter;
+  }
+
+  namespace sim {
+
+    /**
+     * \brief The StepRecorder writes every external input of the simulation
+     * together with the number of the step it belongs to into a binary log
+     * file. The inputs are:
+     *  - motor values and velocities (MotorManager, which includes the
+     *    commands of the controllers),
+     *  - forces and torques applied via the NodeManager,
+     *  - changes of cfg properties,
+     *  - DataBroker packages that were added with addDataItem().
+     *
+     * After every step a hash of the simulation state is written. In replay
+     * mode the inputs of the log are applied at the point of their step at
+     * which they were recorded: inputs given between two steps before the
+     * physics step, inputs given during a step (by the controllers or
+     * plugins) after the update of the nodes, sensors, motors and
+     * controllers. The hashes are compared with the ones of the current
+     * run. The
+     * first step with a different hash is reported. Inputs from other
+     * sources (GUI, plugins) are ignored during the replay, except for cfg
+     * changes and DataBroker packages which can not be blocked.
+     *
+     * The replay only matches the recording if the simulation runs in
+     * deterministic mode and the same scene is loaded. The state of the
+     * random generator of the physics is part of the log header.
+     */
+    class StepRecorder : public cfg_manager::CFGClient,
+                         public data_broker::ReceiverInterface {
+    public:
+      explicit StepRecorder(interfaces::ControlCenter *control);
+      ~StepRecorder();
+
+      /**
+       * \brief Starts a new log file; the steps are counted from now on.
+       * \param seed The state of the random generator of the physics,
+       *        it is written into the header of the log.
+       */
+      bool startRecording(const std::string &filename, unsigned long seed);
+
+      /**
+       * \brief Loads a log file; the steps are counted from now on, thus
+       * the replay has to be started in the state the recording was
+       * started in.
+       * \param seed Returns the state of the random generator of the
+       *        physics at the start of the recording.
+       */
+      bool startReplay(const std::string &filename, unsigned long *seed);
+
+      /**
+       * \brief Stops the recording or replay and closes the log file.
+       */
+      void stop();
+
+      bool isRecording() const;
+      bool isReplaying() const;
+
+      /**
+       * \brief Adds a DataBroker package that is recorded as input.
+       * Must be called before the recording is started.
+       */
+      void addDataItem(const std::string &groupName,
+                       const std::string &dataName);
+      void clearDataItems();
+
+      /**
+       * \brief Called by the managers for every external input.
+       * \return false if the input has to be ignored because a replay is
+       *         running.
+       */
+      bool inputMotorValue(unsigned long id, interfaces::sReal value);
+      bool inputMotorVelocity(unsigned long id, interfaces::sReal velocity);
+      bool inputForce(interfaces::NodeId id, const utils::Vector &force,
+                      const utils::Vector *pos);
+      bool inputTorque(interfaces::NodeId id, const utils::Vector &torque);
+
+      /**
+       * \brief Called by the simulation right before the physics step.
+       * Applies the recorded inputs of the step in replay mode.
+       */
+      void beginStep();
+
+      /**
+       * \brief Called by the simulation after the update of the nodes,
+       * sensors, motors and controllers. Applies the recorded inputs that
+       * were given during the step in replay mode.
+       */
+      void afterUpdate();
+
+      /**
+       * \brief Called by the simulation at the end of a step with the
+       * hash of the simulation state.
+       */
+      void endStep(unsigned long long stateHash);
+
+      /**
+       * \returns The first step whose state hash differs from the
+       * recording or -1.
+       */
+      long long getFirstMismatch() const;
+
+      /**
+       * \brief Computes the FNV-1a hash of the given data.
+       */
+      static unsigned long long hash(const std::vector<char> &data);
+
+      // CFGClient methods
+      virtual void cfgUpdateProperty(cfg_manager::cfgPropertyStruct _property);
+      virtual void cfgParamCreated(cfg_manager::cfgParamId _id);
+
+      // ReceiverInterface methods
+      virtual void receiveData(const data_broker::DataInfo &info,
+                               const data_broker::DataPackage &package,
+                               int callbackParam);
+
+    private:
+      enum Mode {
+        IDLE,
+        RECORDING,
+        REPLAYING
+      };
+
+      enum RecordType {
+        RECORD_MOTOR_VALUE = 1,
+        RECORD_MOTOR_VELOCITY,
+        RECORD_FORCE,
+        RECORD_FORCE_AT,
+        RECORD_TORQUE,
+        RECORD_CFG,
+        RECORD_DATA,
+        RECORD_STATE_HASH
+      };
+
+      // the point of a step at which a record is applied
+      enum Phase {
+        PHASE_BEGIN = 0,
+        PHASE_UPDATE
+      };
+
+      struct Record {
+        unsigned char type, phase;
+        long long step;
+        unsigned long id;
+        utils::Vector v1, v2;
+        double value;
+        unsigned long long hash;
+        cfg_manager::cfgPropertyStruct property;
+        std::string groupName, dataName;
+        data_broker::DataPackage package;
+      };
+
+      bool inputAllowed();
+      void applyRecords(unsigned char phase);
+      void writeRecord(unsigned char type);
+      bool readRecord(utils::BinaryBuffer *buffer, Record *record);
+      void applyRecord(const Record &record);
+      void registerToCFG();
+      void unregisterFromCFG();
+      bool recordParam(cfg_manager::cfgParamId id) const;
+
+      interfaces::ControlCenter *control;
+      mutable utils::Mutex mutex;
+      Mode mode;
+      bool applying, inStep;
+      long long step, firstMismatch;
+      FILE *file;
+      utils::BinaryBuffer record;
+      std::vector<Record> records;
+      std::vector<unsigned long long> stateHashes;
+      size_t nextRecord;
+      std::vector<std::pair<std::string, std::string> > dataItems;
+      std::set<cfg_manager::cfgParamId> cfgParams;
+      // DataBroker items whose unsupported values were reported
+      std::set<std::string> warnedDataItems;
+    }; // end of class StepRecorder
+
+  } // end of namespace sim
+} // end of namespace mars
+
+#endif  // STEP_RECORDER_H
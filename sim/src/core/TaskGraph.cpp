@@ -0,0 +1,94 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+ /**
+ * \file TaskGraph.cpp
+ * \author agent
+ * \brief "TaskGraph" runs tasks with dependencies on a ThreadPool.
+ *
+ */
+
+#include "TaskGraph.h"
+
+#include <mars/utils/MutexLocker.h>
+
+namespace mars {
+  namespace sim {
+
+    using namespace utils;
+
+    TaskGraph::TaskGraph(ThreadPool *pool) : pool(pool) {
+    }
+
+    TaskGraph::~TaskGraph() {
+      for(size_t i=0; i<nodes.size(); ++i) {
+        delete nodes[i];
+      }
+    }
+
+    int TaskGraph::addTask(ThreadPoolTask *task) {
+      Node *node = new Node();
+      node->graph = this;
+      node->task = task;
+      node->numDependencies = 0;
+      node->remaining = 0;
+      nodes.push_back(node);
+      return (int)nodes.size()-1;
+    }
+
+    void TaskGraph::addDependency(int task, int dependency) {
+      nodes[dependency]->successors.push_back(task);
+      ++nodes[task]->numDependencies;
+    }
+
+    void TaskGraph::run(void) {
+      mutex.lock();
+      for(size_t i=0; i<nodes.size(); ++i) {
+        nodes[i]->remaining = nodes[i]->numDependencies;
+      }
+      mutex.unlock();
+
+      for(size_t i=0; i<nodes.size(); ++i) {
+        if(nodes[i]->numDependencies == 0) {
+          pool->addTask(nodes[i], &group);
+        }
+      }
+      pool->waitForTasks(&group);
+    }
+
+    void TaskGraph::Node::runTask(void) {
+      task->runTask();
+      graph->finished(this);
+    }
+
+    void TaskGraph::finished(Node *node) {
+      // the successors are queued before the group counter of this node
+      // is decreased, thus run() can not return too early
+      MutexLocker locker(&mutex);
+      for(size_t i=0; i<node->successors.size(); ++i) {
+        Node *successor = nodes[node->successors[i]];
+        if(--successor->remaining == 0) {
+          pool->addTask(successor, &group);
+        }
+      }
+    }
+
+  } // end of namespace sim
+} // end of namespace mars
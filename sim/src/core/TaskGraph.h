@@ -0,0 +1,98 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+ /**
+ * \file TaskGraph.h
+ * \author agent
+ * \brief "TaskGraph" runs tasks with dependencies on a ThreadPool.
+ *
+ */
+
+#ifndef TASK_GRAPH_H
+#define TASK_GRAPH_H
+
+#ifdef _PRINT_HEADER_
+  #warning "TaskGraph.h"
+#endif
+
+#include "ThreadPool.h"
+
+#include <mars/utils/Mutex.h>
+
+#include <vector>
+
+namespace mars {
+  namespace sim {
+
+    /**
+     * \brief A TaskGraph executes a fixed set of tasks on a ThreadPool.
+     *
+     * A task is started as soon as all tasks it depends on are finished;
+     * independent tasks run in parallel. The graph is set up once and can
+     * be run any number of times. The graph does not take the ownership
+     * of the tasks.
+     */
+    class TaskGraph {
+    public:
+      explicit TaskGraph(ThreadPool *pool);
+      ~TaskGraph();
+
+      /**
+       * \returns The id of the task in the graph.
+       */
+      int addTask(ThreadPoolTask *task);
+
+      /**
+       * \brief The task \c task is not started before \c dependency is
+       * finished.
+       */
+      void addDependency(int task, int dependency);
+
+      /**
+       * \brief Executes all tasks and returns when they are finished.
+       */
+      void run(void);
+
+    private:
+      struct Node : public ThreadPoolTask {
+        TaskGraph *graph;
+        ThreadPoolTask *task;
+        std::vector<int> successors;
+        int numDependencies;
+        int remaining;
+        void runTask(void);
+      };
+
+      void finished(Node *node);
+
+      ThreadPool *pool;
+      std::vector<Node*> nodes;
+      ThreadPoolTaskGroup group;
+      utils::Mutex mutex;
+
+      // disallow copying
+      TaskGraph(const TaskGraph &);
+      TaskGraph &operator=(const TaskGraph &);
+    };
+
+  } // end of namespace sim
+} // end of namespace mars
+
+#endif  // TASK_GRAPH_H
@@ -0,0 +1,163 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+ /**
+ * \file ThreadPool.cpp
+ * \author agent
+ * \brief "ThreadPool" executes short tasks on a fixed set of worker threads.
+ *
+ */
+
+#include "ThreadPool.h"
+
+#include <mars/utils/MutexLocker.h>
+
+#ifdef WIN32
+  #include <windows.h>
+#else
+  #include <unistd.h>
+#endif
+
+namespace mars {
+  namespace sim {
+
+    using namespace utils;
+
+    ThreadPool::ThreadPool(int numThreads) : pending(0), quit(false) {
+      if(numThreads < 0) {
+        numThreads = getNumCores() - 1;
+      }
+      for(int i=0; i<numThreads; ++i) {
+        Worker *worker = new Worker(this);
+        workers.push_back(worker);
+        worker->start();
+      }
+    }
+
+    ThreadPool::~ThreadPool() {
+      mutex.lock();
+      quit = true;
+      taskCondition.wakeAll();
+      mutex.unlock();
+      for(size_t i=0; i<workers.size(); ++i) {
+        workers[i]->wait();
+        delete workers[i];
+      }
+    }
+
+    void ThreadPool::addTask(ThreadPoolTask *task, ThreadPoolTaskGroup *group) {
+      MutexLocker locker(&mutex);
+      QueuedTask queued = {task, group};
+      tasks.push_back(queued);
+      ++pending;
+      if(group) ++group->pending;
+      taskCondition.wakeOne();
+    }
+
+    void ThreadPool::waitForTasks(ThreadPoolTaskGroup *group) {
+      MutexLocker locker(&mutex);
+      while((group ? group->pending : pending) > 0) {
+        if(!runNextTask(group)) {
+          doneCondition.wait(&mutex);
+        }
+      }
+    }
+
+    /**
+     * \brief One range of a parallelFor call.
+     */
+    struct RangeChunk : public ThreadPoolTask {
+      ThreadPoolRangeTask *task;
+      size_t begin, end;
+      void runTask(void) {
+        task->runRange(begin, end);
+      }
+    };
+
+    void ThreadPool::parallelFor(size_t count, ThreadPoolRangeTask *task,
+                                 size_t minRange) {
+      // the chunks are kept on the stack, so no memory is allocated
+      const size_t maxChunks = 64;
+      RangeChunk chunks[maxChunks];
+      ThreadPoolTaskGroup group;
+      size_t numChunks = 4*(workers.size()+1);
+
+      if(minRange < 1) minRange = 1;
+      if(numChunks > count/minRange) numChunks = count/minRange;
+      if(numChunks > maxChunks) numChunks = maxChunks;
+      if(numChunks <= 1) {
+        if(count) task->runRange(0, count);
+        return;
+      }
+
+      for(size_t i=0; i<numChunks; ++i) {
+        chunks[i].task = task;
+        chunks[i].begin = count*i/numChunks;
+        chunks[i].end = count*(i+1)/numChunks;
+        addTask(chunks+i, &group);
+      }
+      waitForTasks(&group);
+    }
+
+    int ThreadPool::getNumThreads(void) const {
+      return (int)workers.size();
+    }
+
+    int ThreadPool::getNumCores(void) {
+#ifdef WIN32
+      SYSTEM_INFO info;
+      GetSystemInfo(&info);
+      return (int)info.dwNumberOfProcessors;
+#else
+      long cores = sysconf(_SC_NPROCESSORS_ONLN);
+      return cores > 0 ? (int)cores : 1;
+#endif
+    }
+
+    bool ThreadPool::runNextTask(ThreadPoolTaskGroup *group) {
+      std::deque<QueuedTask>::iterator it = tasks.begin();
+      if(group) {
+        while(it != tasks.end() && it->group != group) ++it;
+      }
+      if(it == tasks.end()) return false;
+
+      QueuedTask queued = *it;
+      tasks.erase(it);
+      mutex.unlock();
+      queued.task->runTask();
+      mutex.lock();
+      --pending;
+      if(queued.group) --queued.group->pending;
+      // several threads may wait for different groups
+      doneCondition.wakeAll();
+      return true;
+    }
+
+    void ThreadPool::Worker::run() {
+      MutexLocker locker(&pool->mutex);
+      while(!pool->quit) {
+        if(!pool->runNextTask()) {
+          pool->taskCondition.wait(&pool->mutex);
+        }
+      }
+    }
+
+  } // end of namespace sim
+} // end of namespace mars
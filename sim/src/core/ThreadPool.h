@@ -0,0 +1,188 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+ /**
+ * \file ThreadPool.h
+ * \author agent
+ * \brief "ThreadPool" executes short tasks on a fixed set of worker threads.
+ *
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#ifdef _PRINT_HEADER_
+  #warning "ThreadPool.h"
+#endif
+
+#include <mars/utils/Thread.h>
+#include <mars/utils/Mutex.h>
+#include <mars/utils/WaitCondition.h>
+
+#include <deque>
+#include <vector>
+
+namespace mars {
+  namespace sim {
+
+    /**
+     * \brief A task that can be executed by the ThreadPool.
+     */
+    class ThreadPoolTask {
+    public:
+      virtual ~ThreadPoolTask() {}
+      virtual void runTask(void) = 0;
+    };
+
+    /**
+     * \brief A task that runs a member function of an object.
+     */
+    template <class T>
+    class ThreadPoolMemberTask : public ThreadPoolTask {
+    public:
+      ThreadPoolMemberTask(T *object, void (T::*function)(void))
+        : object(object), function(function) {}
+      void runTask(void) {
+        (object->*function)();
+      }
+    private:
+      T *object;
+      void (T::*function)(void);
+    };
+
+    /**
+     * \brief A task that processes a range of elements, see
+     * ThreadPool::parallelFor.
+     */
+    class ThreadPoolRangeTask {
+    public:
+      virtual ~ThreadPoolRangeTask() {}
+      virtual void runRange(size_t begin, size_t end) = 0;
+    };
+
+    /**
+     * \brief A set of tasks that can be waited for independently of the
+     * other tasks of the pool.
+     */
+    class ThreadPoolTaskGroup {
+    public:
+      ThreadPoolTaskGroup() : pending(0) {}
+    private:
+      friend class ThreadPool;
+      int pending;
+    };
+
+    /**
+     * \brief The ThreadPool runs tasks on worker threads that are created
+     * once, so the pool can be used every simulation step.
+     *
+     * Tasks are queued with addTask() and executed in any order. The
+     * thread calling waitForTasks() works on the queue as well until all
+     * tasks are done. The pool does not take the ownership of the tasks.
+     * With zero worker threads all tasks are executed by the thread that
+     * calls waitForTasks().
+     */
+    class ThreadPool {
+    public:
+      /**
+       * \param numThreads The number of worker threads. If negative one
+       * thread less than the number of available cpu cores is created,
+       * since the calling thread is working as well.
+       */
+      explicit ThreadPool(int numThreads = -1);
+      ~ThreadPool();
+
+      /**
+       * \brief Queues a task.
+       * \param group If given, the task can be waited for by
+       * waitForTasks(group).
+       */
+      void addTask(ThreadPoolTask *task, ThreadPoolTaskGroup *group = NULL);
+
+      /**
+       * \brief Blocks until all tasks of the group, or all tasks if no
+       * group is given, are finished. Tasks may be added while waiting.
+       *
+       * Waiting threads execute queued tasks, so tasks can wait for
+       * their own sub tasks without blocking a worker. A thread waiting
+       * for a group only executes tasks of that group; thus the caller
+       * can hold a lock that other queued tasks may wait for.
+       */
+      void waitForTasks(ThreadPoolTaskGroup *group = NULL);
+
+      /**
+       * \brief Splits [0, count) into contiguous ranges, runs them on the
+       * pool and returns when all ranges are done.
+       *
+       * \param minRange Ranges are not made smaller than this to keep the
+       * scheduling overhead low for cheap elements.
+       */
+      void parallelFor(size_t count, ThreadPoolRangeTask *task,
+                       size_t minRange = 1);
+
+      int getNumThreads(void) const;
+
+      /**
+       * \returns The number of cpu cores that are online.
+       */
+      static int getNumCores(void);
+
+    private:
+      class Worker : public utils::Thread {
+      public:
+        explicit Worker(ThreadPool *pool) : pool(pool) {}
+      protected:
+        void run();
+      private:
+        ThreadPool *pool;
+      };
+      friend class Worker;
+
+      /**
+       * \brief Takes the next task from the queue and executes it.
+       * pre: mutex is locked
+       * post: mutex is locked
+       * \param group If given, only a task of this group is taken.
+       * \returns \c false if no matching task was queued.
+       */
+      bool runNextTask(ThreadPoolTaskGroup *group = NULL);
+
+      std::vector<Worker*> workers;
+      struct QueuedTask {
+        ThreadPoolTask *task;
+        ThreadPoolTaskGroup *group;
+      };
+
+      std::deque<QueuedTask> tasks;
+      utils::Mutex mutex;
+      utils::WaitCondition taskCondition;
+      utils::WaitCondition doneCondition;
+      int pending;
+      bool quit;
+
+      // disallow copying
+      ThreadPool(const ThreadPool &);
+      ThreadPool &operator=(const ThreadPool &);
+    };
+
+  } // end of namespace sim
+} // end of namespace mars
+
+#endif  // THREAD_POOL_H
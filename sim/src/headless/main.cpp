@@ -0,0 +1,283 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file main.cpp
+ * \author agent
+ * \brief mars_headless runs a simulation without graphics and gui as fast
+ * as possible and reports the achieved real-time factor.
+ *
+ * The simulation thread is not started; the runner calls
+ * Simulator::step() directly. Meshes and heightmaps are loaded by the
+ * graphics-free GeometryLoader of mars_sim. With "-i N" N independent
+ * simulations, each loaded by its own LibManager, are stepped in
+ * parallel.
+ */
+
+#include <lib_manager/LibManager.hpp>
+#include <mars/interfaces/sim/SimulatorInterface.h>
+#include <mars/interfaces/sim/ControlCenter.h>
+#include <mars/cfg_manager/CFGManagerInterface.h>
+#include <mars/utils/Thread.h>
+#include <mars/utils/misc.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <clocale>
+#include <string>
+#include <vector>
+#include <getopt.h>
+#include <signal.h>
+
+#ifndef DEFAULT_CONFIG_DIR
+    #define DEFAULT_CONFIG_DIR "."
+#endif
+
+static volatile sig_atomic_t quit = 0;
+
+void exitHandler(int sig) {
+  (void)sig;
+  quit = 1;
+}
+
+void printHelp() {
+  printf("\nusage: mars_headless [options]\n");
+  printf("=======================================\n");
+  printf("-h             this screen\n");
+  printf("-C <dir>       path to configuration (core_libs-nogui.txt)\n");
+  printf("-s <filename>  scene to load (can be given multiple times)\n");
+  printf("-n <steps>     number of steps to simulate\n");
+  printf("-t <seconds>   simulation time to simulate\n");
+  printf("-c <ms>        physics step size in ms\n");
+  printf("-i <number>    number of parallel simulation instances\n");
+  printf("-p <seconds>   print progress every n seconds of simulation time\n");
+  printf("\n");
+}
+
+/**
+ * \brief One simulation with its own libraries that is stepped by its own
+ * thread.
+ */
+class HeadlessRunner : public mars::utils::Thread {
+public:
+  HeadlessRunner(int id) : id(id), libManager(NULL), marsSim(NULL), cfg(NULL),
+                           maxSteps(0), steps(0), stepMs(10.), syncMs(40.),
+                           progress(0.), wallMs(0) {
+  }
+
+  ~HeadlessRunner() {
+    if(marsSim) {
+      marsSim->exitMars();
+      libManager->releaseLibrary("mars_scene_loader");
+      libManager->releaseLibrary("mars_sim");
+      libManager->releaseLibrary("cfg_manager");
+      libManager->releaseLibrary("data_broker");
+    }
+    delete libManager;
+  }
+
+  bool load(const std::string &configDir,
+            const std::vector<std::string> &scenes,
+            double calcMs) {
+    libManager = new lib_manager::LibManager();
+    libManager->loadConfigFile(configDir+"/core_libs-nogui.txt");
+
+    cfg = libManager->getLibraryAs<mars::cfg_manager::CFGManagerInterface>("cfg_manager");
+    if(cfg) {
+      mars::cfg_manager::cfgPropertyStruct configPath;
+      configPath = cfg->getOrCreateProperty("Config", "config_path", configDir);
+      configPath.sValue = configDir;
+      cfg->setProperty(configPath);
+    }
+
+    marsSim = libManager->getLibraryAs<mars::interfaces::SimulatorInterface>("mars_sim");
+    if(!marsSim) {
+      fprintf(stderr, "mars_headless: error while casting simulation lib\n\n");
+      return false;
+    }
+    if(marsSim->getControlCenter()->graphics) {
+      fprintf(stderr, "mars_headless: warning: mars_graphics is loaded\n");
+    }
+
+    // the simulation thread is not started, we step in the runner thread
+    marsSim->runSimulation(false);
+    if(cfg && calcMs > 0.) {
+      cfg->setPropertyValue("Simulator", "calc_ms", "value", calcMs);
+    }
+
+    for(size_t i=0; i<scenes.size(); ++i) {
+      if(!marsSim->loadScene(scenes[i])) {
+        fprintf(stderr, "mars_headless: could not load scene: %s\n",
+                scenes[i].c_str());
+        return false;
+      }
+    }
+
+    if(cfg) {
+      cfg->getPropertyValue("Simulator", "calc_ms", "value", &stepMs);
+      cfg->getPropertyValue("Simulator", "sync time", "value", &syncMs);
+    }
+    // activate the plugins that were added while loading
+    marsSim->finishedDraw();
+    return true;
+  }
+
+  int id;
+  lib_manager::LibManager *libManager;
+  mars::interfaces::SimulatorInterface *marsSim;
+  mars::cfg_manager::CFGManagerInterface *cfg;
+  unsigned long maxSteps, steps;
+  double stepMs, syncMs, progress;
+  long long wallMs;
+
+protected:
+  void run() {
+    double drawMs = 0., progressMs = 0.;
+    long long startTime = mars::utils::getTime();
+
+    while(!quit && steps < maxSteps) {
+      marsSim->step();
+      ++steps;
+
+      // handle requests and gui plugins at the rate the gui would draw
+      drawMs += stepMs;
+      if(drawMs >= syncMs) {
+        marsSim->finishedDraw();
+        drawMs = 0.;
+      }
+
+      if(marsSim->hasSimFault()) {
+        fprintf(stderr, "mars_headless: simulation %d: fault at step %lu\n",
+                id, steps);
+        break;
+      }
+
+      if(progress > 0.) {
+        progressMs += stepMs;
+        if(progressMs >= progress*1000.) {
+          long long diff = mars::utils::getTimeDiff(startTime);
+          fprintf(stderr, "mars_headless: simulation %d: %.1f s simulated, "
+                  "factor %.2f\n", id, steps*stepMs*0.001,
+                  diff > 0 ? steps*stepMs/diff : 0.);
+          progressMs = 0.;
+        }
+      }
+    }
+    wallMs = mars::utils::getTimeDiff(startTime);
+  }
+};
+
+int main(int argc, char *argv[]) {
+  std::string configDir = DEFAULT_CONFIG_DIR;
+  std::vector<std::string> scenes;
+  unsigned long maxSteps = 0;
+  double maxSimTime = 0., calcMs = 0., progress = 0.;
+  int numInstances = 1;
+  int c;
+
+  while((c = getopt(argc, argv, "hC:s:n:t:c:i:p:")) != -1) {
+    switch(c) {
+    case 'C':
+      configDir = optarg;
+      break;
+    case 's':
+      scenes.push_back(optarg);
+      break;
+    case 'n':
+      maxSteps = strtoul(optarg, NULL, 10);
+      break;
+    case 't':
+      maxSimTime = atof(optarg);
+      break;
+    case 'c':
+      calcMs = atof(optarg);
+      break;
+    case 'i':
+      numInstances = atoi(optarg);
+      break;
+    case 'p':
+      progress = atof(optarg);
+      break;
+    case 'h':
+    default:
+      printHelp();
+      return (c == 'h') ? 0 : 1;
+    }
+  }
+  if(!maxSteps && maxSimTime <= 0.) {
+    fprintf(stderr, "mars_headless: either -n or -t has to be given\n");
+    printHelp();
+    return 1;
+  }
+  if(numInstances < 1) numInstances = 1;
+
+  signal(SIGINT, exitHandler);
+  signal(SIGTERM, exitHandler);
+
+  // mars expects english number interpretation
+  setenv("LC_ALL", "C", 1);
+  unsetenv("LANG");
+  setlocale(LC_ALL, "C");
+
+  // the libraries are loaded one after the other, only stepping is parallel
+  std::vector<HeadlessRunner*> runners;
+  int state = 0;
+  for(int i=0; i<numInstances; ++i) {
+    HeadlessRunner *runner = new HeadlessRunner(i);
+    runners.push_back(runner);
+    if(!runner->load(configDir, scenes, calcMs)) {
+      state = 2;
+      break;
+    }
+    runner->maxSteps = maxSteps;
+    if(maxSimTime > 0.) {
+      unsigned long steps;
+      steps = (unsigned long)(maxSimTime*1000./runner->stepMs + 0.5);
+      if(!maxSteps || steps < maxSteps) runner->maxSteps = steps;
+    }
+    runner->progress = progress;
+  }
+
+  if(!state) {
+    long long startTime = mars::utils::getTime();
+    for(size_t i=0; i<runners.size(); ++i) {
+      runners[i]->start();
+    }
+    double simMs = 0.;
+    unsigned long steps = 0;
+    for(size_t i=0; i<runners.size(); ++i) {
+      runners[i]->wait();
+      steps += runners[i]->steps;
+      simMs += runners[i]->steps*runners[i]->stepMs;
+    }
+    long long wallMs = mars::utils::getTimeDiff(startTime);
+
+    printf("instances: %d\n", numInstances);
+    printf("steps: %lu\n", steps);
+    printf("simulation time: %.3f s\n", simMs*0.001);
+    printf("wall time: %.3f s\n", wallMs*0.001);
+    printf("real-time factor: %.2f\n", wallMs > 0 ? simMs/wallMs : 0.);
+  }
+
+  for(size_t i=0; i<runners.size(); ++i) {
+    delete runners[i];
+  }
+  return state;
+}
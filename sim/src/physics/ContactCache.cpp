@@ -0,0 +1,247 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+ /**
+ * \file ContactCache.cpp
+ * \author agent
+ * \brief "ContactCache" keeps the contacts of the colliding geom pairs
+ * from step to step and reduces them to the relevant points.
+ *
+ */
+
+#include "ContactCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace mars {
+  namespace sim {
+
+    // size of the polygon of the contact reduction
+    static const int maxReducedContacts = 16;
+
+    static inline dReal distance2(const dReal *a, const dReal *b) {
+      return ((a[0]-b[0])*(a[0]-b[0]) + (a[1]-b[1])*(a[1]-b[1]) +
+              (a[2]-b[2])*(a[2]-b[2]));
+    }
+
+    /**
+     * \returns Twice the area of the triangle a, b, p seen along the
+     * normal; positive if p is left of the edge from a to b.
+     */
+    static inline dReal signedArea(const dReal *normal, const dReal *a,
+                                   const dReal *b, const dReal *p) {
+      dReal u[3], v[3];
+      for(int k=0; k<3; ++k) {
+        u[k] = b[k] - a[k];
+        v[k] = p[k] - a[k];
+      }
+      return (normal[0]*(u[1]*v[2] - u[2]*v[1]) +
+              normal[1]*(u[2]*v[0] - u[0]*v[2]) +
+              normal[2]*(u[0]*v[1] - u[1]*v[0]));
+    }
+
+    ContactCache::ContactCache() : maxDistance(0.0), minCosAngle(1.0),
+                                   numHits(0) {
+    }
+
+    void ContactCache::setThresholds(dReal distance, dReal angle) {
+      maxDistance = distance;
+      minCosAngle = std::cos(angle);
+      if(!isEnabled()) clear();
+    }
+
+    bool ContactCache::isEnabled(void) const {
+      return maxDistance > 0;
+    }
+
+    ContactCache::Key ContactCache::makeKey(dGeomID o1, dGeomID o2) {
+      return o1 < o2 ? Key(o1, o2) : Key(o2, o1);
+    }
+
+    void ContactCache::getPose(dGeomID geom, Pose *pose) {
+      // planes are not placeable and never moved by the simulation
+      if(dGeomGetClass(geom) == dPlaneClass) {
+        memset(pose, 0, sizeof(Pose));
+        return;
+      }
+      memcpy(pose->pos, dGeomGetPosition(geom), sizeof(dVector3));
+      memcpy(pose->R, dGeomGetRotation(geom), sizeof(dMatrix3));
+    }
+
+    bool ContactCache::hasMoved(dGeomID geom, const Pose &pose) const {
+      if(dGeomGetClass(geom) == dPlaneClass) return false;
+      if(distance2(dGeomGetPosition(geom), pose.pos) >
+         maxDistance*maxDistance) {
+        return true;
+      }
+      // the trace of R0^T*R is 1 + 2*cos(angle)
+      const dReal *R = dGeomGetRotation(geom);
+      dReal trace = 0.0;
+      for(int r=0; r<3; ++r) {
+        for(int c=0; c<3; ++c) {
+          trace += pose.R[r*4+c] * R[r*4+c];
+        }
+      }
+      return (trace - 1.0)*0.5 < minCosAngle;
+    }
+
+    bool ContactCache::get(dGeomID o1, dGeomID o2, unsigned long generation,
+                           dContact *contacts, int maxContacts,
+                           int *numContacts) {
+      if(!isEnabled()) return false;
+      std::map<Key, Entry>::iterator it = entries.find(makeKey(o1, o2));
+      if(it == entries.end()) return false;
+      Entry &entry = it->second;
+      if(entry.o1 != o1 || (int)entry.contacts.size() > maxContacts) {
+        return false;
+      }
+      if(hasMoved(o1, entry.pose1) || hasMoved(o2, entry.pose2)) {
+        return false;
+      }
+      entry.generation = generation;
+      for(size_t i=0; i<entry.contacts.size(); ++i) {
+        contacts[i].geom = entry.contacts[i];
+      }
+      *numContacts = (int)entry.contacts.size();
+      ++numHits;
+      return true;
+    }
+
+    bool ContactCache::set(dGeomID o1, dGeomID o2, unsigned long generation,
+                           const dContact *contacts, int numContacts) {
+      Key key = makeKey(o1, o2);
+      std::map<Key, Entry>::iterator it = entries.find(key);
+      bool created = false;
+      if(it == entries.end()) {
+        it = entries.insert(std::make_pair(key, Entry())).first;
+        created = true;
+      }
+      Entry &entry = it->second;
+      entry.o1 = o1;
+      entry.generation = generation;
+      getPose(o1, &entry.pose1);
+      getPose(o2, &entry.pose2);
+      // the vector keeps its memory while the pair is colliding
+      entry.contacts.resize(numContacts);
+      for(int i=0; i<numContacts; ++i) {
+        entry.contacts[i] = contacts[i].geom;
+      }
+      return created;
+    }
+
+    void ContactCache::removeOld(unsigned long generation) {
+      std::map<Key, Entry>::iterator it = entries.begin();
+      while(it != entries.end()) {
+        if(it->second.generation != generation) entries.erase(it++);
+        else ++it;
+      }
+    }
+
+    void ContactCache::removeGeom(dGeomID geom) {
+      std::map<Key, Entry>::iterator it = entries.begin();
+      while(it != entries.end()) {
+        if(it->first.first == geom || it->first.second == geom) {
+          entries.erase(it++);
+        }
+        else ++it;
+      }
+    }
+
+    void ContactCache::clear(void) {
+      entries.clear();
+    }
+
+    unsigned long ContactCache::getNumHits(void) const {
+      return numHits;
+    }
+
+    void ContactCache::resetNumHits(void) {
+      numHits = 0;
+    }
+
+    int ContactCache::reduceContacts(dContact *contacts, int numContacts,
+                                     int maxContacts) {
+      if(maxContacts > maxReducedContacts) maxContacts = maxReducedContacts;
+      if(maxContacts < 1 || numContacts <= maxContacts) return numContacts;
+
+      int best = 0;
+      for(int i=1; i<numContacts; ++i) {
+        if(contacts[i].geom.depth > contacts[best].geom.depth) best = i;
+      }
+      std::swap(contacts[0], contacts[best]);
+      if(maxContacts == 1) return 1;
+
+      const dReal *p0 = contacts[0].geom.pos;
+      dReal bestValue = -1.0;
+      for(int i=1; i<numContacts; ++i) {
+        dReal d = distance2(contacts[i].geom.pos, p0);
+        if(d > bestValue) {
+          bestValue = d;
+          best = i;
+        }
+      }
+      std::swap(contacts[1], contacts[best]);
+
+      // The selected contacts form a convex polygon in counterclockwise
+      // order around the normal of the deepest contact. The area that a
+      // point adds is the sum of the triangles with the edges it sees.
+      dVector3 normal;
+      memcpy(normal, contacts[0].geom.normal, sizeof(dVector3));
+      int polygon[maxReducedContacts];
+      int size = 2;
+      polygon[0] = 0;
+      polygon[1] = 1;
+      for(int k=2; k<maxContacts; ++k) {
+        int bestEdge = 0;
+        best = k;
+        bestValue = -1.0;
+        for(int i=k; i<numContacts; ++i) {
+          const dReal *p = contacts[i].geom.pos;
+          dReal gain = 0.0, edgeGain = -1.0;
+          int edge = 0;
+          for(int e=0; e<size; ++e) {
+            const dReal *a = contacts[polygon[e]].geom.pos;
+            const dReal *b = contacts[polygon[(e+1)%size]].geom.pos;
+            dReal s = -signedArea(normal, a, b, p);
+            if(s > 0) gain += s;
+            if(s > edgeGain) {
+              edgeGain = s;
+              edge = e;
+            }
+          }
+          if(gain > bestValue) {
+            bestValue = gain;
+            best = i;
+            bestEdge = edge;
+          }
+        }
+        std::swap(contacts[k], contacts[best]);
+        // insert the new point between the vertices of its edge
+        for(int e=size; e>bestEdge+1; --e) polygon[e] = polygon[e-1];
+        polygon[bestEdge+1] = k;
+        ++size;
+      }
+      return maxContacts;
+    }
+
+  } // end of namespace sim
+} // end of namespace mars
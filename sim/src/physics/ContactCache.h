@@ -0,0 +1,135 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+ /**
+ * \file ContactCache.h
+ * \author agent
+ * \brief "ContactCache" keeps the contacts of the colliding geom pairs
+ * from step to step and reduces them to the relevant points.
+ *
+ */
+
+#ifndef CONTACT_CACHE_H
+#define CONTACT_CACHE_H
+
+#ifdef _PRINT_HEADER_
+  #warning "ContactCache.h"
+#endif
+
+#include <map>
+#include <vector>
+#include <utility>
+
+#include <ode/ode.h>
+
+namespace mars {
+  namespace sim {
+
+    /**
+     * \brief The ContactCache stores the contacts of every geom pair
+     * together with the poses of both geoms.
+     *
+     * As long as neither geom of a pair moved further than the distance
+     * threshold or rotated more than the angle threshold since its
+     * contacts were generated, the stored contacts are used instead of a
+     * new narrowphase test. Geoms at rest, e.g. a standing robot, keep
+     * their contacts unchanged, which avoids the jitter of contacts
+     * that are generated anew every step.
+     *
+     * The pairs that were not colliding in a step are removed by
+     * removeOld(). Destroyed geoms have to be removed with removeGeom(),
+     * since ODE reuses the memory of the geoms.
+     */
+    class ContactCache {
+    public:
+      ContactCache();
+
+      /**
+       * \brief Sets the thresholds of the pose change; a distance <= 0
+       * disables the cache.
+       */
+      void setThresholds(dReal distance, dReal angle);
+      bool isEnabled(void) const;
+
+      /**
+       * \brief Copies the cached contacts of the pair into the geom
+       * member of the contacts.
+       * \returns false if the pair is not cached, was stored in the other
+       *          order, has more than maxContacts contacts or one of the
+       *          geoms has moved too far. The contacts are not changed
+       *          in that case.
+       */
+      bool get(dGeomID o1, dGeomID o2, unsigned long generation,
+               dContact *contacts, int maxContacts, int *numContacts);
+
+      /**
+       * \brief Stores the contacts and the current poses of the pair.
+       * \returns true if a new entry was created.
+       */
+      bool set(dGeomID o1, dGeomID o2, unsigned long generation,
+               const dContact *contacts, int numContacts);
+
+      /// removes the pairs that were not used in the given generation
+      void removeOld(unsigned long generation);
+      void removeGeom(dGeomID geom);
+      void clear(void);
+
+      /// number of pairs whose cached contacts were used since the reset
+      unsigned long getNumHits(void) const;
+      void resetNumHits(void);
+
+      /**
+       * \brief Reduces the contacts to at most maxContacts points in
+       * place: the deepest contact, the contact farthest from it, the
+       * contact that spans the largest triangle with both and then the
+       * contacts that add the largest area to the polygon.
+       * \returns the new number of contacts.
+       */
+      static int reduceContacts(dContact *contacts, int numContacts,
+                                int maxContacts);
+
+    private:
+      struct Pose {
+        dVector3 pos;
+        dMatrix3 R;
+      };
+
+      struct Entry {
+        dGeomID o1;
+        Pose pose1, pose2;
+        unsigned long generation;
+        std::vector<dContactGeom> contacts;
+      };
+
+      typedef std::pair<dGeomID, dGeomID> Key;
+
+      static Key makeKey(dGeomID o1, dGeomID o2);
+      static void getPose(dGeomID geom, Pose *pose);
+      bool hasMoved(dGeomID geom, const Pose &pose) const;
+
+      std::map<Key, Entry> entries;
+      dReal maxDistance, minCosAngle;
+      unsigned long numHits;
+    }; // end of class ContactCache
+
+  } // end of namespace sim
+} // end of namespace mars
+
+#endif  // CONTACT_CACHE_H
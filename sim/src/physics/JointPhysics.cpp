@@ -28,7 +28,7 @@
  *  
  */
 
-#include <mars/utils/MutexLocker.h>
+#include <mars/utils/ReadWriteLocker.h>
 
 #include "JointPhysics.h"
 #include "NodePhysics.h"
@@ -66,7 +66,7 @@ namespace mars {
      *     - all physical representation of the joint should be cleared
      */
     JointPhysics::~JointPhysics(void) {
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_WRITE);
       if (jointId) {
         dJointDestroy(jointId);
       }
@@ -114,7 +114,7 @@ namespace mars {
               jointS->anchor.x(), jointS->anchor.y(), jointS->anchor.z(),
               jointS->axis1.x(), jointS->axis1.y(), jointS->axis1.z());
 #endif
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_WRITE);
       if ( theWorld && theWorld->existsWorld() ) {
         //get the bodies from the interfaces nodes
         //here we have to make some verifications
@@ -168,9 +168,8 @@ namespace mars {
     }
 
     ///get the anchor of the joint
-    void JointPhysics::getAnchor(Vector* anchor) const {
+    void JointPhysics::getAnchorUnlocked(Vector* anchor) const {
       dReal pos[4] = {0,0,0,0};
-      MutexLocker locker(&(theWorld->iMutex));
 
       switch(joint_type) {
       case  JOINT_TYPE_HINGE:
@@ -197,9 +196,14 @@ namespace mars {
       anchor->z() = pos[2];
     }
 
+    void JointPhysics::getAnchor(Vector* anchor) const {
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_READ);
+      getAnchorUnlocked(anchor);
+    }
+
     // the next force and velocity methods are only in a beta state
     void JointPhysics::setForceLimit(sReal max_force) {
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_WRITE);
 
       switch(joint_type) {
       case  JOINT_TYPE_HINGE:
@@ -218,7 +222,7 @@ namespace mars {
     }
 
     void JointPhysics::setForceLimit2(sReal max_force) {
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_WRITE);
 
       switch(joint_type) {
       case  JOINT_TYPE_HINGE:
@@ -234,8 +238,14 @@ namespace mars {
       }
     }
 
+    void JointPhysics::wakeBodies(void) {
+      if(body1) dBodyEnable(body1);
+      if(body2) dBodyEnable(body2);
+    }
+
     void JointPhysics::setVelocity(sReal velocity) {
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_WRITE);
+      if(velocity != 0) wakeBodies();
 
       switch(joint_type) {
       case  JOINT_TYPE_HINGE:
@@ -254,7 +264,8 @@ namespace mars {
     }
 
     void JointPhysics::setVelocity2(sReal velocity) {
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_WRITE);
+      if(velocity != 0) wakeBodies();
 
       switch(joint_type) {
       case  JOINT_TYPE_HINGE:
@@ -270,9 +281,7 @@ namespace mars {
       }
     }
 
-    sReal JointPhysics::getPosition(void) const {
-      MutexLocker locker(&(theWorld->iMutex));
-
+    sReal JointPhysics::getPositionUnlocked(void) const {
       switch(joint_type) {
       case  JOINT_TYPE_HINGE:
         return (sReal)dJointGetHingeAngle(jointId);
@@ -290,9 +299,12 @@ namespace mars {
       return 0;
     }
 
-    sReal JointPhysics::getPosition2(void) const {
-      MutexLocker locker(&(theWorld->iMutex));
+    sReal JointPhysics::getPosition(void) const {
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_READ);
+      return getPositionUnlocked();
+    }
 
+    sReal JointPhysics::getPosition2Unlocked(void) const {
       switch(joint_type) {
       case JOINT_TYPE_UNIVERSAL:
         return (sReal)dJointGetUniversalAngle2(jointId);
@@ -301,6 +313,11 @@ namespace mars {
       return 0;
     }
 
+    sReal JointPhysics::getPosition2(void) const {
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_READ);
+      return getPosition2Unlocked();
+    }
+
 
 
     /**
@@ -502,7 +519,7 @@ namespace mars {
 
     /// set the anchor i.e. the position where the joint is created of the joint 
     void JointPhysics::setAnchor(const Vector &anchor){
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_WRITE);
 
       switch(joint_type) {
       case  JOINT_TYPE_HINGE:
@@ -535,7 +552,7 @@ namespace mars {
      * post:
      */
     void JointPhysics::setAxis(const Vector &axis){
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_WRITE);
 
       switch(joint_type) {
       case  JOINT_TYPE_HINGE:
@@ -567,7 +584,7 @@ namespace mars {
      * post:
      */
     void JointPhysics::setAxis2(const Vector &axis){
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_WRITE);
       switch(joint_type) {
       case  JOINT_TYPE_HINGE:
         // the hinge joint has only one axis
@@ -599,9 +616,8 @@ namespace mars {
      * post:
      *     - the given axis struct should be filled with correct values
      */
-    void JointPhysics::getAxis(Vector* axis) const {
+    void JointPhysics::getAxisUnlocked(Vector* axis) const {
       dReal pos[4] = {0,0,0,0};
-      MutexLocker locker(&(theWorld->iMutex));
 
       switch(joint_type) {
       case  JOINT_TYPE_HINGE:
@@ -628,6 +644,11 @@ namespace mars {
       axis->z() = (sReal)pos[2];
     }
 
+    void JointPhysics::getAxis(Vector* axis) const {
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_READ);
+      getAxisUnlocked(axis);
+    }
+
     /**
      * \brief Gets the actual second axis of a joint
      *
@@ -637,9 +658,8 @@ namespace mars {
      * post:
      *     - the given axis struct should be filled with correct values
      */
-    void JointPhysics::getAxis2(Vector* axis) const {
+    void JointPhysics::getAxis2Unlocked(Vector* axis) const {
       dReal pos[4] = {0,0,0,0};
-      MutexLocker locker(&(theWorld->iMutex));
 
       switch(joint_type) {
       case  JOINT_TYPE_HINGE:
@@ -666,13 +686,18 @@ namespace mars {
       axis->z() = (sReal)pos[2];
     }
 
+    void JointPhysics::getAxis2(Vector* axis) const {
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_READ);
+      getAxis2Unlocked(axis);
+    }
+
     ///set the world informations
     void JointPhysics::setWorldObject(PhysicsInterface* world){
       theWorld = (WorldPhysics*)world;
     }
 
     void JointPhysics::setJointAsMotor(int axis) {
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_WRITE);
       switch(joint_type) {
       case  JOINT_TYPE_HINGE:
         if(!lo1 && !hi1) {
@@ -712,7 +737,7 @@ namespace mars {
     }
 
     void JointPhysics::unsetJointAsMotor(int axis) {
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_WRITE);
       switch(joint_type) {
       case  JOINT_TYPE_HINGE:
         dJointSetHingeParam(jointId, dParamLoStop, lo1);
@@ -818,7 +843,7 @@ namespace mars {
      */
     void JointPhysics::reattacheJoint(void) {
       dReal pos[4] = {0,0,0,0};
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_WRITE);
 
       switch(joint_type) {
       case  JOINT_TYPE_HINGE:
@@ -890,13 +915,21 @@ namespace mars {
      * we can return it.
      *
      */
-    void JointPhysics::update(void) {
+    void JointPhysics::update(JointState *state) {
       const dReal *b1_pos, *b2_pos;
       dReal anchor[4], axis[4], axis2[4];
       bool calc1 = 0, calc2 = 0;
       dReal radius, dot, torque;
       dReal v1[3], normal[3], load[3], tmp1[3], axis_force[3];
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_READ);
+
+      state->position1 = getPositionUnlocked();
+      state->position2 = getPosition2Unlocked();
+      state->velocity1 = getVelocityUnlocked();
+      state->velocity2 = getVelocity2Unlocked();
+      getAnchorUnlocked(&state->anchor);
+      getAxisUnlocked(&state->axis1);
+      getAxis2Unlocked(&state->axis2);
 
       switch(joint_type) {
       case  JOINT_TYPE_HINGE:
@@ -1075,8 +1108,7 @@ namespace mars {
     }
 
 
-    sReal JointPhysics::getVelocity(void) const {
-      MutexLocker locker(&(theWorld->iMutex));
+    sReal JointPhysics::getVelocityUnlocked(void) const {
       switch(joint_type) {
       case  JOINT_TYPE_HINGE:
         return (sReal)dJointGetHingeAngleRate(jointId);
@@ -1100,8 +1132,12 @@ namespace mars {
       return 0;
     }
 
-    sReal JointPhysics::getVelocity2(void) const {
-      MutexLocker locker(&(theWorld->iMutex));
+    sReal JointPhysics::getVelocity(void) const {
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_READ);
+      return getVelocityUnlocked();
+    }
+
+    sReal JointPhysics::getVelocity2Unlocked(void) const {
       switch(joint_type) {
       case  JOINT_TYPE_HINGE:
         break;
@@ -1123,8 +1159,14 @@ namespace mars {
       return 0;
     }
 
+    sReal JointPhysics::getVelocity2(void) const {
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_READ);
+      return getVelocity2Unlocked();
+    }
+
     void JointPhysics::setTorque(sReal torque) {
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_WRITE);
+      if(torque != 0) wakeBodies();
       switch(joint_type) {
       case JOINT_TYPE_HINGE:
         dJointAddHingeTorque(jointId, torque);
@@ -1167,7 +1209,7 @@ namespace mars {
     }
 
     void JointPhysics::changeStepSize(const JointData &jointS) {
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_WRITE);
       if(theWorld && theWorld->existsWorld()) {
         calculateCfmErp(&jointS);
 
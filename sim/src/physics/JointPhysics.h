@@ -72,7 +72,7 @@ namespace mars {
       virtual void setTorque(interfaces::sReal torque);
       virtual void setTorque2(interfaces::sReal torque);
       virtual void reattacheJoint(void);
-      virtual void update(void);
+      virtual void update(interfaces::JointState *state);
       virtual void getJointLoad(utils::Vector *t) const;
       virtual void getAxisTorque(utils::Vector *t) const;
       virtual void getAxis2Torque(utils::Vector *t) const;
@@ -100,6 +100,16 @@ namespace mars {
       dReal motor_torque;
 
       void calculateCfmErp(const interfaces::JointData *jointS);
+      /// the getters without locking the physics
+      void getAnchorUnlocked(utils::Vector *anchor) const;
+      void getAxisUnlocked(utils::Vector *axis) const;
+      void getAxis2Unlocked(utils::Vector *axis) const;
+      interfaces::sReal getPositionUnlocked(void) const;
+      interfaces::sReal getPosition2Unlocked(void) const;
+      interfaces::sReal getVelocityUnlocked(void) const;
+      interfaces::sReal getVelocity2Unlocked(void) const;
+      /// enables disabled bodies before the motor changes
+      void wakeBodies(void);
 
       ///create a joint from type Hing
       void createHinge(interfaces::JointData* jointS,
@@ -39,7 +39,7 @@
 #include "../sensors/RotatingRaySensor.h"
 
 #include <mars/interfaces/Logging.hpp>
-#include <mars/utils/MutexLocker.h>
+#include <mars/utils/ReadWriteLocker.h>
 #include <mars/utils/mathUtils.h>
 #include <mars/interfaces/sensor_bases.h>
 #include <mars/interfaces/terrainStruct.h>
@@ -72,13 +72,13 @@ namespace mars {
       theWorld = (WorldPhysics*)world;
       nBody = 0;
       nGeom = 0;
-      myVertices = 0;
-      myIndices = 0;
-      myTriMeshData = 0;
+      myTriMesh = 0;
+      myConvex = 0;
       composite = false;
       //node_data.num_ground_collisions = 0;
       node_data.setZero();
-      height_data = 0;
+      terrain = 0;
+      tiledHeightfield = 0;
       dMassSetZero(&nMass);
     }
 
@@ -94,27 +94,15 @@ namespace mars {
      * are the geom and the body realy all thing to take care of?
      */
     NodePhysics::~NodePhysics(void) {
-      std::vector<sensor_list_element>::iterator iter;
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_WRITE);
 
       if(nBody) theWorld->destroyBody(nBody, this);
 
-      if(nGeom) dGeomDestroy(nGeom);
-
-      if(myVertices) free(myVertices);
-      if(myIndices) free(myIndices);
-      if(height_data) free(height_data);
+      destroyTiledHeightfield();
+      if(nGeom) theWorld->destroyGeom(nGeom);
 
-      // TODO: how does this loop work? why doesn't it run forever?
-      for(iter = sensor_list.begin(); iter != sensor_list.end();) {
-        if((*iter).gd){
-          delete ((*iter).gd);
-          (*iter).gd = 0;
-        }
-        dGeomDestroy((*iter).geom);
-        sensor_list.erase(iter);
-      }
-      if(myTriMeshData) dGeomTriMeshDataDestroy(myTriMeshData);
+      if(myTriMesh) theWorld->getTriMeshCache()->release(myTriMesh);
+      delete myConvex;
     }
 
     dReal heightfield_callback(void* pUserData, int x, int z ) {
@@ -142,7 +130,7 @@ namespace mars {
               node->pos.z(), euler.alpha, euler.beta, euler.gamma,
               node->mass, node->density);
 #endif
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_WRITE);
       if(theWorld && theWorld->existsWorld()) {
         bool ret;
         //LOG_DEBUG("physicMode %d", node->physicMode);
@@ -151,6 +139,9 @@ namespace mars {
         case NODE_TYPE_MESH:
           ret = createMesh(node);
           break;
+        case NODE_TYPE_CONVEX:
+          ret = createConvex(node);
+          break;
         case NODE_TYPE_BOX:
           ret = createBox(node);
           break;
@@ -198,6 +189,8 @@ namespace mars {
           else
             dGeomSetQuaternion(nGeom, tmp);
         }
+        // geoms without body are never tested against each other
+        if(!nBody) theWorld->makeGeomStatic(nGeom);
         node_data.id = node->index;
         dGeomSetData(nGeom, &node_data);
         locker.unlock();
@@ -224,7 +217,7 @@ namespace mars {
      *     - otherwise the position should be set to zero
      */
     void NodePhysics::getPosition(Vector* pos) const {
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_READ);
       if(nBody) {
         const dReal* tmp = dGeomGetPosition(nGeom);
         pos->x() = (sReal)tmp[0];
@@ -274,7 +267,9 @@ namespace mars {
       const dReal *tpos2;
       dReal npos[3];
       Vector offset;
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_WRITE);
+      // a disabled body would not react to the change
+      if(nBody) dBodyEnable(nBody);
 
       if(composite) {
         if(move_group) {
@@ -330,6 +325,7 @@ namespace mars {
           //offset.y() = pos->y - (sReal)(tpos[1]);
           //offset.z() = pos->z - (sReal)(tpos[2]);
           dGeomSetPosition(nGeom, (dReal)pos.x(), (dReal)pos.y(), (dReal)pos.z());
+          theWorld->staticGeomMoved(nGeom);
           return offset;
         }
       }
@@ -353,7 +349,7 @@ namespace mars {
      */
     void NodePhysics::getRotation(Quaternion* q) const {
       dQuaternion tmp;
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_READ);
 
       if(nBody || nGeom) {
         dGeomGetQuaternion(nGeom, tmp);
@@ -387,7 +383,7 @@ namespace mars {
      */
     void NodePhysics::getLinearVelocity(Vector* vel) const {
       const dReal *tmp;
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_READ);
 
       if(nBody) {
         tmp = dBodyGetLinearVel(nBody);
@@ -419,7 +415,7 @@ namespace mars {
      */
     void NodePhysics::getAngularVelocity(Vector* vel) const {
       const dReal *tmp;
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_READ);
 
       if(nBody) {
         tmp = dBodyGetAngularVel(nBody);
@@ -451,7 +447,7 @@ namespace mars {
      */
     void NodePhysics::getForce(Vector* f) const {
       const dReal *tmp;
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_READ);
 
       if(nBody) {
         tmp = dBodyGetForce(nBody);
@@ -483,7 +479,7 @@ namespace mars {
      */
     void NodePhysics::getTorque(Vector *t) const {
       const dReal *tmp;
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_READ);
 
       if(nBody) {
         tmp = dBodyGetTorque(nBody);
@@ -512,7 +508,8 @@ namespace mars {
       Quaternion q2;
       dMatrix3 R;
       dVector3 pos, new_pos, new2_pos;
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_WRITE);
+      if(nBody) dBodyEnable(nBody);
 
       pos[0] = pos[1] = pos[2] = 0;
       tmp[1] = (dReal)q.x();
@@ -553,6 +550,7 @@ namespace mars {
       else if(nGeom) {
         dGeomGetQuaternion(nGeom, tmp2);
         dGeomSetQuaternion(nGeom, tmp);
+        theWorld->staticGeomMoved(nGeom);
       }
       dQMultiply2(tmp3, tmp, tmp2);
       q2.x() = (sReal)tmp3[1];
@@ -604,8 +602,6 @@ namespace mars {
      *
      */
     bool NodePhysics::createMesh(NodeData* node) {
-      int i;
-
       if (!node->inertia_set && 
           (node->ext.x() <= 0 || node->ext.y() <= 0 || node->ext.z() <= 0)) {
         LOG_ERROR("Cannot create Node \"%s\" (id=%lu):\n"
@@ -616,29 +612,78 @@ namespace mars {
         return false;
       }
 
-      myVertices = (dVector3*)calloc(node->mesh.vertexcount, sizeof(dVector3));
-      myIndices = (dTriIndex*)calloc(node->mesh.indexcount, sizeof(dTriIndex));
       //LOG_DEBUG("%d %d", node->mesh.vertexcount, node->mesh.indexcount);
-      // first we have to copy the mesh data to prevent errors in case
-      // of double to float conversion
-      for(i=0; i<node->mesh.vertexcount; i++) {
-        myVertices[i][0] = (dReal)node->mesh.vertices[i][0];
-        myVertices[i][1] = (dReal)node->mesh.vertices[i][1];
-        myVertices[i][2] = (dReal)node->mesh.vertices[i][2];
+      // nodes with the same mesh share the converted data and only
+      // differ in the transform of their geoms
+      myTriMesh = theWorld->getTriMeshCache()->acquire(node);
+      nGeom = dCreateTriMesh(theWorld->getSpace(), myTriMesh->data, 0, 0, 0);
+
+      // at this moment we set the mass properties as the mass of the
+      // bounding box if no mass and inertia is set by the user
+      if(node->inertia_set) {
+        setInertiaMass(node);
+      }
+      else if(node->density > 0) {
+        dMassSetBox(&nMass, (dReal)node->density, (dReal)node->ext.x(),
+                    (dReal)node->ext.y(),(dReal)node->ext.z());
       }
-      for(i=0; i<node->mesh.indexcount; i++) {
-        myIndices[i] = (dTriIndex)node->mesh.indices[i];
+      else if(node->mass > 0) {
+        dMassSetBoxTotal(&nMass, (dReal)node->mass, (dReal)node->ext.x(),
+                         (dReal)node->ext.y(),(dReal)node->ext.z());
       }
+      return true;
+    }
 
-      // then we can build the ode representation
-      myTriMeshData = dGeomTriMeshDataCreate();
-      dGeomTriMeshDataBuildSimple(myTriMeshData, (dReal*)myVertices,
-                                  node->mesh.vertexcount,
-                                  myIndices, node->mesh.indexcount);
-      nGeom = dCreateTriMesh(theWorld->getSpace(), myTriMeshData, 0, 0, 0);
+    /**
+     * The method creates an ode convex representation of the given node.
+     * The mesh of the node has to be closed and convex with outward facing
+     * triangles, as it is built by the MeshFitter.
+     */
+    bool NodePhysics::createConvex(NodeData* node) {
+      if(!node->mesh.vertices || node->mesh.indexcount < 12 ||
+         (!node->inertia_set &&
+          (node->ext.x() <= 0 || node->ext.y() <= 0 || node->ext.z() <= 0))) {
+        LOG_ERROR("Cannot create Node \"%s\" (id=%lu):\n"
+                  "  Convex Nodes need a closed mesh and ext.x(), ext.y(),"
+                  " and ext.z() > 0.", node->name.c_str(), node->index);
+        return false;
+      }
 
-      // at this moment we set the mass properties as the mass of the
-      // bounding box if no mass and inertia is set by the user
+      const snmesh &mesh = node->mesh;
+      convex_data *convex = new convex_data;
+      convex->points.resize(mesh.vertexcount*3);
+      for(int i=0; i<mesh.vertexcount; ++i) {
+        for(int k=0; k<3; ++k) {
+          convex->points[i*3+k] = (dReal)mesh.vertices[i][k];
+        }
+      }
+      // one plane and one polygon per triangle
+      for(int i=0; i+2<mesh.indexcount; i+=3) {
+        const mydVector3 &a = mesh.vertices[mesh.indices[i]];
+        const mydVector3 &b = mesh.vertices[mesh.indices[i+1]];
+        const mydVector3 &c = mesh.vertices[mesh.indices[i+2]];
+        Vector n = Vector(b[0]-a[0], b[1]-a[1], b[2]-a[2]).cross(
+                     Vector(c[0]-a[0], c[1]-a[1], c[2]-a[2]));
+        if(n.norm() <= 0) continue;
+        n.normalize();
+        convex->planes.push_back((dReal)n.x());
+        convex->planes.push_back((dReal)n.y());
+        convex->planes.push_back((dReal)n.z());
+        convex->planes.push_back((dReal)(n.x()*a[0] + n.y()*a[1] +
+                                         n.z()*a[2]));
+        convex->polygons.push_back(3);
+        for(int k=0; k<3; ++k) {
+          convex->polygons.push_back((unsigned int)mesh.indices[i+k]);
+        }
+      }
+      myConvex = convex;
+      nGeom = dCreateConvex(theWorld->getSpace(), &convex->planes[0],
+                            (unsigned int)(convex->planes.size()/4),
+                            &convex->points[0], (unsigned int)mesh.vertexcount,
+                            &convex->polygons[0]);
+
+      // as for meshes the mass is the one of the bounding box if no mass
+      // and inertia is set by the user
       if(node->inertia_set) {
         setInertiaMass(node);
       }
@@ -796,16 +841,12 @@ namespace mars {
 
     bool NodePhysics::createHeightfield(NodeData* node) {
       dMatrix3 R;
-      unsigned long size;
-      int x, y;
+      // the heights are read from the shared heights of the terrain, which
+      // live as long as the node
       terrain = node->terrain;
-      size = terrain->width*terrain->height;
-      if(!height_data) height_data = (dReal*)calloc(size, sizeof(dReal));
-      for(x=0; x<terrain->height; x++) {
-        for(y=0; y<terrain->width; y++) {
-          height_data[(terrain->height-(x+1))*terrain->width+y] = (dReal)terrain->pixelData[x*terrain->width+y];
-        }
-      }
+      bool tiled = (theWorld->terrain_tile_size > 0 && !node->movable &&
+                    terrain->width > 1 && terrain->height > 1);
+      destroyTiledHeightfield();
       // build the ode representation
       dHeightfieldDataID heightid = dGeomHeightfieldDataCreate();
 
@@ -821,13 +862,26 @@ namespace mars {
       dGeomHeightfieldDataSetBounds(heightid, REAL(-terrain->scale*2.0),
                                     REAL(terrain->scale*2.0));
       //dGeomHeightfieldDataSetBounds(heightid, -terrain->scale, terrain->scale);
-      nGeom = dCreateHeightfield(theWorld->getSpace(), heightid, 1);
+      // a tiled terrain only uses the geom as the frame of its tiles
+      nGeom = dCreateHeightfield(tiled ? 0 : theWorld->getSpace(), heightid, 1);
       dRSetIdentity(R);
       dRFromAxisAndAngle(R, 1, 0, 0, M_PI/2);
       dGeomSetRotation(nGeom, R);
+      if(tiled) {
+        tiledHeightfield = new TiledHeightfield(theWorld, this, terrain, nGeom,
+                                                theWorld->terrain_tile_size);
+        theWorld->addTiledHeightfield(tiledHeightfield);
+      }
       return true;
     }
 
+    void NodePhysics::destroyTiledHeightfield(void) {
+      if(!tiledHeightfield) return;
+      theWorld->removeTiledHeightfield(tiledHeightfield);
+      delete tiledHeightfield;
+      tiledHeightfield = 0;
+    }
+
     /**
      * This method sets some properties for the node. The properties includes
      * the posistion, the rotation, the movability and the coposite group number
@@ -855,6 +909,27 @@ namespace mars {
       //dBodySetAngularDamping(nBody, 0.5);
       dGeomSetBody(nGeom, nBody);
 
+      // the body created from the world uses the global auto disable
+      // parameters; negative values of the node keep them
+      if(node->auto_disable >= 0) {
+        node_data.auto_disable_set = true;
+        dBodySetAutoDisableFlag(nBody, node->auto_disable);
+        if(node->auto_disable_linear >= 0) {
+          dBodySetAutoDisableLinearThreshold(nBody,
+                                             (dReal)node->auto_disable_linear);
+        }
+        if(node->auto_disable_angular >= 0) {
+          dBodySetAutoDisableAngularThreshold(nBody,
+                                              (dReal)node->auto_disable_angular);
+        }
+        if(node->auto_disable_steps >= 0) {
+          dBodySetAutoDisableSteps(nBody, node->auto_disable_steps);
+        }
+        if(node->auto_disable_time >= 0) {
+          dBodySetAutoDisableTime(nBody, (dReal)node->auto_disable_time);
+        }
+      }
+
       // if a new body was created, we have to set the initial position
       // and rotation of the body, otherwise have to set the position
       // and rotation of the geom
@@ -902,7 +977,8 @@ namespace mars {
       dVector3 pos, new_pos;
       Vector npos;
       dMatrix3 R;
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_WRITE);
+      if(nBody) dBodyEnable(nBody);
   
       tmp[1] = (dReal)rotation.x();
       tmp[2] = (dReal)rotation.y();
@@ -973,6 +1049,7 @@ namespace mars {
         npos.y() = new_pos[1] + (dReal)rotation_point.y();
         npos.z() = new_pos[2] + (dReal)rotation_point.z();
         dGeomSetPosition(nGeom, (dReal)npos.x(), (dReal)npos.y(), (dReal)npos.z());
+        theWorld->staticGeomMoved(nGeom);
         return npos;
       }
       return npos;
@@ -1000,7 +1077,7 @@ namespace mars {
               node->pos.z(), euler.alpha, euler.beta, euler.gamma,
               node->mass, node->density);
 #endif
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_WRITE);
 
       if(nGeom && theWorld && theWorld->existsWorld()) {
         if(composite) {
@@ -1013,12 +1090,19 @@ namespace mars {
         // deferre destruction of geom until after the successful creation of 
         // a new geom
         dGeomID tmpGeomId = nGeom;
+        TriMeshCache::TriMesh *tmpTriMesh = myTriMesh;
+        convex_data *tmpConvex = myConvex;
+        myTriMesh = 0;
+        myConvex = 0;
         // first we create a ode geometry for the node
         bool success = false;
         switch(node->physicMode) {
         case NODE_TYPE_MESH:
           success = createMesh(node);
           break;
+        case NODE_TYPE_CONVEX:
+          success = createConvex(node);
+          break;
         case NODE_TYPE_BOX:
           success = createBox(node);
           break;
@@ -1040,10 +1124,14 @@ namespace mars {
           break;
         }
         if(!success) {
+          myTriMesh = tmpTriMesh;
+          myConvex = tmpConvex;
           fprintf(stderr, "creation of body geometry failed.\n");
           return 0;
         }
-        dGeomDestroy(tmpGeomId);
+        theWorld->destroyGeom(tmpGeomId);
+        if(tmpTriMesh) theWorld->getTriMeshCache()->release(tmpTriMesh);
+        delete tmpConvex;
         // now the geom is rebuild and we have to reconnect it to the body
         // and reset the mass of the body
         if(nBody) {
@@ -1059,6 +1147,9 @@ namespace mars {
             theWorld->resetCompositeMass(nBody);
           }
         }
+        else {
+          theWorld->makeGeomStatic(nGeom);
+        }
         dGeomSetData(nGeom, &node_data);
         locker.unlock();
         setContactParams(node->c_params);
@@ -1088,7 +1179,8 @@ namespace mars {
      *      - the linear velocity of the body should be set
      */
     void NodePhysics::setLinearVelocity(const Vector &velocity) {
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_WRITE);
+      if(nBody && !velocity.isZero()) dBodyEnable(nBody);
       if(nBody) dBodySetLinearVel(nBody, (dReal)velocity.x(),
                                   (dReal)velocity.y(), (dReal)velocity.z());
     }
@@ -1103,7 +1195,8 @@ namespace mars {
      *      - the angular velocity of the body should be set
      */
     void NodePhysics::setAngularVelocity(const Vector &velocity) {
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_WRITE);
+      if(nBody && !velocity.isZero()) dBodyEnable(nBody);
       if(nBody) dBodySetAngularVel(nBody, (dReal)velocity.x(),
                                    (dReal)velocity.y(), (dReal)velocity.z());
     }
@@ -1118,7 +1211,8 @@ namespace mars {
      *      - the force of the body should be set
      */
     void NodePhysics::setForce(const Vector &f) {
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_WRITE);
+      if(nBody && !f.isZero()) dBodyEnable(nBody);
       if(nBody) dBodySetForce(nBody, (dReal)f.x(),
                               (dReal)f.y(), (dReal)f.z());
     }
@@ -1133,7 +1227,8 @@ namespace mars {
      *      - the torque of the body should be set
      */
     void NodePhysics::setTorque(const Vector &t) {
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_WRITE);
+      if(nBody && !t.isZero()) dBodyEnable(nBody);
       if(nBody) dBodySetTorque(nBody, (dReal)t.x(),
                                (dReal)t.y(), (dReal)t.z());
     }
@@ -1148,7 +1243,8 @@ namespace mars {
      *      - the force should be added to the body
      */
     void NodePhysics::addForce(const Vector &f, const Vector &p) {
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_WRITE);
+      if(nBody && !f.isZero()) dBodyEnable(nBody);
       if(nBody) {
         dBodyAddForceAtPos(nBody, 
                            (dReal)f.x(), (dReal)f.y(), (dReal)f.z(),
@@ -1165,7 +1261,8 @@ namespace mars {
      *      - the force should be added to the body
      */
     void NodePhysics::addForce(const Vector &f) {
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_WRITE);
+      if(nBody && !f.isZero()) dBodyEnable(nBody);
       if(nBody) {
         dBodyAddForce(nBody, (dReal)f.x(), (dReal)f.y(), (dReal)f.z());
       }
@@ -1181,20 +1278,29 @@ namespace mars {
      *      - the torque should be added to the body
      */
     void NodePhysics::addTorque(const Vector &t) {
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_WRITE);
+      if(nBody && !t.isZero()) dBodyEnable(nBody);
       if(nBody) dBodyAddTorque(nBody, (dReal)t.x(), (dReal)t.y(), (dReal)t.z());
     }
 
     bool NodePhysics::getGroundContact(void) const {
-      if(nGeom) {
+      if(nGeom && hasContacts()) {
         return node_data.num_ground_collisions;
       }
       return false;
     }
 
+    /**
+     * \brief Returns true if the contacts of the node belong to the last
+     * collision step of the world.
+     */
+    bool NodePhysics::hasContacts(void) const {
+      return node_data.hasContacts(theWorld->getContactGeneration());
+    }
+
     void NodePhysics::getContactPoints(std::vector<Vector> *contact_points) const {
       contact_points->clear();
-      if(nGeom) {
+      if(nGeom && hasContacts()) {
         std::vector<Vector>::const_iterator iter;
 
         for(iter=node_data.contact_points.begin();
@@ -1206,8 +1312,9 @@ namespace mars {
 
     void NodePhysics::getContactIDs(std::list<interfaces::NodeId> *ids) const {
       ids->clear();
-      if(nGeom) {
-        *ids = node_data.contact_ids;
+      if(nGeom && hasContacts()) {
+        ids->assign(node_data.contact_ids.begin(),
+                    node_data.contact_ids.end());
       }
     }
 
@@ -1216,7 +1323,7 @@ namespace mars {
       std::vector<dJointFeedback*>::const_iterator iter;
       dReal force[3] = {0,0,0};
 
-      if(nGeom) {
+      if(nGeom && hasContacts()) {
         for(iter = node_data.ground_feedbacks.begin();
             iter != node_data.ground_feedbacks.end(); iter++) {
           if(node_data.node1) {
@@ -1238,7 +1345,7 @@ namespace mars {
       std::vector<dJointFeedback*>::const_iterator iter;
       dReal force[3] = {0,0,0};
 
-      if(nGeom) {
+      if(nGeom && hasContacts()) {
         for(iter = node_data.ground_feedbacks.begin();
             iter != node_data.ground_feedbacks.end(); iter++) {
           if(node_data.node1) {
@@ -1301,17 +1408,18 @@ namespace mars {
     }
 
     dReal NodePhysics::heightCallback(int x, int y) {
-
-      return (dReal)height_data[(y*terrain->width)+x]*terrain->scale;
+      // the rows of the heights start at the far end of the heightfield
+      return (dReal)terrain->heights->get(x, terrain->height-1-y)*terrain->scale;
     }
 
     void NodePhysics::setContactParams(contact_params& c_params) {
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_WRITE);
       node_data.c_params = c_params;
       if(nGeom) {
         dGeomSetCollideBits(nGeom, c_params.coll_bitmask);
         dGeomSetCategoryBits(nGeom, c_params.coll_bitmask);
       }
+      if(tiledHeightfield) tiledHeightfield->updateCollideBits();
     }
 
     /**
@@ -1321,23 +1429,18 @@ namespace mars {
      *
      * pre:
      *     - the BaseSensor should contain a complete and correct configuration
-     *     - the world have to exists because geoms have to be created
      *     - this Node should have an existing geom
      *
      * post:
-     *     - every new sensor has to be added to a list
-     *     - the memory for the sensor data has to be allocated
-     *     - the physical elements for the sensor had to be created
+     *     - every ray of the new sensor has to be added to a list
+     *     - the rays are cast by the RayCaster of the world, no geoms are
+     *       created for them
      */
     void NodePhysics::addSensor(BaseSensor* sensor) {
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_WRITE);
       int i;
-      geom_data* gd;
       sensor_list_element sle;
-      const dReal *pos = dGeomGetPosition(nGeom);
-      const dReal *rot = dGeomGetRotation(nGeom);
       Vector direction;
-      dVector3 dest, tmp;
       //sReal rad_angle, rad_steps, rad_start;
       double rad_steps, rad_start;
 
@@ -1349,8 +1452,6 @@ namespace mars {
       if(polarSensor){
         sle.sensor = sensor;
         sle.updateTime = 0.0;
-        //sensor.count_data = sensor.resolution;
-        //sensor.data = (sReal*)malloc(sensor.resolution * sizeof(sReal));
    
         mars::sim::RotatingRaySensor* rotRaySensor = dynamic_cast<RotatingRaySensor*>(sensor);
         if(rotRaySensor){
@@ -1360,33 +1461,12 @@ namespace mars {
             
             // Requests and adds the single rays using the local sensor frame.
             for(i=0; i<N; i++){
-                gd = new geom_data;
-                (*gd).setZero();
-                gd->sense_contact_force = 0;
-                (*polarSensor)[i] = gd->value = polarSensor->maxDistance;//sensor.max_distance;
-                gd->ray_sensor = 1;
-                gd->parent_geom = nGeom;
-                gd->parent_body = nBody;
-                sle.geom = dCreateRay(NULL, polarSensor->maxDistance);
-                dGeomSetCollideBits(sle.geom, 32768);
-                dGeomSetCategoryBits(sle.geom, 32768);
-                
+                (*polarSensor)[i] = polarSensor->maxDistance;
                 // Use the precalculated ray directions of the sensor. 
                 direction = /*polarSensor->getOrientation() **/ directions[i];
                 sle.ray_direction = direction;
-                tmp[0] = direction.x();
-                tmp[1] = direction.y();
-                tmp[2] = direction.z();
-                dMULTIPLY0_331(dest, rot, tmp);
-                dGeomRaySet(sle.geom, pos[0], pos[1], pos[2], dest[0], dest[1], dest[2]);
-                sle.gd = gd;
                 sle.index = i;
                 sensor_list.push_back(sle);
-                dGeomSetData(sle.geom, gd);
-                //dGeomRaySetParams(sle.geom, 1, 1);
-                dGeomSetCollideBits(sle.geom, COLLIDE_MASK_SENSOR);
-                dGeomSetCategoryBits(sle.geom, COLLIDE_MASK_SENSOR);
-                dGeomDisable(sle.geom);
             }
         } else {
             //rad_angle = polarSensor->widthX*; //M_PI*sensor.flare_angle/180;
@@ -1396,35 +1476,14 @@ namespace mars {
               rad_start = 0;
             }
             for(i=0; i<rad_steps; i++) {
-              gd = new geom_data;
-              (*gd).setZero();
-              gd->sense_contact_force = 0;
-              (*polarSensor)[i] = gd->value = polarSensor->maxDistance;//sensor.max_distance;
-
-              gd->ray_sensor = 1;
-              gd->parent_geom = nGeom;
-              gd->parent_body = nBody;
-              sle.geom = dCreateRay(NULL, polarSensor->maxDistance);
-              dGeomSetCollideBits(sle.geom, 32768);
-              dGeomSetCategoryBits(sle.geom, 32768);
+              (*polarSensor)[i] = polarSensor->maxDistance;
               direction = Vector(cos(rad_start+i*polarSensor->stepX),
                                  sin(rad_start+i*polarSensor->stepX), 0);
               //direction = QVRotate(sensor.rotation, direction);
               direction = (polarSensor->getOrientation() * direction);
               sle.ray_direction = direction;
-              tmp[0] = direction.x();
-              tmp[1] = direction.y();
-              tmp[2] = direction.z();
-              dMULTIPLY0_331(dest, rot, tmp);
-              dGeomRaySet(sle.geom, pos[0], pos[1], pos[2], dest[0], dest[1], dest[2]);
-              sle.gd = gd;
               sle.index = i;
               sensor_list.push_back(sle);
-              dGeomSetData(sle.geom, gd);
-              //dGeomRaySetParams(sle.geom, 1, 1);
-              dGeomSetCollideBits(sle.geom, COLLIDE_MASK_SENSOR);
-              dGeomSetCategoryBits(sle.geom, COLLIDE_MASK_SENSOR);
-              dGeomDisable(sle.geom);
             }
         }
       }
@@ -1436,47 +1495,22 @@ namespace mars {
         sle.sensor = sensor;
         sle.updateTime = 0.0;
         int cols, rows;
-        dVector3 dir={0,0,0,0}, xStep={0,0,0,0}, 
-            yStep={0,0,0,0}, xOffset={0,0,0,0}, yOffset={0,0,0,0};
+        dVector3 xStep={0,0,0,0}, yStep={0,0,0,0},
+            xOffset={0,0,0,0}, yOffset={0,0,0,0};
 
         cols = polarGridSensor->getCols();
         rows = polarGridSensor->getRows();
-    
-        tmp[0] = 0;
-        tmp[1] = 0;
-        tmp[2] = -1;
-        dMULTIPLY0_331(dir, rot, tmp);
-        tmp[0] = polarGridSensor->stepX;
-        tmp[1] = 0;
-        tmp[2] = 0;
-        //dMULTIPLY0_331(xStep, rot, tmp);
-        tmp[0] = 0;
-        tmp[1] = polarGridSensor->stepY;
-        tmp[2] = 0;
-        //dMULTIPLY0_331(yStep, rot, tmp);
+        //xStep = rot * (polarGridSensor->stepX, 0, 0);
+        //yStep = rot * (0, polarGridSensor->stepY, 0);
 
+        direction = (polarGridSensor->getOrientation() *
+                     Vector(0.0, 0.0, -1.0));
+        sle.ray_direction = direction;
 
         for(int x=0; x<cols; x++) {
           for(int y=0; y<rows; y++) {
-            gd = new geom_data;
-            (*gd).setZero();
-            gd->sense_contact_force = 0;
-            (*polarGridSensor)[y*cols+x] = gd->value = polarGridSensor->maxDistance;
-      
-            gd->ray_sensor = 1;
-            gd->parent_geom = nGeom;
-            sle.geom = dCreateRay(theWorld->getSpace(),
-                                  polarGridSensor->maxDistance);
-            dGeomSetCollideBits(sle.geom, 32768);
-            dGeomSetCategoryBits(sle.geom, 32768);
-        
-            direction = (polarGridSensor->getOrientation() *
-                         Vector(0.0, 0.0, -1.0));
-            sle.ray_direction = direction;
-            tmp[0] = direction.x();
-            tmp[1] = direction.y();
-            tmp[2] = direction.z();
-            dMULTIPLY0_331(dest, rot, tmp);
+            (*polarGridSensor)[y*cols+x] = polarGridSensor->maxDistance;
+
             xOffset[0] =  -cols*0.5*xStep[0] + x*xStep[0];
             xOffset[1] =  -cols*0.5*xStep[1] + x*xStep[1];
             xOffset[2] =  -cols*0.5*xStep[2] + x*xStep[2];
@@ -1489,37 +1523,40 @@ namespace mars {
             sle.ray_pos_offset.y() = xOffset[1] + yOffset[1];
             sle.ray_pos_offset.z() = xOffset[2] + yOffset[2];
 
-            dGeomRaySet(sle.geom, pos[0] + xOffset[0] + yOffset[0],
-                        pos[1] + xOffset[1] + yOffset[1],
-                        pos[2]  + xOffset[2] + yOffset[2],
-                        dest[0], dest[1], dest[2]);
-            sle.gd = gd;
             sle.index = y*cols+x;
             sensor_list.push_back(sle);      
-            dGeomSetData(sle.geom, gd);
-            //dGeomRaySetParams(sle.geom, 1, 1);      
-            dGeomSetCollideBits(sle.geom, COLLIDE_MASK_SENSOR);
-            dGeomSetCategoryBits(sle.geom, COLLIDE_MASK_SENSOR);
-            dGeomDisable(sle.geom);
-        
           }
         }
       }
+      updateSensorRange();
     }
 
     void NodePhysics::removeSensor(BaseSensor *sensor) {
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_WRITE);
       std::vector<sensor_list_element>::iterator iter;
       for (iter = sensor_list.begin(); iter != sensor_list.end(); ) {
         if (iter->sensor == sensor) {
-          free(iter->gd);
-          dGeomDestroy(iter->geom);
           iter = sensor_list.erase(iter);
         } else
           ++iter;
       }
+      updateSensorRange();
     }
 
+    void NodePhysics::updateSensorRange(void) {
+      node_data.sensor_range = 0;
+      std::vector<sensor_list_element>::iterator iter;
+      for(iter = sensor_list.begin(); iter != sensor_list.end(); ++iter) {
+        double range = 0;
+        BasePolarIntersectionSensor *polarSensor;
+        BaseGridIntersectionSensor *gridSensor;
+        polarSensor = dynamic_cast<BasePolarIntersectionSensor*>(iter->sensor);
+        gridSensor = dynamic_cast<BaseGridIntersectionSensor*>(iter->sensor);
+        if(polarSensor) range = polarSensor->maxDistance;
+        else if(gridSensor) range = gridSensor->maxDistance;
+        if(range > node_data.sensor_range) node_data.sensor_range = range;
+      }
+    }
     /**
      * \brief This function copies all sensor values to the specific allocated
      *  memory
@@ -1530,14 +1567,14 @@ namespace mars {
      */
     void NodePhysics::handleSensorData(bool physics_thread) {
       if(!physics_thread) return;
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_READ);
+      // the nodes may be updated by the threads of the update pipeline
+      theWorld->makeCurrent();
       std::vector<sensor_list_element>::iterator iter;
       const dReal* pos = dGeomGetPosition(nGeom);
       const dReal* rot = dGeomGetRotation(nGeom);
       dVector3 dest, tmp, posOffset;
-      dReal steps_size = 1.0, length = 0.0;
-      bool done = false;
-      int steps = 0;
+      RayCaster::Ray ray;
       dReal worldStep = theWorld->getWorldStep();
       // RotatingRaySensor
       utils::Vector tmpV;
@@ -1545,6 +1582,12 @@ namespace mars {
       turnrotation.setIdentity();
       std::set<unsigned long> ids_rotating_ray_sensors;
 
+      // the rays are cast by the world after all nodes are updated and
+      // write their distances directly into the sensor arrays
+      sensor_rays.clear();
+      ray.ignoreGeom = nGeom;
+      ray.ignoreBody = nBody;
+
       //New Code
       int i=0;
       for(iter = sensor_list.begin(); iter != sensor_list.end(); iter++) {
@@ -1581,36 +1624,13 @@ namespace mars {
           tmp[2] = tmpV.z();//elem.ray_direction.z();
           dMULTIPLY0_331(dest, rot, tmp);
 
-          if(physics_thread) {
-            steps = 0;
-            length = 0.0;
-            done = false;
-            dGeomEnable(elem.geom);
-            // make here the collision check
-            while (!done) {
-              dGeomRaySet(elem.geom,
-                          pos[0] + dest[0]*steps_size*steps,
-                          pos[1] + dest[1]*steps_size*steps,
-                          pos[2] + dest[2]*steps_size*steps,
-                          dest[0], dest[1], dest[2]);
-              if(length + steps_size < polarSensor->maxDistance) {
-                steps++;
-                dGeomRaySetLength(elem.geom, steps_size);
-              }
-              else {
-                dGeomRaySetLength(elem.geom, polarSensor->maxDistance- length);
-                done = true;
-              }
-              if(theWorld->handleCollision(elem.geom)) {
-                elem.gd->value += length;
-                done = true;
-              }
-              if(!done) length = steps_size*steps;
-            }
-            dGeomDisable(elem.geom);
+          for(int k=0; k<3; k++) {
+            ray.origin[k] = pos[k];
+            ray.direction[k] = dest[k];
           }
-          (*polarSensor)[elem.index] = elem.gd->value;
-          elem.gd->value = polarSensor->maxDistance;
+          ray.length = polarSensor->maxDistance;
+          ray.result = &(*polarSensor)[elem.index];
+          sensor_rays.push_back(ray);
         }
     
         BaseGridIntersectionSensor *polarGridSensor;
@@ -1619,33 +1639,26 @@ namespace mars {
         if(polarGridSensor) {
           sensor_list_element elem = *iter;
 
-          if(physics_thread) {
-        
-            tmp[0] = elem.ray_direction.x();
-            tmp[1] = elem.ray_direction.y();
-            tmp[2] = elem.ray_direction.z();
-            dMULTIPLY0_331(dest, rot, tmp);
-
-            tmp[0] = elem.ray_pos_offset.x();
-            tmp[1] = elem.ray_pos_offset.y();
-            tmp[2] = elem.ray_pos_offset.z();
-            dMULTIPLY0_331(posOffset, rot, tmp);
-
-            dGeomEnable(elem.geom);
-
-            dGeomRaySet(elem.geom, pos[0] + posOffset[0],
-                        pos[1] + posOffset[1],
-                        pos[2] + posOffset[2],
-                        dest[0], dest[1], dest[2]);
-
-            dGeomRaySetLength(elem.geom, polarGridSensor->maxDistance);
-            theWorld->handleCollision(elem.geom);
-            dGeomDisable(elem.geom);        
+          tmp[0] = elem.ray_direction.x();
+          tmp[1] = elem.ray_direction.y();
+          tmp[2] = elem.ray_direction.z();
+          dMULTIPLY0_331(dest, rot, tmp);
+
+          tmp[0] = elem.ray_pos_offset.x();
+          tmp[1] = elem.ray_pos_offset.y();
+          tmp[2] = elem.ray_pos_offset.z();
+          dMULTIPLY0_331(posOffset, rot, tmp);
+
+          for(int k=0; k<3; k++) {
+            ray.origin[k] = pos[k] + posOffset[k];
+            ray.direction[k] = dest[k];
           }
-          (*polarGridSensor)[elem.index] = elem.gd->value;
-          elem.gd->value = polarGridSensor->maxDistance;      
+          ray.length = polarGridSensor->maxDistance;
+          ray.result = &(*polarGridSensor)[elem.index];
+          sensor_rays.push_back(ray);
         }
       } // end for loop.
+      if(!sensor_rays.empty()) theWorld->addRays(sensor_rays);
     }
 
     /**
@@ -1656,24 +1669,21 @@ namespace mars {
      * post:
      */
     void NodePhysics::destroyNode(void) {
-      MutexLocker locker(&(theWorld->iMutex));
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_WRITE);
       if(nBody) theWorld->destroyBody(nBody, this);
 
-      if(nGeom) dGeomDestroy(nGeom);
+      destroyTiledHeightfield();
+      if(nGeom) theWorld->destroyGeom(nGeom);
 
-      if(myVertices) free(myVertices);
-      if(myIndices) free(myIndices);
-      if(myTriMeshData) dGeomTriMeshDataDestroy(myTriMeshData);
+      if(myTriMesh) theWorld->getTriMeshCache()->release(myTriMesh);
 
       nBody = 0;
       nGeom = 0;
-      myVertices = 0;
-      myIndices = 0;
-      myTriMeshData = 0;
+      myTriMesh = 0;
       composite = false;
       //node_data.num_ground_collisions = 0;
       node_data.setZero();
-      height_data = 0;
+      terrain = 0;
     }
 
     void NodePhysics::setInertiaMass(NodeData* node) {
@@ -1718,5 +1728,47 @@ namespace mars {
       return 0.0;
     }
 
+    bool NodePhysics::getBodyState(sReal *state) const {
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_READ);
+      if(!nBody) return false;
+
+      const dReal *pos = dBodyGetPosition(nBody);
+      const dReal *rot = dBodyGetQuaternion(nBody);
+      const dReal *lVel = dBodyGetLinearVel(nBody);
+      const dReal *aVel = dBodyGetAngularVel(nBody);
+      for(int i=0; i<3; ++i) {
+        state[i] = (sReal)pos[i];
+        state[7+i] = (sReal)lVel[i];
+        state[10+i] = (sReal)aVel[i];
+      }
+      for(int i=0; i<4; ++i) {
+        state[3+i] = (sReal)rot[i];
+      }
+      state[13] = dBodyIsEnabled(nBody) ? 1 : 0;
+      return true;
+    }
+
+    void NodePhysics::setBodyState(const sReal *state) {
+      ReadWriteLocker locker(&(theWorld->iMutex), READWRITELOCK_MODE_WRITE);
+      if(!nBody) return;
+
+      dQuaternion rot = {(dReal)state[3], (dReal)state[4],
+                         (dReal)state[5], (dReal)state[6]};
+      // the geoms of composite objects follow the body
+      dBodySetPosition(nBody, (dReal)state[0], (dReal)state[1],
+                       (dReal)state[2]);
+      dBodySetQuaternion(nBody, rot);
+      dBodySetLinearVel(nBody, (dReal)state[7], (dReal)state[8],
+                        (dReal)state[9]);
+      dBodySetAngularVel(nBody, (dReal)state[10], (dReal)state[11],
+                         (dReal)state[12]);
+      dBodySetForce(nBody, 0, 0, 0);
+      dBodySetTorque(nBody, 0, 0, 0);
+      // sleeping bodies stay asleep, otherwise the run diverges from the
+      // one the state was taken from
+      if(state[13] != 0) dBodyEnable(nBody);
+      else dBodyDisable(nBody);
+    }
+
   } // end of namespace sim
 } // end of namespace mars
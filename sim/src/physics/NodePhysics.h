@@ -33,13 +33,10 @@
 #endif
 
 #include "WorldPhysics.h"
+#include "TiledHeightfield.h"
 
 #include <mars/interfaces/sim/NodeInterface.h>
 
-#ifndef ODE11
-  #define dTriIndex int
-#endif
-
 namespace mars {
   namespace sim {
 
@@ -51,8 +48,11 @@ namespace mars {
     struct geom_data {
       void setZero(){
         num_ground_collisions = 0;
+        contact_generation = 0;
         ray_sensor = 0;
         sense_contact_force = 1;
+        auto_disable_set = false;
+        sensor_range = 0;
         value = 0;
         c_params.setZero();
       }
@@ -60,30 +60,65 @@ namespace mars {
       geom_data(){
         setZero();
       }
+
+      /**
+       * \brief The contacts are only valid in the collision step they
+       * were created in. Instead of clearing the contacts of all geoms
+       * before each step, the contacts of a geom are cleared when it gets
+       * its first contact of a newer step.
+       */
+      void beginContacts(unsigned long generation) {
+        if(contact_generation != generation) {
+          num_ground_collisions = 0;
+          contact_points.clear();
+          contact_ids.clear();
+          ground_feedbacks.clear();
+          contact_generation = generation;
+        }
+      }
+
+      bool hasContacts(unsigned long generation) const {
+        return contact_generation == generation;
+      }
+
       unsigned long id;
+      unsigned long contact_generation;
       int num_ground_collisions;
       std::vector<utils::Vector> contact_points;
-      std::list<unsigned long> contact_ids;
+      std::vector<unsigned long> contact_ids;
       std::vector<dJointFeedback*> ground_feedbacks;
       bool node1;
       interfaces::contact_params c_params;
       bool ray_sensor;
       bool sense_contact_force;
+      /// the body uses the auto disable parameters of its node
+      bool auto_disable_set;
       interfaces::sReal value;
+      /// the longest ray of the sensors of the node, the terrain tiles are
+      /// activated up to this distance around the geom
+      dReal sensor_range;
       dGeomID parent_geom;
       dBodyID parent_body;
     };
 
     struct sensor_list_element {
       interfaces::BaseSensor *sensor;
-      geom_data *gd;
-      dGeomID geom;
       utils::Vector ray_direction;
       utils::Vector ray_pos_offset;
       unsigned int index;
       dReal updateTime;
     };
 
+    /**
+     * \brief The arrays of a convex geom; ODE does not copy them, thus they
+     * have to live as long as the geom.
+     */
+    struct convex_data {
+      std::vector<dReal> planes;
+      std::vector<dReal> points;
+      std::vector<unsigned int> polygons;
+    };
+
     /**
      * The class that implements the NodeInterface interface.
      *
@@ -125,6 +160,8 @@ namespace mars {
       virtual void getMass(interfaces::sReal *mass, interfaces::sReal *inertia=0) const;
       virtual const utils::Vector getContactForce(void) const;
       virtual interfaces::sReal getCollisionDepth(void) const;
+      virtual bool getBodyState(interfaces::sReal *state) const;
+      virtual void setBodyState(const interfaces::sReal *state);
       void addCompositeOffset(dReal x, dReal y, dReal z);
       ///return the body; this function is created to make it possible to get the 
       ///body from joint physics s
@@ -139,23 +176,27 @@ namespace mars {
       dBodyID nBody;
       dGeomID nGeom;
       dMass nMass;
-      dVector3 *myVertices;
-      dTriIndex *myIndices;
-      dTriMeshDataID myTriMeshData;
+      TriMeshCache::TriMesh *myTriMesh;
+      convex_data *myConvex;
       bool composite;
       geom_data node_data;
       interfaces::terrainStruct *terrain;
-      dReal *height_data;
+      TiledHeightfield *tiledHeightfield;
       std::vector<sensor_list_element> sensor_list;
+      std::vector<RayCaster::Ray> sensor_rays;
       bool createMesh(interfaces::NodeData *node);
+      bool createConvex(interfaces::NodeData *node);
       bool createBox(interfaces::NodeData *node);
       bool createSphere(interfaces::NodeData *node);
       bool createCapsule(interfaces::NodeData *node);
       bool createCylinder(interfaces::NodeData *node);
       bool createPlane(interfaces::NodeData *node);
       bool createHeightfield(interfaces::NodeData *node);
+      void destroyTiledHeightfield(void);
       void setProperties(interfaces::NodeData *node);
       void setInertiaMass(interfaces::NodeData *node);
+      void updateSensorRange(void);
+      bool hasContacts(void) const;
     };
 
   } // end of namespace sim
@@ -0,0 +1,226 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+ /**
+ * \file RayCaster.cpp
+ * \author agent
+ * \brief "RayCaster" casts the rays of all ray based sensors of a step
+ * as one batch.
+ *
+ */
+
+#include "RayCaster.h"
+#include "StaticBVH.h"
+#include "NodePhysics.h"
+#include "WorldPhysics.h"
+
+#include <mars/utils/MutexLocker.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace mars {
+  namespace sim {
+
+    using namespace utils;
+    using namespace interfaces;
+
+    /**
+     * \brief Intersects the ray with an axis aligned box.
+     * \returns false if the box is not hit within the length of the ray,
+     *          otherwise the distance to the entry point is set.
+     */
+    static bool rayBoxEntry(const RayCaster::Ray &ray, const dReal *aabb,
+                            dReal *entry) {
+      dReal tmin = 0.0, tmax = ray.length;
+      for(int k=0; k<3; k++) {
+        dReal low = aabb[k*2], high = aabb[k*2+1];
+        if(std::fabs(ray.direction[k]) < 1e-12) {
+          if(ray.origin[k] < low || ray.origin[k] > high) return false;
+          continue;
+        }
+        dReal inv = 1.0 / ray.direction[k];
+        dReal t1 = (low - ray.origin[k]) * inv;
+        dReal t2 = (high - ray.origin[k]) * inv;
+        if(t1 > t2) std::swap(t1, t2);
+        if(t1 > tmin) tmin = t1;
+        if(t2 < tmax) tmax = t2;
+        if(tmin > tmax) return false;
+      }
+      *entry = tmin;
+      return true;
+    }
+
+    // rays per range of the parallel narrowphase
+    static const size_t minRaysPerTask = 32;
+
+    RayCaster::RayCaster(WorldPhysics *world)
+      : world(world), threadPool(NULL), staticBVH(NULL), numRays(0),
+        currentRay(NULL) {
+      rayGeom = acquireRayGeom();
+    }
+
+    RayCaster::~RayCaster() {
+      for(size_t i=0; i<allRayGeoms.size(); ++i) {
+        dGeomDestroy(allRayGeoms[i]);
+      }
+    }
+
+    void RayCaster::setThreadPool(ThreadPool *pool) {
+      MutexLocker locker(&mutex);
+      threadPool = pool;
+    }
+
+    void RayCaster::addRays(const std::vector<Ray> &rays) {
+      MutexLocker locker(&mutex);
+      this->rays.insert(this->rays.end(), rays.begin(), rays.end());
+    }
+
+    void RayCaster::collectCandidates(dSpaceID space,
+                                      const StaticBVH *staticBVH) {
+      MutexLocker locker(&mutex);
+      this->staticBVH = staticBVH;
+      candidates.clear();
+      candidateBegin.clear();
+      for(size_t i=0; i<rays.size(); ++i) {
+        const Ray &ray = rays[i];
+        setRayGeom(rayGeom, ray);
+        size_t begin = candidates.size();
+        candidateBegin.push_back(begin);
+        currentRay = &ray;
+        // one broadphase query for the whole ray
+        if(space) {
+          dSpaceCollide2(rayGeom, (dGeomID)space, this,
+                         &RayCaster::collectCallback);
+        }
+        currentRay = NULL;
+        std::sort(candidates.begin()+begin, candidates.end());
+      }
+      candidateBegin.push_back(candidates.size());
+    }
+
+    void RayCaster::castCandidates(void) {
+      MutexLocker locker(&mutex);
+      if(candidateBegin.empty()) return;
+      // rays added after collectCandidates() are cast with the next batch
+      size_t count = candidateBegin.size()-1;
+#ifdef ODE11
+      if(threadPool) {
+        threadPool->parallelFor(count, this, minRaysPerTask);
+      }
+      else {
+        runRange(0, count);
+      }
+#else
+      // without thread local collision data ODE is not thread safe
+      runRange(0, count);
+#endif
+      rays.erase(rays.begin(), rays.begin()+count);
+      candidateBegin.clear();
+      staticBVH = NULL;
+      numRays = count;
+    }
+
+    void RayCaster::runRange(size_t begin, size_t end) {
+      // the pool threads need their own ODE collision data
+      world->makeCurrent();
+      dGeomID geom = acquireRayGeom();
+      dContactGeom contact;
+      for(size_t i=begin; i<end; ++i) {
+        const Ray &ray = rays[i];
+        setRayGeom(geom, ray);
+        // the narrowphase in the order of the boxes along the ray
+        dReal nearest = ray.length;
+        for(size_t c=candidateBegin[i]; c<candidateBegin[i+1]; ++c) {
+          if(candidates[c].entry >= nearest) break;
+          if(dCollide(geom, candidates[c].geom, 1, &contact,
+                      sizeof(dContactGeom))) {
+            if(contact.depth < nearest) nearest = contact.depth;
+          }
+        }
+        if(staticBVH) {
+          nearest = staticBVH->castRay(geom, ray.origin, ray.direction,
+                                       nearest, ray.ignoreGeom);
+        }
+        *(ray.result) = nearest;
+      }
+      releaseRayGeom(geom);
+    }
+
+    size_t RayCaster::getNumRays(void) const {
+      return numRays;
+    }
+
+    dGeomID RayCaster::acquireRayGeom(void) {
+      MutexLocker locker(&geomMutex);
+      if(!freeRayGeoms.empty()) {
+        dGeomID geom = freeRayGeoms.back();
+        freeRayGeoms.pop_back();
+        return geom;
+      }
+      dGeomID geom = dCreateRay(0, 1.0);
+      dGeomSetCollideBits(geom, COLLIDE_MASK_SENSOR);
+      dGeomSetCategoryBits(geom, COLLIDE_MASK_SENSOR);
+      // the trimesh collider returns any hit otherwise
+      dGeomRaySetClosestHit(geom, 1);
+      allRayGeoms.push_back(geom);
+      return geom;
+    }
+
+    void RayCaster::releaseRayGeom(dGeomID geom) {
+      MutexLocker locker(&geomMutex);
+      freeRayGeoms.push_back(geom);
+    }
+
+    void RayCaster::setRayGeom(dGeomID geom, const Ray &ray) {
+      dGeomRaySet(geom, ray.origin[0], ray.origin[1], ray.origin[2],
+                  ray.direction[0], ray.direction[1], ray.direction[2]);
+      dGeomRaySetLength(geom, ray.length);
+    }
+
+    void RayCaster::collectCallback(void *data, dGeomID o1, dGeomID o2) {
+      RayCaster *caster = static_cast<RayCaster*>(data);
+      dGeomID geom = (o1 == caster->rayGeom) ? o2 : o1;
+      if(dGeomIsSpace(geom)) {
+        dSpaceCollide2(caster->rayGeom, geom, data,
+                       &RayCaster::collectCallback);
+        return;
+      }
+      caster->collect(geom);
+    }
+
+    void RayCaster::collect(dGeomID geom) {
+      const Ray &ray = *currentRay;
+      if(geom == ray.ignoreGeom) return;
+      if(ray.ignoreBody && dGeomGetBody(geom) == ray.ignoreBody) return;
+      geom_data *gd = (geom_data*)dGeomGetData(geom);
+      if(gd && gd->ray_sensor) return;
+
+      Candidate candidate;
+      dReal aabb[6];
+      dGeomGetAABB(geom, aabb);
+      if(rayBoxEntry(ray, aabb, &candidate.entry)) {
+        candidate.geom = geom;
+        candidates.push_back(candidate);
+      }
+    }
+
+  } // end of namespace sim
+} // end of namespace mars
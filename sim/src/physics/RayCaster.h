@@ -0,0 +1,154 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+ /**
+ * \file RayCaster.h
+ * \author agent
+ * \brief "RayCaster" casts the rays of all ray based sensors of a step
+ * as one batch.
+ *
+ */
+
+#ifndef RAY_CASTER_H
+#define RAY_CASTER_H
+
+#ifdef _PRINT_HEADER_
+  #warning "RayCaster.h"
+#endif
+
+#include "ThreadPool.h"
+
+#include <mars/utils/Mutex.h>
+#include <mars/interfaces/MARSDefs.h>
+
+#include <vector>
+
+#include <ode/ode.h>
+
+namespace mars {
+  namespace sim {
+
+    class WorldPhysics;
+    class StaticBVH;
+
+    /**
+     * \brief The RayCaster collects the rays of the sensors during the
+     * node update and casts them afterwards in one batch.
+     *
+     * Every ray makes one broadphase query with its full length in the
+     * space of the dynamic geoms. The geoms whose bounding box is hit by
+     * the ray are sorted by the entry distance into the box and tested in
+     * that order; the test stops as soon as the nearest hit is closer
+     * than the next box. Afterwards the static geoms are traversed front
+     * to back through their bounding volume hierarchy up to the nearest
+     * dynamic hit. The distance
+     * of the nearest hit, or the length of the ray if nothing is hit, is
+     * written to the result pointer of the ray.
+     *
+     * The queries of the dynamic space run in the calling thread, since ODE
+     * modifies the state of a space while it is collided. If a thread
+     * pool is set, the narrowphase tests are distributed over the pool;
+     * every thread uses its own ray geom and ODE collision data. The
+     * narrowphase only reads the geoms, so it can run in parallel to the
+     * joint and motor updates, which do not move any geom.
+     */
+    class RayCaster : public ThreadPoolRangeTask {
+    public:
+      struct Ray {
+        dVector3 origin;
+        dVector3 direction; ///< normalized direction
+        dReal length;
+        /** Geom and body of the sensor node; they are not hit by the ray.
+         *  Both may be 0. */
+        dGeomID ignoreGeom;
+        dBodyID ignoreBody;
+        interfaces::sReal *result;
+      };
+
+      explicit RayCaster(WorldPhysics *world);
+      ~RayCaster();
+
+      /**
+       * \brief Sets the pool for the narrowphase; NULL casts all rays in
+       * the calling thread.
+       */
+      void setThreadPool(ThreadPool *pool);
+
+      /**
+       * \brief Adds rays to the batch of the current step. Can be called
+       * from several threads.
+       */
+      void addRays(const std::vector<Ray> &rays);
+
+      /**
+       * \brief Collects the candidate geoms of the dynamic space for all
+       * rays of the batch. The space and the hierarchy of the static
+       * geoms must not be changed until castCandidates() returns.
+       */
+      void collectCandidates(dSpaceID space, const StaticBVH *staticBVH);
+
+      /**
+       * \brief Runs the narrowphase of the collected rays, writes the
+       * results and clears the batch.
+       */
+      void castCandidates(void);
+
+      /// number of rays cast in the last batch
+      size_t getNumRays(void) const;
+
+      // ThreadPoolRangeTask method
+      virtual void runRange(size_t begin, size_t end);
+
+    private:
+      struct Candidate {
+        dReal entry;
+        dGeomID geom;
+        bool operator<(const Candidate &other) const {
+          return entry < other.entry;
+        }
+      };
+
+      static void collectCallback(void *data, dGeomID o1, dGeomID o2);
+      void collect(dGeomID geom);
+      dGeomID acquireRayGeom(void);
+      void releaseRayGeom(dGeomID geom);
+      void setRayGeom(dGeomID geom, const Ray &ray);
+
+      WorldPhysics *world;
+      ThreadPool *threadPool;
+      utils::Mutex mutex, geomMutex;
+      std::vector<Ray> rays;
+      /** The sorted candidates of all rays; the candidates of ray i are
+       *  [candidateBegin[i], candidateBegin[i+1]). */
+      std::vector<Candidate> candidates;
+      std::vector<size_t> candidateBegin;
+      const StaticBVH *staticBVH;
+      size_t numRays;
+      /** The ray geom of the broadphase and the ray geoms of the threads
+       *  that are not in use. */
+      dGeomID rayGeom;
+      std::vector<dGeomID> freeRayGeoms, allRayGeoms;
+      const Ray *currentRay;
+    }; // end of class RayCaster
+
+  } // end of namespace sim
+} // end of namespace mars
+
+#endif  // RAY_CASTER_H
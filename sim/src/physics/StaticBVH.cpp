@@ -0,0 +1,382 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+ /**
+ * \file StaticBVH.cpp
+ * \author agent
+ * \brief "StaticBVH" is a bounding volume hierarchy over the static geoms
+ * for ray and box queries.
+ *
+ */
+
+#include "StaticBVH.h"
+#include "NodePhysics.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mars {
+  namespace sim {
+
+    // maximal number of geoms in a leaf
+    static const int maxLeafSize = 4;
+    // larger bounds are treated as infinite
+    static const dReal maxExtent = 1e15;
+
+    /**
+     * \brief The precomputed data of a ray for the slab tests. The
+     * inverse direction is clamped to a large value for axis parallel
+     * rays, thus the test needs no branches per axis.
+     */
+    struct SlabRay {
+      dReal origin[3];
+      dReal invDir[3];
+    };
+
+    /**
+     * \brief The bit test of the collision of ODE spaces.
+     */
+    static inline bool testCollideBits(dGeomID a, dGeomID b) {
+      return ((dGeomGetCategoryBits(a) & dGeomGetCollideBits(b)) ||
+              (dGeomGetCategoryBits(b) & dGeomGetCollideBits(a)));
+    }
+
+    static void initSlabRay(const dReal *origin, const dReal *direction,
+                            SlabRay *ray) {
+      for(int k=0; k<3; ++k) {
+        ray->origin[k] = origin[k];
+        if(std::fabs(direction[k]) < 1e-12) {
+          ray->invDir[k] = direction[k] < 0 ? -1e30 : 1e30;
+        }
+        else {
+          ray->invDir[k] = 1.0 / direction[k];
+        }
+      }
+    }
+
+    /**
+     * \returns The entry distance into the box or a value larger than
+     * maxDistance if the box is missed.
+     */
+    static inline dReal slabEntry(const SlabRay &ray, const dReal *aabb,
+                                  dReal maxDistance) {
+      dReal t1, t2, tmin = 0.0, tmax = maxDistance;
+      for(int k=0; k<3; ++k) {
+        t1 = (aabb[k*2] - ray.origin[k]) * ray.invDir[k];
+        t2 = (aabb[k*2+1] - ray.origin[k]) * ray.invDir[k];
+        tmin = std::max(tmin, std::min(t1, t2));
+        tmax = std::min(tmax, std::max(t1, t2));
+      }
+      return tmin <= tmax ? tmin : maxDistance + 1.0;
+    }
+
+    static inline bool boxOverlap(const dReal *a, const dReal *b) {
+      return (a[0] <= b[1] && a[1] >= b[0] &&
+              a[2] <= b[3] && a[3] >= b[2] &&
+              a[4] <= b[5] && a[5] >= b[4]);
+    }
+
+    static bool isBounded(const dReal *aabb) {
+      for(int k=0; k<6; ++k) {
+        if(!(std::fabs(aabb[k]) < maxExtent)) return false;
+      }
+      return true;
+    }
+
+    // the number of geoms outside of the tree that are tested linearly
+    // is limited to 8 plus an eighth of the tree
+    static const size_t minLooseGeoms = 8;
+
+    StaticBVH::StaticBVH() : numRemoved(0) {
+    }
+
+    void StaticBVH::clear(void) {
+      items.clear();
+      nodes.clear();
+      unbounded.clear();
+      loose.clear();
+      itemIndex.clear();
+      numRemoved = 0;
+    }
+
+    void StaticBVH::initItem(dGeomID geom, Item *item) {
+      item->geom = geom;
+      dGeomGetAABB(geom, item->aabb);
+      for(int k=0; k<3; ++k) {
+        item->center[k] = 0.5*(item->aabb[k*2] + item->aabb[k*2+1]);
+      }
+    }
+
+    void StaticBVH::insert(dGeomID geom) {
+      Item item;
+      initItem(geom, &item);
+      if(isBounded(item.aabb)) loose.push_back(item);
+      else unbounded.push_back(geom);
+    }
+
+    void StaticBVH::remove(dGeomID geom) {
+      for(size_t i=0; i<loose.size(); ++i) {
+        if(loose[i].geom == geom) {
+          loose[i] = loose.back();
+          loose.pop_back();
+          return;
+        }
+      }
+      std::vector<dGeomID>::iterator it;
+      it = std::find(unbounded.begin(), unbounded.end(), geom);
+      if(it != unbounded.end()) {
+        unbounded.erase(it);
+        return;
+      }
+      // the bounds of the tree stay as they are until the next build
+      std::map<dGeomID, int>::iterator index = itemIndex.find(geom);
+      if(index != itemIndex.end()) {
+        items[index->second].geom = 0;
+        itemIndex.erase(index);
+        ++numRemoved;
+      }
+    }
+
+    bool StaticBVH::needsRebuild(void) const {
+      return (loose.size() > minLooseGeoms + items.size()/8 ||
+              (size_t)numRemoved*4 > items.size());
+    }
+
+    void StaticBVH::build(dSpaceID space) {
+      clear();
+      if(!space) return;
+      int num = dSpaceGetNumGeoms(space);
+      items.reserve(num);
+      Item item;
+      for(int i=0; i<num; ++i) {
+        initItem(dSpaceGetGeom(space, i), &item);
+        if(!isBounded(item.aabb)) {
+          unbounded.push_back(item.geom);
+          continue;
+        }
+        items.push_back(item);
+      }
+      if(items.empty()) return;
+      // a binary tree with leaves of at least one geom has < 2n nodes
+      nodes.reserve(2*items.size());
+      nodes.resize(1);
+      buildNode(0, 0, (int)items.size());
+      for(size_t i=0; i<items.size(); ++i) {
+        itemIndex[items[i].geom] = (int)i;
+      }
+    }
+
+    void StaticBVH::buildNode(int node, int first, int count) {
+      nodes[node].first = first;
+      nodes[node].count = count;
+      nodes[node].child = -1;
+      computeBounds(&nodes[node]);
+      if(count <= maxLeafSize) return;
+
+      // split at the median of the centers along the largest axis
+      dReal cmin[3], cmax[3];
+      for(int k=0; k<3; ++k) {
+        cmin[k] = cmax[k] = items[first].center[k];
+      }
+      for(int i=first+1; i<first+count; ++i) {
+        for(int k=0; k<3; ++k) {
+          cmin[k] = std::min(cmin[k], items[i].center[k]);
+          cmax[k] = std::max(cmax[k], items[i].center[k]);
+        }
+      }
+      CenterLess less;
+      less.axis = 0;
+      for(int k=1; k<3; ++k) {
+        if(cmax[k]-cmin[k] > cmax[less.axis]-cmin[less.axis]) less.axis = k;
+      }
+      int half = count / 2;
+      std::nth_element(items.begin()+first, items.begin()+first+half,
+                       items.begin()+first+count, less);
+
+      int child = (int)nodes.size();
+      nodes[node].count = 0;
+      nodes[node].child = child;
+      nodes.resize(nodes.size()+2);
+      buildNode(child, first, half);
+      buildNode(child+1, first+half, count-half);
+    }
+
+    void StaticBVH::computeBounds(Node *node) const {
+      const dReal *a;
+      if(node->count > 0) {
+        a = items[node->first].aabb;
+      }
+      else {
+        a = nodes[node->child].aabb;
+      }
+      for(int k=0; k<6; ++k) node->aabb[k] = a[k];
+
+      if(node->count > 0) {
+        for(int i=node->first+1; i<node->first+node->count; ++i) {
+          a = items[i].aabb;
+          for(int k=0; k<3; ++k) {
+            node->aabb[k*2] = std::min(node->aabb[k*2], a[k*2]);
+            node->aabb[k*2+1] = std::max(node->aabb[k*2+1], a[k*2+1]);
+          }
+        }
+      }
+      else {
+        a = nodes[node->child+1].aabb;
+        for(int k=0; k<3; ++k) {
+          node->aabb[k*2] = std::min(node->aabb[k*2], a[k*2]);
+          node->aabb[k*2+1] = std::max(node->aabb[k*2+1], a[k*2+1]);
+        }
+      }
+    }
+
+    void StaticBVH::refit(void) {
+      for(size_t i=0; i<items.size(); ++i) {
+        if(items[i].geom) dGeomGetAABB(items[i].geom, items[i].aabb);
+      }
+      for(size_t i=0; i<loose.size(); ++i) {
+        dGeomGetAABB(loose[i].geom, loose[i].aabb);
+      }
+      // the children are always stored behind their parent
+      for(size_t i=nodes.size(); i>0; --i) {
+        computeBounds(&nodes[i-1]);
+      }
+    }
+
+    dReal StaticBVH::castRay(dGeomID rayGeom, const dReal *origin,
+                             const dReal *direction, dReal maxDistance,
+                             dGeomID ignoreGeom) const {
+      dReal nearest = maxDistance;
+      dContactGeom contact;
+      geom_data *gd;
+
+      for(size_t i=0; i<unbounded.size(); ++i) {
+        if(unbounded[i] == ignoreGeom) continue;
+        if(!testCollideBits(rayGeom, unbounded[i])) continue;
+        if(dCollide(rayGeom, unbounded[i], 1, &contact,
+                    sizeof(dContactGeom))) {
+          if(contact.depth < nearest) nearest = contact.depth;
+        }
+      }
+
+      SlabRay ray;
+      initSlabRay(origin, direction, &ray);
+      for(size_t i=0; i<loose.size(); ++i) {
+        const Item &item = loose[i];
+        if(item.geom == ignoreGeom) continue;
+        if(!testCollideBits(rayGeom, item.geom)) continue;
+        if(slabEntry(ray, item.aabb, nearest) >= nearest) continue;
+        gd = (geom_data*)dGeomGetData(item.geom);
+        if(gd && gd->ray_sensor) continue;
+        if(dCollide(rayGeom, item.geom, 1, &contact,
+                    sizeof(dContactGeom))) {
+          if(contact.depth < nearest) nearest = contact.depth;
+        }
+      }
+      if(nodes.empty()) return nearest;
+
+      // the nodes on the stack are sorted front to back
+      int stack[64];
+      dReal entries[64];
+      int top = 0;
+      entries[0] = slabEntry(ray, nodes[0].aabb, nearest);
+      if(entries[0] > nearest) return nearest;
+      stack[top++] = 0;
+
+      while(top > 0) {
+        --top;
+        if(entries[top] >= nearest) continue;
+        const Node &node = nodes[stack[top]];
+        if(node.count > 0) {
+          for(int i=node.first; i<node.first+node.count; ++i) {
+            const Item &item = items[i];
+            if(!item.geom || item.geom == ignoreGeom) continue;
+            if(!testCollideBits(rayGeom, item.geom)) continue;
+            if(slabEntry(ray, item.aabb, nearest) >= nearest) continue;
+            gd = (geom_data*)dGeomGetData(item.geom);
+            if(gd && gd->ray_sensor) continue;
+            if(dCollide(rayGeom, item.geom, 1, &contact,
+                        sizeof(dContactGeom))) {
+              if(contact.depth < nearest) nearest = contact.depth;
+            }
+          }
+          continue;
+        }
+        dReal e1 = slabEntry(ray, nodes[node.child].aabb, nearest);
+        dReal e2 = slabEntry(ray, nodes[node.child+1].aabb, nearest);
+        int c1 = node.child, c2 = node.child+1;
+        if(e2 < e1) {
+          std::swap(e1, e2);
+          std::swap(c1, c2);
+        }
+        // the tree depth is about log2(n/maxLeafSize), thus 64 entries
+        // are never exceeded
+        if(e2 < nearest) {
+          entries[top] = e2;
+          stack[top++] = c2;
+        }
+        if(e1 < nearest) {
+          entries[top] = e1;
+          stack[top++] = c1;
+        }
+      }
+      return nearest;
+    }
+
+    void StaticBVH::query(dGeomID geom, const dReal *aabb,
+                          std::vector<dGeomID> *geoms) const {
+      for(size_t i=0; i<unbounded.size(); ++i) {
+        if(testCollideBits(geom, unbounded[i])) {
+          geoms->push_back(unbounded[i]);
+        }
+      }
+      for(size_t i=0; i<loose.size(); ++i) {
+        if(boxOverlap(loose[i].aabb, aabb) &&
+           testCollideBits(geom, loose[i].geom)) {
+          geoms->push_back(loose[i].geom);
+        }
+      }
+      if(nodes.empty()) return;
+
+      int stack[64];
+      int top = 0;
+      stack[top++] = 0;
+      while(top > 0) {
+        const Node &node = nodes[stack[--top]];
+        if(!boxOverlap(node.aabb, aabb)) continue;
+        if(node.count > 0) {
+          for(int i=node.first; i<node.first+node.count; ++i) {
+            if(items[i].geom && boxOverlap(items[i].aabb, aabb) &&
+               testCollideBits(geom, items[i].geom)) {
+              geoms->push_back(items[i].geom);
+            }
+          }
+          continue;
+        }
+        stack[top++] = node.child;
+        stack[top++] = node.child+1;
+      }
+    }
+
+    size_t StaticBVH::getNumGeoms(void) const {
+      return items.size() - numRemoved + loose.size() + unbounded.size();
+    }
+
+  } // end of namespace sim
+} // end of namespace mars
@@ -0,0 +1,161 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+ /**
+ * \file StaticBVH.h
+ * \author agent
+ * \brief "StaticBVH" is a bounding volume hierarchy over the static geoms
+ * for ray and box queries.
+ *
+ */
+
+#ifndef STATIC_BVH_H
+#define STATIC_BVH_H
+
+#ifdef _PRINT_HEADER_
+  #warning "StaticBVH.h"
+#endif
+
+#include <map>
+#include <vector>
+
+#include <ode/ode.h>
+
+namespace mars {
+  namespace sim {
+
+    /**
+     * \brief A binary bounding volume hierarchy over the bounding boxes
+     * of the geoms of a space.
+     *
+     * The hierarchy is built with median splits along the largest axis
+     * and stored in one array. It is built over all static geoms and
+     * only refitted when static geoms are moved. Geoms that are added
+     * later are kept in a list that is tested linearly, removed geoms
+     * are only marked in the tree; needsRebuild() tells when the list or
+     * the removed geoms became too many. Thus geoms that come and go
+     * often (e.g. terrain tiles) do not rebuild the hierarchy.
+     * Geoms with an infinite bounding box (planes, unbounded
+     * heightfields) are kept in an extra list and are part of every
+     * query. The exact tests of the leaf geoms are made with dCollide,
+     * thus triangle meshes use the ray/triangle kernels of ODE. Like the
+     * collision of ODE spaces, the queries skip the geoms whose category
+     * and collide bits do not match the ones of the query geom.
+     *
+     * The queries only read the hierarchy and the geoms and can be made
+     * from several threads at once.
+     */
+    class StaticBVH {
+    public:
+      StaticBVH();
+
+      /**
+       * \brief Builds the hierarchy over all geoms of the space.
+       */
+      void build(dSpaceID space);
+
+      /**
+       * \brief Updates the bounding boxes after geoms were moved. The
+       * structure of the tree is kept.
+       */
+      void refit(void);
+
+      void clear(void);
+
+      /**
+       * \brief Adds a geom to the list of geoms outside of the tree.
+       */
+      void insert(dGeomID geom);
+
+      /**
+       * \brief Removes a geom; a geom of the tree is only marked as
+       * removed.
+       */
+      void remove(dGeomID geom);
+
+      /**
+       * \returns true if the geoms outside of the tree or the removed
+       * geoms slow down the queries and the hierarchy should be built
+       * again.
+       */
+      bool needsRebuild(void) const;
+
+      /**
+       * \brief Casts a ray through the hierarchy front to back.
+       * \param rayGeom A ray geom that is set to the ray; it must not be
+       *        part of the hierarchy.
+       * \param direction The normalized direction of the ray.
+       * \param maxDistance Hits beyond this distance are ignored.
+       * \param ignoreGeom A geom that is never hit, may be 0.
+       * \returns The distance of the nearest hit or maxDistance.
+       */
+      dReal castRay(dGeomID rayGeom, const dReal *origin,
+                    const dReal *direction, dReal maxDistance,
+                    dGeomID ignoreGeom) const;
+
+      /**
+       * \brief Appends all geoms that may collide with geom and whose
+       * bounding box overlaps the given box (minX, maxX, minY, maxY,
+       * minZ, maxZ as returned by dGeomGetAABB).
+       */
+      void query(dGeomID geom, const dReal *aabb,
+                 std::vector<dGeomID> *geoms) const;
+
+      size_t getNumGeoms(void) const;
+
+    private:
+      struct Item {
+        dGeomID geom;
+        dReal aabb[6];
+        dReal center[3];
+      };
+
+      /** A leaf holds the items [first, first+count); an inner node has
+       *  count == 0 and its children at child and child+1. */
+      struct Node {
+        dReal aabb[6];
+        int first, count, child;
+      };
+
+      struct CenterLess {
+        int axis;
+        bool operator()(const Item &a, const Item &b) const {
+          return a.center[axis] < b.center[axis];
+        }
+      };
+
+      void buildNode(int node, int first, int count);
+      void computeBounds(Node *node) const;
+      static void initItem(dGeomID geom, Item *item);
+
+      // the geoms of removed items are 0
+      std::vector<Item> items;
+      std::vector<Node> nodes;
+      std::vector<dGeomID> unbounded;
+      // the geoms added after the build
+      std::vector<Item> loose;
+      std::map<dGeomID, int> itemIndex;
+      int numRemoved;
+    }; // end of class StaticBVH
+
+  } // end of namespace sim
+} // end of namespace mars
+
+#endif  // STATIC_BVH_H
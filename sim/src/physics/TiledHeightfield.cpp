@@ -0,0 +1,225 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+ /**
+ * \file TiledHeightfield.cpp
+ * \author agent
+ * \brief "TiledHeightfield" splits a terrain into heightfield tiles of
+ * which only the tiles near bodies are part of the collision space.
+ *
+ */
+
+#include "TiledHeightfield.h"
+#include "NodePhysics.h"
+#include "WorldPhysics.h"
+
+#include <mars/interfaces/terrainStruct.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace mars {
+  namespace sim {
+
+    using namespace interfaces;
+
+    // larger bounds are treated as infinite and do not activate tiles
+    static const dReal maxExtent = 1e15;
+
+    TiledHeightfield::TiledHeightfield(WorldPhysics *world, NodePhysics *node,
+                                       const terrainStruct *terrain,
+                                       dGeomID frame, int tileSize)
+      : world(world), node(node), frame(frame), tileSize(tileSize),
+        numUpdates(0) {
+      if(this->tileSize < 1) this->tileSize = 1;
+      cellWidth = terrain->targetWidth / (terrain->width-1);
+      cellDepth = terrain->targetHeight / (terrain->height-1);
+      halfWidth = terrain->targetWidth*0.5;
+      halfDepth = terrain->targetHeight*0.5;
+      numTilesX = (terrain->width-2) / this->tileSize + 1;
+      numTilesZ = (terrain->height-2) / this->tileSize + 1;
+      memset(framePos, 0, sizeof(dVector3));
+      memset(frameR, 0, sizeof(dMatrix3));
+
+      tiles.resize((size_t)numTilesX*numTilesZ);
+      for(int z=0; z<numTilesZ; ++z) {
+        for(int x=0; x<numTilesX; ++x) {
+          Tile &tile = tiles[(size_t)z*numTilesX+x];
+          tile.field = this;
+          tile.x0 = x*this->tileSize;
+          tile.z0 = z*this->tileSize;
+          tile.samplesX = std::min(this->tileSize,
+                                   terrain->width-1-tile.x0) + 1;
+          tile.samplesZ = std::min(this->tileSize,
+                                   terrain->height-1-tile.z0) + 1;
+          tile.data = 0;
+          tile.geom = 0;
+          tile.lastUsed = 0;
+        }
+      }
+    }
+
+    TiledHeightfield::~TiledHeightfield() {
+      for(size_t i=0; i<active.size(); ++i) {
+        deactivate(&tiles[active[i]]);
+      }
+    }
+
+    dReal TiledHeightfield::heightCallback(void *data, int x, int z) {
+      Tile *tile = (Tile*)data;
+      return tile->field->node->heightCallback(tile->x0+x, tile->z0+z);
+    }
+
+    void TiledHeightfield::updateCollideBits(void) {
+      for(size_t i=0; i<active.size(); ++i) {
+        dGeomID geom = tiles[active[i]].geom;
+        dGeomSetCollideBits(geom, dGeomGetCollideBits(frame));
+        dGeomSetCategoryBits(geom, dGeomGetCategoryBits(frame));
+      }
+    }
+
+    bool TiledHeightfield::frameMoved(void) {
+      const dReal *pos = dGeomGetPosition(frame);
+      const dReal *R = dGeomGetRotation(frame);
+      if(!memcmp(pos, framePos, sizeof(dVector3)) &&
+         !memcmp(R, frameR, sizeof(dMatrix3))) {
+        return false;
+      }
+      memcpy(framePos, pos, sizeof(dVector3));
+      memcpy(frameR, R, sizeof(dMatrix3));
+      return true;
+    }
+
+    void TiledHeightfield::update(const std::vector<dReal> &aabbs,
+                                  dReal margin, int keepUpdates) {
+      ++numUpdates;
+      bool moved = frameMoved();
+      dReal tileWidth = tileSize*cellWidth, tileDepth = tileSize*cellDepth;
+
+      for(size_t b=0; b+5<aabbs.size(); b+=6) {
+        const dReal *box = &aabbs[b];
+        dReal c[3], e[3];
+        bool bounded = true;
+        for(int k=0; k<3; ++k) {
+          bounded &= (std::fabs(box[k*2]) < maxExtent &&
+                      std::fabs(box[k*2+1]) < maxExtent);
+          c[k] = 0.5*(box[k*2] + box[k*2+1]) - framePos[k];
+          e[k] = 0.5*(box[k*2+1] - box[k*2]) + margin;
+        }
+        if(!bounded) continue;
+        // the box in the frame of the heightfield, whose samples lie in
+        // the local x-z plane
+        dReal lx = 0.0, lz = 0.0, ex = 0.0, ez = 0.0;
+        for(int j=0; j<3; ++j) {
+          lx += frameR[j*4]*c[j];
+          lz += frameR[j*4+2]*c[j];
+          ex += std::fabs(frameR[j*4])*e[j];
+          ez += std::fabs(frameR[j*4+2])*e[j];
+        }
+        int x0 = (int)std::floor((lx - ex + halfWidth) / tileWidth);
+        int x1 = (int)std::floor((lx + ex + halfWidth) / tileWidth);
+        int z0 = (int)std::floor((lz - ez + halfDepth) / tileDepth);
+        int z1 = (int)std::floor((lz + ez + halfDepth) / tileDepth);
+        if(x1 < 0 || x0 >= numTilesX || z1 < 0 || z0 >= numTilesZ) continue;
+        x0 = std::max(x0, 0);
+        z0 = std::max(z0, 0);
+        x1 = std::min(x1, numTilesX-1);
+        z1 = std::min(z1, numTilesZ-1);
+        for(int z=z0; z<=z1; ++z) {
+          for(int x=x0; x<=x1; ++x) {
+            int index = z*numTilesX+x;
+            Tile &tile = tiles[index];
+            tile.lastUsed = numUpdates;
+            if(!tile.geom) {
+              activate(&tile);
+              active.push_back(index);
+            }
+          }
+        }
+      }
+
+      for(size_t i=0; i<active.size();) {
+        Tile &tile = tiles[active[i]];
+        if(numUpdates - tile.lastUsed > (unsigned long)keepUpdates) {
+          deactivate(&tile);
+          active[i] = active.back();
+          active.pop_back();
+          continue;
+        }
+        if(moved) placeTile(&tile);
+        ++i;
+      }
+    }
+
+    void TiledHeightfield::activate(Tile *tile) {
+      // tight bounds keep the tile out of the broadphase pairs of bodies
+      // above the terrain
+      dReal low = node->heightCallback(tile->x0, tile->z0), high = low;
+      for(int z=0; z<tile->samplesZ; ++z) {
+        for(int x=0; x<tile->samplesX; ++x) {
+          dReal h = node->heightCallback(tile->x0+x, tile->z0+z);
+          low = std::min(low, h);
+          high = std::max(high, h);
+        }
+      }
+      tile->data = dGeomHeightfieldDataCreate();
+      dGeomHeightfieldDataBuildCallback(tile->data, tile, heightCallback,
+                                        (tile->samplesX-1)*cellWidth,
+                                        (tile->samplesZ-1)*cellDepth,
+                                        tile->samplesX, tile->samplesZ,
+                                        REAL(1.0), REAL(0.0),
+                                        REAL(1.0), 0);
+      dGeomHeightfieldDataSetBounds(tile->data, low-REAL(0.01),
+                                    high+REAL(0.01));
+      tile->geom = dCreateHeightfield(world->getSpace(), tile->data, 1);
+      dGeomSetData(tile->geom, dGeomGetData(frame));
+      dGeomSetCollideBits(tile->geom, dGeomGetCollideBits(frame));
+      dGeomSetCategoryBits(tile->geom, dGeomGetCategoryBits(frame));
+      placeTile(tile);
+      world->makeGeomStatic(tile->geom);
+    }
+
+    void TiledHeightfield::deactivate(Tile *tile) {
+      world->destroyGeom(tile->geom);
+      dGeomHeightfieldDataDestroy(tile->data);
+      tile->geom = 0;
+      tile->data = 0;
+    }
+
+    void TiledHeightfield::placeTile(Tile *tile) {
+      // the center of the tile in the frame of the whole heightfield
+      dVector3 center, pos;
+      center[0] = (tile->x0 + (tile->samplesX-1)*0.5)*cellWidth - halfWidth;
+      center[1] = 0.0;
+      center[2] = (tile->z0 + (tile->samplesZ-1)*0.5)*cellDepth - halfDepth;
+      dMULTIPLY0_331(pos, frameR, center);
+      dGeomSetPosition(tile->geom, framePos[0]+pos[0], framePos[1]+pos[1],
+                       framePos[2]+pos[2]);
+      dGeomSetRotation(tile->geom, frameR);
+      world->staticGeomMoved(tile->geom);
+    }
+
+    int TiledHeightfield::getNumActiveTiles(void) const {
+      return (int)active.size();
+    }
+
+  } // end of namespace sim
+} // end of namespace mars
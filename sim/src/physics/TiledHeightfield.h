@@ -0,0 +1,123 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+ /**
+ * \file TiledHeightfield.h
+ * \author agent
+ * \brief "TiledHeightfield" splits a terrain into heightfield tiles of
+ * which only the tiles near bodies are part of the collision space.
+ *
+ */
+
+#ifndef TILED_HEIGHTFIELD_H
+#define TILED_HEIGHTFIELD_H
+
+#ifdef _PRINT_HEADER_
+  #warning "TiledHeightfield.h"
+#endif
+
+#include <vector>
+
+#include <ode/ode.h>
+
+namespace mars {
+
+  namespace interfaces {
+    struct terrainStruct;
+  }
+
+  namespace sim {
+
+    class WorldPhysics;
+    class NodePhysics;
+
+    /**
+     * \brief A terrain that is split into square tiles of tileSize cells.
+     *
+     * The pose of the terrain is given by a heightfield geom over the
+     * whole terrain that is not part of any space (the frame). A tile is
+     * an ODE heightfield of its part of the terrain with the same pose.
+     * Tiles are created in the static space when a body comes closer
+     * than the margin and destroyed when no body was close for a number
+     * of updates. Neighboring tiles share their border samples, thus the
+     * surface has no gaps. The tiles use the geom data and the collide
+     * bits of the frame.
+     *
+     * All tiles read their heights through NodePhysics::heightCallback
+     * from the height data of the terrain; they hold no copy of it, so a
+     * mapped height file is only read where tiles are active.
+     *
+     * Rays and depth queries only see the active tiles; the margin should
+     * cover the range of the sensors.
+     */
+    class TiledHeightfield {
+    public:
+      TiledHeightfield(WorldPhysics *world, NodePhysics *node,
+                       const interfaces::terrainStruct *terrain,
+                       dGeomID frame, int tileSize);
+      ~TiledHeightfield();
+
+      /// copies the collide and category bits of the frame to the tiles
+      void updateCollideBits(void);
+
+      /**
+       * \brief Activates the tiles closer than margin to one of the
+       * boxes and removes the tiles that were not needed for keepUpdates
+       * updates. Moves the tiles if the frame was moved.
+       * \param aabbs The world bounding boxes of the bodies, six values
+       *        per box as returned by dGeomGetAABB.
+       */
+      void update(const std::vector<dReal> &aabbs, dReal margin,
+                  int keepUpdates);
+
+      int getNumActiveTiles(void) const;
+
+    private:
+      struct Tile {
+        TiledHeightfield *field;
+        int x0, z0, samplesX, samplesZ;
+        dHeightfieldDataID data;
+        dGeomID geom;
+        unsigned long lastUsed;
+      };
+
+      static dReal heightCallback(void *data, int x, int z);
+      void activate(Tile *tile);
+      void deactivate(Tile *tile);
+      void placeTile(Tile *tile);
+      bool frameMoved(void);
+
+      WorldPhysics *world;
+      NodePhysics *node;
+      dGeomID frame;
+      int tileSize, numTilesX, numTilesZ;
+      dReal cellWidth, cellDepth, halfWidth, halfDepth;
+      dVector3 framePos;
+      dMatrix3 frameR;
+      unsigned long numUpdates;
+      std::vector<Tile> tiles;
+      // indices of the tiles with a geom
+      std::vector<int> active;
+    }; // end of class TiledHeightfield
+
+  } // end of namespace sim
+} // end of namespace mars
+
+#endif  // TILED_HEIGHTFIELD_H
@@ -0,0 +1,145 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+ /**
+ * \file TriMeshCache.cpp
+ * \author agent
+ * \brief "TriMeshCache" shares the ODE trimesh data of mesh nodes that are
+ * created from the same mesh.
+ *
+ */
+
+#include "TriMeshCache.h"
+
+#include <cstdlib>
+
+namespace mars {
+  namespace sim {
+
+    using namespace interfaces;
+
+    bool TriMeshCache::Key::operator<(const Key &other) const {
+      if(filename != other.filename) return filename < other.filename;
+      if(objectName != other.objectName) return objectName < other.objectName;
+      for(int i=0; i<3; ++i) {
+        if(size[i] != other.size[i]) return size[i] < other.size[i];
+      }
+      for(int i=0; i<3; ++i) {
+        if(pivot[i] != other.pivot[i]) return pivot[i] < other.pivot[i];
+      }
+      if(vertexCount != other.vertexCount) {
+        return vertexCount < other.vertexCount;
+      }
+      return indexCount < other.indexCount;
+    }
+
+    TriMeshCache::TriMeshCache() {
+    }
+
+    TriMeshCache::~TriMeshCache() {
+      std::map<Key, TriMesh*>::iterator iter;
+      for(iter=meshes.begin(); iter!=meshes.end(); ++iter) {
+        destroyTriMesh(iter->second);
+      }
+    }
+
+    TriMeshCache::TriMesh* TriMeshCache::acquire(const NodeData *node) {
+      if(node->filename.empty()) {
+        TriMesh *mesh = createTriMesh(node);
+        mesh->shared = false;
+        return mesh;
+      }
+
+      // the loaders scale the mesh to the visual size and shift it by the
+      // pivot, so these are part of the key
+      Key key;
+      key.filename = node->filename;
+      key.objectName = node->origName;
+      for(int i=0; i<3; ++i) {
+        key.size[i] = node->visual_size[i];
+        key.pivot[i] = node->pivot[i];
+      }
+      key.vertexCount = node->mesh.vertexcount;
+      key.indexCount = node->mesh.indexcount;
+
+      std::map<Key, TriMesh*>::iterator iter = meshes.find(key);
+      if(iter != meshes.end()) {
+        ++iter->second->refCount;
+        return iter->second;
+      }
+      TriMesh *mesh = createTriMesh(node);
+      mesh->shared = true;
+      meshes[key] = mesh;
+      return mesh;
+    }
+
+    void TriMeshCache::release(TriMesh *mesh) {
+      if(--mesh->refCount > 0) return;
+      if(mesh->shared) {
+        std::map<Key, TriMesh*>::iterator iter;
+        for(iter=meshes.begin(); iter!=meshes.end(); ++iter) {
+          if(iter->second == mesh) {
+            meshes.erase(iter);
+            break;
+          }
+        }
+      }
+      destroyTriMesh(mesh);
+    }
+
+    size_t TriMeshCache::getNumMeshes(void) const {
+      return meshes.size();
+    }
+
+    TriMeshCache::TriMesh* TriMeshCache::createTriMesh(const NodeData *node) {
+      TriMesh *mesh = new TriMesh;
+      mesh->vertexCount = node->mesh.vertexcount;
+      mesh->indexCount = node->mesh.indexcount;
+      mesh->refCount = 1;
+      mesh->vertices = (dVector3*)calloc(mesh->vertexCount, sizeof(dVector3));
+      mesh->indices = (dTriIndex*)calloc(mesh->indexCount, sizeof(dTriIndex));
+      // first we have to copy the mesh data to prevent errors in case
+      // of double to float conversion
+      for(int i=0; i<mesh->vertexCount; i++) {
+        mesh->vertices[i][0] = (dReal)node->mesh.vertices[i][0];
+        mesh->vertices[i][1] = (dReal)node->mesh.vertices[i][1];
+        mesh->vertices[i][2] = (dReal)node->mesh.vertices[i][2];
+      }
+      for(int i=0; i<mesh->indexCount; i++) {
+        mesh->indices[i] = (dTriIndex)node->mesh.indices[i];
+      }
+
+      // then we can build the ode representation
+      mesh->data = dGeomTriMeshDataCreate();
+      dGeomTriMeshDataBuildSimple(mesh->data, (dReal*)mesh->vertices,
+                                  mesh->vertexCount,
+                                  mesh->indices, mesh->indexCount);
+      return mesh;
+    }
+
+    void TriMeshCache::destroyTriMesh(TriMesh *mesh) {
+      dGeomTriMeshDataDestroy(mesh->data);
+      free(mesh->vertices);
+      free(mesh->indices);
+      delete mesh;
+    }
+
+  } // end of namespace sim
+} // end of namespace mars
@@ -0,0 +1,110 @@
+/*
+ *  Copyright 2026, DFKI GmbH Robotics Innovation Center
+ *
+ *  This file is part of the MARS simulation framework.
+ *
+ *  MARS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License
+ *  as published by the Free Software Foundation, either version 3
+ *  of the License, or (at your option) any later version.
+ *
+ *  MARS is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with MARS.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+ /**
+ * \file TriMeshCache.h
+ * \author agent
+ * \brief "TriMeshCache" shares the ODE trimesh data of mesh nodes that are
+ * created from the same mesh.
+ *
+ */
+
+#ifndef TRI_MESH_CACHE_H
+#define TRI_MESH_CACHE_H
+
+#ifdef _PRINT_HEADER_
+  #warning "TriMeshCache.h"
+#endif
+
+#include <mars/interfaces/NodeData.h>
+
+#include <map>
+#include <string>
+
+#include <ode/ode.h>
+
+#ifndef ODE11
+  #define dTriIndex int
+#endif
+
+namespace mars {
+  namespace sim {
+
+    /**
+     * \brief The TriMeshCache holds the converted vertex and index buffers
+     * and the ODE trimesh data (including the collision tree of OPCODE)
+     * of the mesh nodes.
+     *
+     * Nodes that load the same object of the same file with the same size
+     * and pivot get the same mesh data and only differ in the transform of
+     * their geoms. The data is reference counted and freed when the last
+     * node releases it. Meshes without a filename are never shared.
+     *
+     * The cache is owned by the WorldPhysics and only used while its
+     * iMutex is locked for writing.
+     */
+    class TriMeshCache {
+    public:
+      struct TriMesh {
+        dVector3 *vertices;
+        dTriIndex *indices;
+        int vertexCount, indexCount;
+        dTriMeshDataID data;
+        int refCount;
+        bool shared;
+      };
+
+      TriMeshCache();
+      ~TriMeshCache();
+
+      /**
+       * \brief Returns the mesh data for node->mesh and increases its
+       * reference count. The data is built if no equal mesh is cached.
+       */
+      TriMesh* acquire(const interfaces::NodeData *node);
+
+      /**
+       * \brief Decreases the reference count; the data is freed when it
+       * is not used anymore. The geoms using it have to be destroyed
+       * before.
+       */
+      void release(TriMesh *mesh);
+
+      /// number of distinct meshes in the cache
+      size_t getNumMeshes(void) const;
+
+    private:
+      struct Key {
+        std::string filename, objectName;
+        double size[3], pivot[3];
+        int vertexCount, indexCount;
+        bool operator<(const Key &other) const;
+      };
+
+      static TriMesh* createTriMesh(const interfaces::NodeData *node);
+      static void destroyTriMesh(TriMesh *mesh);
+
+      std::map<Key, TriMesh*> meshes;
+    }; // end of class TriMeshCache
+
+  } // end of namespace sim
+} // end of namespace mars
+
+#endif  // TRI_MESH_CACHE_H
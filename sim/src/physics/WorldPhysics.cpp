@@ -41,18 +41,34 @@
 
 
 #include <mars/utils/MutexLocker.h>
+#include <mars/utils/ReadWriteLocker.h>
+#include <mars/utils/misc.h>
 #include <mars/interfaces/graphics/draw_structs.h>
 #include <mars/interfaces/graphics/GraphicsManagerInterface.h>
 #include <mars/interfaces/sim/SimulatorInterface.h>
 #include <mars/interfaces/Logging.hpp>
 
+#include <pthread.h>
+#include <algorithm>
+#include <functional>
+#include <cmath>
+
 namespace mars {
   namespace sim {
 
     using namespace utils;
     using namespace interfaces;
 
-    PhysicsError WorldPhysics::error = PHYSICS_NO_ERROR;
+    // dInitODE2 and dCloseODE are not thread safe
+    static Mutex odeInitMutex;
+
+    // the world that receives the ODE messages of a thread
+    static pthread_key_t currentWorldKey;
+    static pthread_once_t currentWorldOnce = PTHREAD_ONCE_INIT;
+
+    static void createCurrentWorldKey(void) {
+      pthread_key_create(&currentWorldKey, NULL);
+    }
 
     void myMessageFunction(int errnum, const char *msg, va_list ap) {
       CPP_UNUSED(errnum);
@@ -62,13 +78,15 @@ namespace mars {
     void myDebugFunction(int errnum, const char *msg, va_list ap) {
       CPP_UNUSED(errnum);
       LOG_DEBUG(msg, ap);
-      WorldPhysics::error = PHYSICS_DEBUG;
+      WorldPhysics *world = WorldPhysics::getCurrent();
+      if(world) world->error = PHYSICS_DEBUG;
     }
 
     void myErrorFunction(int errnum, const char *msg, va_list ap) {
       CPP_UNUSED(errnum);
       LOG_ERROR(msg, ap);
-      WorldPhysics::error = PHYSICS_ERROR;
+      WorldPhysics *world = WorldPhysics::getCurrent();
+      if(world) world->error = PHYSICS_ERROR;
     }
 
     /**
@@ -87,35 +105,88 @@ namespace mars {
       this->control = control;
       draw_contact_points = 0;
       fast_step = 0;
+      // the defaults of ODE
+      quickstep_iterations = quickstep_num_iterations = 20;
+      quickstep_w = 1.3;
+      quickstep_max_error = 0.0;
+      quickstep_min_iterations = 5;
+      quickstep_max_iterations = 100;
+      quickstep_error = 0.0;
+      quickstep_calm_steps = 0;
       world_cfm = 1e-10;
+      collision_time = solver_time = 0.0;
+      adaptive_step = false;
+      max_substeps = 8;
+      max_penetration = 0.005;
+      max_joint_error = 0.01;
+      num_substeps = 1;
+      max_contact_depth = 0.0;
+      num_contact_joints = 0;
+      contact_allocations = 0;
+      max_manifold_contacts = 0;
+      contact_cache_distance = 0.0;
+      contact_cache_angle = 0.0;
+      num_cached_pairs = 0;
+      terrain_tile_size = 0;
+      terrain_tile_margin = 5.0;
+      terrain_tile_keep_steps = 100;
+      contact_generation = 1;
+      num_feedbacks = 0;
+      broadphase = "hash";
+      hash_min_level = -3;
+      hash_max_level = 10;
+      quadtree_center = Vector(0.0, 0.0, 0.0);
+      quadtree_extents = Vector(100.0, 100.0, 10.0);
+      quadtree_depth = 6;
+      // the defaults of ODE
+      auto_disable = false;
+      auto_disable_linear = 0.01;
+      auto_disable_angular = 0.01;
+      auto_disable_steps = 10;
+      auto_disable_time = 0.0;
+      num_bodies = num_sleeping_bodies = 0;
+      num_wakeups = 0;
+      bodies_collected = false;
+      solver_threads = old_solver_threads = 1;
+#ifdef ODE_THREADING
+      threading = 0;
+      threading_pool = 0;
+#endif
       world_erp = 0.1;
       world_gravity = Vector(0.0, 0.0, -9.81);
       ground_friction = 20;
       ground_cfm = 0.00000001;
       ground_erp = 0.1;
       world = 0;
-      space = 0;
+      space = static_space = 0;
+      ray_caster = 0;
+      thread_pool = 0;
+      static_bvh_rebuild = true;
+      static_bvh_refit = false;
+      trimesh_cache = new TriMeshCache();
       contactgroup = 0;
       world_init = 0;
       num_contacts = 0;
       create_contacts = 1;
       log_contacts = 0;
+      error = PHYSICS_NO_ERROR;
 
       // the step size in seconds
       step_size = 0.01;
       // dInitODE is relevant for using trimesh objects as correct as
       // possible in the ode implementation
-      MutexLocker locker(&iMutex);
+      odeInitMutex.lock();
 #ifdef ODE11
       // for ode-0.11
       dInitODE2(0);
-      dAllocateODEDataForThread(dAllocateMaskAll);
 #else
       dInitODE();
 #endif
       dSetErrorHandler (myErrorFunction);
       dSetDebugHandler (myDebugFunction);
       dSetMessageHandler (myMessageFunction);
+      odeInitMutex.unlock();
+      makeCurrent();
     }
 
     /**
@@ -131,9 +202,34 @@ namespace mars {
     WorldPhysics::~WorldPhysics(void) {
       // free the ode objects
       freeTheWorld();
+      delete trimesh_cache;
+      if(getCurrent() == this) {
+        pthread_setspecific(currentWorldKey, NULL);
+      }
       // and close the ODE ...
-      MutexLocker locker(&iMutex);
+      // (ODE counts the dInitODE2 calls and closes with the last world)
+      MutexLocker locker(&odeInitMutex);
       dCloseODE();
+      for(size_t i=0; i<feedback_blocks.size(); i++) {
+        delete[] feedback_blocks[i];
+      }
+    }
+
+    void WorldPhysics::makeCurrent(void) {
+      pthread_once(&currentWorldOnce, createCurrentWorldKey);
+      if(pthread_getspecific(currentWorldKey) != this) {
+        pthread_setspecific(currentWorldKey, this);
+#ifdef ODE11
+        // the collision data of ODE has to be allocated for every thread;
+        // the call returns directly if the data already exists
+        dAllocateODEDataForThread(dAllocateMaskAll);
+#endif
+      }
+    }
+
+    WorldPhysics* WorldPhysics::getCurrent(void) {
+      pthread_once(&currentWorldOnce, createCurrentWorldKey);
+      return (WorldPhysics*)pthread_getspecific(currentWorldKey);
     }
 
     /**
@@ -148,24 +244,33 @@ namespace mars {
      *     - at the end world_init have to become true
      */
     void WorldPhysics::initTheWorld(void) {
-      MutexLocker locker(&iMutex);
+      ReadWriteLocker locker(&iMutex, READWRITELOCK_MODE_WRITE);
+      makeCurrent();
   
       // if world_init = true debug something
       if (!world_init) {
         //LOG_DEBUG("init physics world");
         world = dWorldCreate();
-        space = dHashSpaceCreate(0);
+        createSpaces(getBroadphase());
+        ray_caster = new RayCaster(this);
+        ray_caster->setThreadPool(thread_pool);
         contactgroup = dJointGroupCreate(0);
 
         old_gravity = world_gravity;
         old_cfm = world_cfm;
         old_erp = world_erp;
+        old_quickstep_iterations = quickstep_iterations;
+        old_quickstep_w = quickstep_w;
+        quickstep_num_iterations = quickstep_iterations;
 
         dWorldSetGravity(world, world_gravity.x(), world_gravity.y(), world_gravity.z()); 
         dWorldSetCFM(world, (dReal)world_cfm);
         dWorldSetERP (world, (dReal)world_erp);
+        dWorldSetQuickStepNumIterations(world, quickstep_num_iterations);
+        dWorldSetQuickStepW(world, (dReal)quickstep_w);
 
-        dWorldSetAutoDisableFlag (world,0);
+        applyAutoDisable();
+        applySolverThreads();
         // if usefull for some tests a ground can be created here
         plane = 0; //dCreatePlane (space,0,0,1,0);
         world_init = 1;
@@ -187,11 +292,19 @@ namespace mars {
      *     - afte that, world_init have to become false
      */
     void WorldPhysics::freeTheWorld(void) {
-      MutexLocker locker(&iMutex);
+      ReadWriteLocker locker(&iMutex, READWRITELOCK_MODE_WRITE);
       if(world_init) {
         //LOG_DEBUG("free physics world");
         dJointGroupDestroy(contactgroup);
         dSpaceDestroy(space);
+        dSpaceDestroy(static_space);
+        space = static_space = 0;
+        delete ray_caster;
+        ray_caster = 0;
+        static_bvh.clear();
+        static_bvh_rebuild = true;
+        contact_cache.clear();
+        freeSolverThreads();
         dWorldDestroy(world);
         world_init = 0;
       }
@@ -224,13 +337,14 @@ namespace mars {
      *     - the contactgroup should be empty
      */
     void WorldPhysics::stepTheWorld(void) {
-      MutexLocker locker(&iMutex);
-      std::vector<dJointFeedback*>::iterator iter;
-      geom_data* data;
+      ReadWriteLocker locker(&iMutex, READWRITELOCK_MODE_WRITE);
       int i;
 
       // if world_init = false or step_size <= 0 debug something
       if(world_init && step_size > 0) {
+        makeCurrent();
+        // the bodies are collected at most once per step
+        bodies_collected = false;
         if(old_gravity != world_gravity) {
           old_gravity = world_gravity;
           dWorldSetGravity(world, world_gravity.x(),
@@ -247,42 +361,248 @@ namespace mars {
           dWorldSetERP(world, (dReal)world_erp);
         }
 
-        /// first clear the collision counters of all geoms
-        for(i=0; i<dSpaceGetNumGeoms(space); i++) {
-          data = (geom_data*)dGeomGetData(dSpaceGetGeom(space, i));
-          data->num_ground_collisions = 0;
-          data->contact_ids.clear();
-          data->contact_points.clear();
-          data->ground_feedbacks.clear();
-        }
-        for(iter = contact_feedback_list.begin();
-            iter != contact_feedback_list.end(); iter++) {
-          free((*iter));
-        }
-        contact_feedback_list.clear();
-        draw_intern.clear();
-        /// then we have to clear the contacts
-        dJointGroupEmpty(contactgroup);
-        /// first check for collisions
-        num_contacts = log_contacts = 0;
-        create_contacts = 1;
-        dSpaceCollide(space,this, &WorldPhysics::callbackForward);
-        
-        drawLock.lock();
-        draw_extern.swap(draw_intern);
-        drawLock.unlock();
+        if(old_auto_disable != auto_disable ||
+           old_auto_disable_linear != auto_disable_linear ||
+           old_auto_disable_angular != auto_disable_angular ||
+           old_auto_disable_steps != auto_disable_steps ||
+           old_auto_disable_time != auto_disable_time) {
+          applyAutoDisable();
+        }
+
+        if(old_solver_threads != solver_threads) {
+          applySolverThreads();
+        }
+
+        if(old_quickstep_iterations != quickstep_iterations) {
+          // the adaptive iterations start again from the new value
+          old_quickstep_iterations = quickstep_iterations;
+          quickstep_num_iterations = quickstep_iterations;
+          quickstep_calm_steps = 0;
+          dWorldSetQuickStepNumIterations(world, quickstep_num_iterations);
+        }
+
+        if(old_quickstep_w != quickstep_w) {
+          old_quickstep_w = quickstep_w;
+          dWorldSetQuickStepW(world, (dReal)quickstep_w);
+        }
+
+        contact_cache.setThresholds((dReal)contact_cache_distance,
+                                    (dReal)contact_cache_angle);
+        collision_time = solver_time = 0.0;
+        num_cached_pairs = 0;
+        updateTiledHeightfields();
+        collide();
+        if(solver_threads > 1) updateIslandStatistics();
+        else island_sizes.clear();
+
+        num_substeps = 1;
+        if(adaptive_step && max_substeps > 1) {
+          num_substeps = getNumSubsteps();
+        }
+        // ODE clears the forces added to the bodies with every step, thus
+        // they are applied again in every substep
+        if(num_substeps > 1) saveBodyForces();
 
         /// then calculate the next state for a time of step_size seconds
-        try {
-          if(fast_step) dWorldQuickStep(world, step_size);
-          else dWorldStep(world, step_size);
-        } catch (...) {
-          control->sim->handleError(PHYSICS_UNKNOWN);
+        dReal substep_size = step_size / num_substeps;
+        for(i=0; i<num_substeps; i++) {
+          if(i > 0) {
+            restoreBodyForces();
+            collide();
+          }
+          long long startTime = getTimeMicroseconds();
+          try {
+            if(fast_step) dWorldQuickStep(world, substep_size);
+            else dWorldStep(world, substep_size);
+          } catch (...) {
+            control->sim->handleError(PHYSICS_UNKNOWN);
+          }
+          solver_time += getTimeDiffMicroseconds(startTime);
+          if(error) {
+            control->sim->handleError(error);
+            error = PHYSICS_NO_ERROR;
+          }
+        }
+        if(fast_step && quickstep_max_error > 0) {
+          adaptQuickStepIterations();
+        }
+        if(auto_disable) updateSleepStatistics();
+        else if(num_sleeping_bodies) {
+          sleeping_bodies.clear();
+          num_sleeping_bodies = 0;
         }
-	if(WorldPhysics::error) {
-          control->sim->handleError(WorldPhysics::error);
-          WorldPhysics::error = PHYSICS_NO_ERROR;
-	}
+      }
+    }
+
+    /**
+     * \brief Adapts the iterations of the fast step to the joint error
+     * after the step.
+     *
+     * A too large error raises the iterations by half at once, since the
+     * error of a diverging solver grows quickly. The iterations are only
+     * lowered by one after calmSteps steps with less than half of the
+     * allowed error, to avoid oscillation around the limit.
+     */
+    void WorldPhysics::adaptQuickStepIterations(void) {
+      static const int calmSteps = 50;
+      int iterations = quickstep_num_iterations;
+      quickstep_error = getJointError();
+      if(quickstep_error > quickstep_max_error) {
+        iterations += std::max(1, iterations/2);
+        quickstep_calm_steps = 0;
+      }
+      else if(quickstep_error < 0.5*quickstep_max_error) {
+        if(++quickstep_calm_steps >= calmSteps) {
+          --iterations;
+          quickstep_calm_steps = 0;
+        }
+      }
+      else {
+        quickstep_calm_steps = 0;
+      }
+      iterations = std::min(iterations, quickstep_max_iterations);
+      iterations = std::max(iterations, quickstep_min_iterations);
+      iterations = std::max(iterations, 1);
+      if(iterations != quickstep_num_iterations) {
+        quickstep_num_iterations = iterations;
+        dWorldSetQuickStepNumIterations(world, iterations);
+      }
+    }
+
+    /**
+     * \brief Resets the contacts of the last step and creates the contacts
+     * of the current state.
+     */
+    void WorldPhysics::collide(void) {
+      /// first invalidate the contacts of all geoms (see geom_data)
+      ++contact_generation;
+      // the feedbacks of the last step are not referenced anymore
+      num_feedbacks = 0;
+      num_contact_joints = 0;
+      draw_intern.clear();
+      /// then we have to clear the contacts
+      dJointGroupEmpty(contactgroup);
+      /// first check for collisions
+      num_contacts = log_contacts = 0;
+      max_contact_depth = 0.0;
+      create_contacts = 1;
+      long long startTime = getTimeMicroseconds();
+      contact_cache.resetNumHits();
+      dSpaceCollide(space,this, &WorldPhysics::callbackForward);
+      dSpaceCollide2((dGeomID)space, (dGeomID)static_space, this,
+                     &WorldPhysics::callbackForward);
+      // the pairs that are not colliding anymore
+      contact_cache.removeOld(contact_generation);
+      num_cached_pairs += (int)contact_cache.getNumHits();
+      collision_time += getTimeDiffMicroseconds(startTime);
+
+      drawLock.lock();
+      draw_extern.swap(draw_intern);
+      drawLock.unlock();
+    }
+
+    /**
+     * \brief Returns the number of substeps needed to keep the contact
+     * penetration and the joint error of the next step below the limits.
+     *
+     * Both errors are assumed to shrink proportional to the step size.
+     */
+    int WorldPhysics::getNumSubsteps(void) {
+      dReal ratio = 0.0;
+
+      if(max_penetration > 0) {
+        ratio = max_contact_depth / max_penetration;
+      }
+      if(max_joint_error > 0) {
+        dReal jointError = getJointError();
+        if(jointError / max_joint_error > ratio) {
+          ratio = jointError / max_joint_error;
+        }
+      }
+      int substeps = (int)ceil(ratio);
+      if(substeps < 1) substeps = 1;
+      if(substeps > max_substeps) substeps = max_substeps;
+      return substeps;
+    }
+
+    /**
+     * \brief Returns the largest distance between the anchors of a joint
+     * seen from its two bodies. The bodies are collected as well.
+     */
+    dReal WorldPhysics::getJointError(void) {
+      dVector3 a1, a2;
+      dReal jointError = 0.0;
+      collectBodies();
+      for(size_t i=0; i<adaptive_bodies.size(); i++) {
+        dBodyID body = adaptive_bodies[i];
+        for(int j=0; j<dBodyGetNumJoints(body); j++) {
+          dJointID joint = dBodyGetJoint(body, j);
+          // the distance of the anchors seen from both bodies
+          switch(dJointGetType(joint)) {
+          case dJointTypeBall:
+            dJointGetBallAnchor(joint, a1);
+            dJointGetBallAnchor2(joint, a2);
+            break;
+          case dJointTypeHinge:
+            dJointGetHingeAnchor(joint, a1);
+            dJointGetHingeAnchor2(joint, a2);
+            break;
+          case dJointTypeHinge2:
+            dJointGetHinge2Anchor(joint, a1);
+            dJointGetHinge2Anchor2(joint, a2);
+            break;
+          case dJointTypeUniversal:
+            dJointGetUniversalAnchor(joint, a1);
+            dJointGetUniversalAnchor2(joint, a2);
+            break;
+          default:
+            continue;
+          }
+          dReal d = sqrt((a1[0]-a2[0])*(a1[0]-a2[0]) +
+                         (a1[1]-a2[1])*(a1[1]-a2[1]) +
+                         (a1[2]-a2[2])*(a1[2]-a2[2]));
+          if(d > jointError) jointError = d;
+        }
+      }
+      return jointError;
+    }
+
+    /**
+     * \brief Collects the bodies of all geoms; composite objects share
+     * one body. The bodies do not change during a step, thus they are
+     * only collected by the first call of a step.
+     */
+    void WorldPhysics::collectBodies(void) {
+      if(bodies_collected) return;
+      bodies_collected = true;
+      adaptive_bodies.clear();
+      for(int i=0; i<dSpaceGetNumGeoms(space); i++) {
+        dBodyID body = dGeomGetBody(dSpaceGetGeom(space, i));
+        if(body) adaptive_bodies.push_back(body);
+      }
+      std::sort(adaptive_bodies.begin(), adaptive_bodies.end());
+      adaptive_bodies.erase(std::unique(adaptive_bodies.begin(),
+                                        adaptive_bodies.end()),
+                            adaptive_bodies.end());
+    }
+
+    void WorldPhysics::saveBodyForces(void) {
+      if(max_joint_error <= 0) collectBodies();
+      adaptive_forces.resize(adaptive_bodies.size()*2);
+      for(size_t i=0; i<adaptive_bodies.size(); i++) {
+        const dReal *f = dBodyGetForce(adaptive_bodies[i]);
+        const dReal *t = dBodyGetTorque(adaptive_bodies[i]);
+        adaptive_forces[i*2] = Vector(f[0], f[1], f[2]);
+        adaptive_forces[i*2+1] = Vector(t[0], t[1], t[2]);
+      }
+    }
+
+    void WorldPhysics::restoreBodyForces(void) {
+      for(size_t i=0; i<adaptive_bodies.size(); i++) {
+        const Vector &f = adaptive_forces[i*2];
+        const Vector &t = adaptive_forces[i*2+1];
+        dBodySetForce(adaptive_bodies[i], f.x(), f.y(), f.z());
+        dBodySetTorque(adaptive_bodies[i], t.x(), t.y(), t.z());
       }
     }
 
@@ -312,6 +632,497 @@ namespace mars {
       return space;
     }
 
+    unsigned long WorldPhysics::getContactGeneration(void) const {
+      return contact_generation;
+    }
+
+    dSpaceID WorldPhysics::getStaticSpace(void) const {
+      return static_space;
+    }
+
+    void WorldPhysics::makeGeomStatic(dGeomID geom) {
+      if(dGeomGetSpace(geom) == space) {
+        dSpaceRemove(space, geom);
+        dSpaceAdd(static_space, geom);
+        // a pending build includes the geom anyway
+        if(!static_bvh_rebuild) {
+          static_bvh.insert(geom);
+          static_bvh_rebuild = static_bvh.needsRebuild();
+        }
+      }
+    }
+
+    void WorldPhysics::staticGeomMoved(dGeomID geom) {
+      if(static_space && dGeomGetSpace(geom) == static_space) {
+        static_bvh_refit = true;
+      }
+    }
+
+    void WorldPhysics::addTiledHeightfield(TiledHeightfield *field) {
+      tiled_heightfields.push_back(field);
+    }
+
+    void WorldPhysics::removeTiledHeightfield(TiledHeightfield *field) {
+      tiled_heightfields.erase(std::remove(tiled_heightfields.begin(),
+                                           tiled_heightfields.end(), field),
+                               tiled_heightfields.end());
+    }
+
+    /**
+     * \brief Activates the terrain tiles near the dynamic geoms. Disabled
+     * bodies keep their tiles, so they still rest on the terrain when
+     * they are woken up.
+     */
+    void WorldPhysics::updateTiledHeightfields(void) {
+      // sensors with a longer or unlimited range see the whole terrain
+      static const dReal maxSensorRange = 1e6;
+      if(tiled_heightfields.empty()) return;
+      int n = dSpaceGetNumGeoms(space);
+      body_aabbs.resize((size_t)n*6);
+      for(int i=0; i<n; ++i) {
+        dGeomID geom = dSpaceGetGeom(space, i);
+        dReal *box = &body_aabbs[(size_t)i*6];
+        dGeomGetAABB(geom, box);
+        // the rays of the sensors have to hit the tiles they reach
+        geom_data *gd = (geom_data*)dGeomGetData(geom);
+        if(gd && gd->sensor_range > terrain_tile_margin) {
+          dReal grow = std::min(gd->sensor_range, maxSensorRange);
+          grow -= (dReal)terrain_tile_margin;
+          for(int k=0; k<3; ++k) {
+            box[k*2] -= grow;
+            box[k*2+1] += grow;
+          }
+        }
+      }
+      for(size_t i=0; i<tiled_heightfields.size(); ++i) {
+        tiled_heightfields[i]->update(body_aabbs, (dReal)terrain_tile_margin,
+                                      terrain_tile_keep_steps);
+      }
+    }
+
+    void WorldPhysics::destroyGeom(dGeomID geom) {
+      if(static_space && dGeomGetSpace(geom) == static_space &&
+         !static_bvh_rebuild) {
+        static_bvh.remove(geom);
+        static_bvh_rebuild = static_bvh.needsRebuild();
+      }
+      // bodies resting on the geom have to fall down
+      wakeBodiesNear(geom);
+      // ODE may reuse the memory for a new geom
+      contact_cache.removeGeom(geom);
+      dGeomDestroy(geom);
+    }
+
+    /**
+     * \brief Sets the auto disable parameters of the world and of all
+     * bodies that do not have their own parameters.
+     */
+    void WorldPhysics::applyAutoDisable(void) {
+      old_auto_disable = auto_disable;
+      old_auto_disable_linear = auto_disable_linear;
+      old_auto_disable_angular = auto_disable_angular;
+      old_auto_disable_steps = auto_disable_steps;
+      old_auto_disable_time = auto_disable_time;
+      dWorldSetAutoDisableFlag(world, auto_disable);
+      dWorldSetAutoDisableLinearThreshold(world, (dReal)auto_disable_linear);
+      dWorldSetAutoDisableAngularThreshold(world, (dReal)auto_disable_angular);
+      dWorldSetAutoDisableSteps(world, auto_disable_steps);
+      dWorldSetAutoDisableTime(world, (dReal)auto_disable_time);
+
+      for(int i=0; space && i<dSpaceGetNumGeoms(space); i++) {
+        dGeomID geom = dSpaceGetGeom(space, i);
+        dBodyID body = dGeomGetBody(geom);
+        geom_data *gd = (geom_data*)dGeomGetData(geom);
+        if(!body || (gd && gd->auto_disable_set)) continue;
+        dBodySetAutoDisableDefaults(body);
+        if(!auto_disable) dBodyEnable(body);
+      }
+    }
+
+    /**
+     * \brief Counts the bodies and the disabled bodies after a step.
+     * The number of wakeups is derived from the disabled bodies of the
+     * last step. Only called while auto_disable is set.
+     */
+    void WorldPhysics::updateSleepStatistics(void) {
+      collectBodies();
+      sleeping_tmp.clear();
+      for(size_t i=0; i<adaptive_bodies.size(); i++) {
+        if(!dBodyIsEnabled(adaptive_bodies[i])) {
+          sleeping_tmp.push_back(adaptive_bodies[i]);
+        }
+      }
+      // both lists are sorted, since collectBodies() sorts the bodies
+      for(size_t i=0; i<sleeping_bodies.size(); i++) {
+        dBodyID body = sleeping_bodies[i];
+        if(std::binary_search(adaptive_bodies.begin(), adaptive_bodies.end(),
+                              body) &&
+           !std::binary_search(sleeping_tmp.begin(), sleeping_tmp.end(),
+                               body)) {
+          ++num_wakeups;
+        }
+      }
+      sleeping_bodies.swap(sleeping_tmp);
+      num_bodies = (int)adaptive_bodies.size();
+      num_sleeping_bodies = (int)sleeping_bodies.size();
+    }
+
+    /**
+     * \brief Enables the bodies whose geoms overlap the bounding box of
+     * the given geom.
+     */
+    void WorldPhysics::wakeBodiesNear(dGeomID geom) {
+      if(!space) return;
+      dReal aabb[6], other[6];
+      dGeomGetAABB(geom, aabb);
+      for(int i=0; i<dSpaceGetNumGeoms(space); i++) {
+        dGeomID otherGeom = dSpaceGetGeom(space, i);
+        dBodyID body = dGeomGetBody(otherGeom);
+        if(!body || otherGeom == geom || dBodyIsEnabled(body)) continue;
+        dGeomGetAABB(otherGeom, other);
+        if(aabb[0] <= other[1] && aabb[1] >= other[0] &&
+           aabb[2] <= other[3] && aabb[3] >= other[2] &&
+           aabb[4] <= other[5] && aabb[5] >= other[4]) {
+          dBodyEnable(body);
+        }
+      }
+    }
+
+    /**
+     * \brief Creates the thread pool that solves the islands of the world
+     * in parallel or removes it if solver_threads is less than 2.
+     */
+    void WorldPhysics::applySolverThreads(void) {
+      old_solver_threads = solver_threads;
+#ifdef ODE_THREADING
+      freeSolverThreads();
+      if(solver_threads < 2) return;
+      threading = dThreadingAllocateMultiThreadedImplementation();
+      // the pool threads only solve, they need no collision data
+      threading_pool = dThreadingAllocateThreadPool(solver_threads, 0,
+                                                    dAllocateFlagBasicData,
+                                                    NULL);
+      if(!threading || !threading_pool) {
+        LOG_ERROR("WorldPhysics: could not create %d solver threads",
+                  solver_threads);
+        freeSolverThreads();
+        return;
+      }
+      dThreadingThreadPoolServeMultiThreadedImplementation(threading_pool,
+                                                           threading);
+      dWorldSetStepThreadingImplementation(world,
+                                           dThreadingImplementationGetFunctions(threading),
+                                           threading);
+      dWorldSetStepIslandsProcessingMaxThreadCount(world, solver_threads);
+#else
+      if(solver_threads > 1) {
+        LOG_WARN("WorldPhysics: the ODE version has no threading support; "
+                 "the world is solved in one thread");
+      }
+#endif
+    }
+
+    void WorldPhysics::freeSolverThreads(void) {
+#ifdef ODE_THREADING
+      if(threading) {
+        dThreadingImplementationShutdownProcessing(threading);
+      }
+      if(threading_pool) {
+        dThreadingFreeThreadPool(threading_pool);
+        threading_pool = 0;
+      }
+      if(threading) {
+        dWorldSetStepThreadingImplementation(world, NULL, NULL);
+        dThreadingFreeImplementation(threading);
+        threading = 0;
+      }
+#endif
+    }
+
+    static int findIsland(std::vector<int> &parent, int i) {
+      while(parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+      }
+      return i;
+    }
+
+    /**
+     * \brief Determines the islands that ODE solves in the next step: the
+     * bodies connected by enabled joints, including the contact joints
+     * of the step. Islands of disabled bodies only are not solved and
+     * not counted. Only called while the islands are solved by several
+     * threads.
+     */
+    void WorldPhysics::updateIslandStatistics(void) {
+      collectBodies();
+      int num = (int)adaptive_bodies.size();
+      island_parent.resize(num);
+      island_count.assign(num, 0);
+      island_enabled.assign(num, false);
+      for(int i=0; i<num; i++) island_parent[i] = i;
+
+      for(int i=0; i<num; i++) {
+        dBodyID body = adaptive_bodies[i];
+        for(int j=0; j<dBodyGetNumJoints(body); j++) {
+          dJointID joint = dBodyGetJoint(body, j);
+          if(!dJointIsEnabled(joint)) continue;
+          dBodyID other = dJointGetBody(joint, 0);
+          if(other == body) other = dJointGetBody(joint, 1);
+          if(!other) continue;
+          std::vector<dBodyID>::iterator it;
+          it = std::lower_bound(adaptive_bodies.begin(),
+                                adaptive_bodies.end(), other);
+          if(it == adaptive_bodies.end() || *it != other) continue;
+          int a = findIsland(island_parent, i);
+          int b = findIsland(island_parent, (int)(it-adaptive_bodies.begin()));
+          if(a != b) island_parent[b] = a;
+        }
+      }
+
+      for(int i=0; i<num; i++) {
+        int root = findIsland(island_parent, i);
+        ++island_count[root];
+        if(dBodyIsEnabled(adaptive_bodies[i])) island_enabled[root] = true;
+      }
+      island_sizes.clear();
+      for(int i=0; i<num; i++) {
+        if(island_count[i] && island_enabled[i]) {
+          island_sizes.push_back(island_count[i]);
+        }
+      }
+      std::sort(island_sizes.begin(), island_sizes.end(), std::greater<int>());
+    }
+
+    TriMeshCache* WorldPhysics::getTriMeshCache(void) {
+      return trimesh_cache;
+    }
+
+    /**
+     * \brief Builds or refits the hierarchy of the static geoms if they
+     * were changed since the last query. iMutex has to be locked.
+     */
+    void WorldPhysics::updateStaticBVH(void) const {
+      if(static_bvh_rebuild) {
+        static_bvh.build(static_space);
+        static_bvh_rebuild = static_bvh_refit = false;
+      }
+      else if(static_bvh_refit) {
+        static_bvh.refit();
+        static_bvh_refit = false;
+      }
+    }
+
+    /**
+     * \brief Returns the broadphase that is configured by the public
+     * members; in "auto" mode it is chosen from the current geoms.
+     */
+    WorldPhysics::Broadphase WorldPhysics::getBroadphase(void) const {
+      if(broadphase == "auto") return chooseBroadphase();
+
+      Broadphase bp;
+      bp.type = broadphase;
+      bp.hash_min_level = hash_min_level;
+      bp.hash_max_level = hash_max_level;
+      bp.quadtree_center = quadtree_center;
+      bp.quadtree_extents = quadtree_extents;
+      bp.quadtree_depth = quadtree_depth;
+      if(bp.type != "hash" && bp.type != "quadtree" && bp.type != "sap" &&
+         bp.type != "simple") {
+        LOG_WARN("WorldPhysics: unknown broadphase \"%s\", using \"hash\"",
+                 bp.type.c_str());
+        bp.type = "hash";
+      }
+      if(bp.hash_max_level < bp.hash_min_level) {
+        bp.hash_max_level = bp.hash_min_level;
+      }
+      return bp;
+    }
+
+    /**
+     * \brief Chooses the broadphase from the distribution of the bounding
+     * boxes of all finite geoms:
+     *  - only a few geoms: the brute force test of the simple space is the
+     *    fastest,
+     *  - a flat scene that is large compared to the geoms (terrains with
+     *    obstacles): a quadtree covering the scene,
+     *  - strongly varying geom sizes: a hash space whose levels cover the
+     *    smallest and the largest geom,
+     *  - otherwise similar sized geoms: sweep and prune.
+     */
+    WorldPhysics::Broadphase WorldPhysics::chooseBroadphase(void) const {
+      Broadphase bp;
+      bp.type = "simple";
+      bp.hash_min_level = hash_min_level;
+      bp.hash_max_level = hash_max_level;
+      bp.quadtree_center = quadtree_center;
+      bp.quadtree_extents = quadtree_extents;
+      bp.quadtree_depth = quadtree_depth;
+
+      dReal aabb[6], minSize = dInfinity, maxSize = 0.0, sumSize = 0.0;
+      Vector low, high;
+      int count = 0;
+      dSpaceID spaces[2] = {space, static_space};
+      for(int s=0; s<2; s++) {
+        if(!spaces[s]) continue;
+        for(int i=0; i<dSpaceGetNumGeoms(spaces[s]); i++) {
+          dGeomGetAABB(dSpaceGetGeom(spaces[s], i), aabb);
+          // skip planes and other infinite geoms
+          bool finite = true;
+          for(int k=0; k<6; k++) {
+            if(!(std::fabs(aabb[k]) < dInfinity)) finite = false;
+          }
+          if(!finite) continue;
+
+          dReal size = std::max(aabb[1]-aabb[0],
+                                std::max(aabb[3]-aabb[2], aabb[5]-aabb[4]));
+          minSize = std::min(minSize, size);
+          maxSize = std::max(maxSize, size);
+          sumSize += size;
+          Vector l(aabb[0], aabb[2], aabb[4]), h(aabb[1], aabb[3], aabb[5]);
+          if(count == 0) {
+            low = l;
+            high = h;
+          }
+          else {
+            low = low.cwiseMin(l);
+            high = high.cwiseMax(h);
+          }
+          ++count;
+        }
+      }
+
+      if(count < 32) return bp;
+
+      Vector extent = high - low;
+      dReal meanSize = sumSize / count;
+      dReal planar = std::max(extent.x(), extent.y());
+      // avoid log2(0) for points or rays of zero length
+      minSize = std::max(minSize, (dReal)1e-3);
+      maxSize = std::max(maxSize, minSize);
+
+      if(extent.z() < 0.25*planar && planar > 50.0*meanSize) {
+        bp.type = "quadtree";
+        bp.quadtree_center = (low + high) * 0.5;
+        // keep a margin for moving geoms
+        bp.quadtree_extents = extent * 0.55 + Vector(maxSize, maxSize, maxSize);
+        // about four geoms per leaf
+        int depth = (int)(std::log((double)count) / std::log(4.0));
+        bp.quadtree_depth = std::max(3, std::min(8, depth));
+      }
+      else if(maxSize > 64.0*minSize) {
+        bp.type = "hash";
+        bp.hash_min_level = (int)std::floor(std::log(minSize)/std::log(2.0));
+        bp.hash_max_level = (int)std::ceil(std::log(maxSize)/std::log(2.0));
+      }
+      else {
+        bp.type = "sap";
+      }
+      return bp;
+    }
+
+    /**
+     * \brief Creates a space of the given broadphase. The static space
+     * is only queried against the dynamic geoms, which sweep and prune
+     * handles by brute force, thus it becomes a hash space in that case.
+     */
+    dSpaceID WorldPhysics::createSpace(const Broadphase &bp,
+                                       bool isStatic) const {
+      if(bp.type == "simple") {
+        return dSimpleSpaceCreate(0);
+      }
+      if(bp.type == "quadtree") {
+        dVector3 center, extents;
+        for(int i=0; i<3; i++) {
+          center[i] = bp.quadtree_center[i];
+          extents[i] = bp.quadtree_extents[i];
+        }
+        return dQuadTreeSpaceCreate(0, center, extents, bp.quadtree_depth);
+      }
+      if(bp.type == "sap" && !isStatic) {
+        return dSweepAndPruneSpaceCreate(0, dSAP_AXES_XYZ);
+      }
+      dSpaceID newSpace = dHashSpaceCreate(0);
+      dHashSpaceSetLevels(newSpace, bp.hash_min_level, bp.hash_max_level);
+      return newSpace;
+    }
+
+    /**
+     * \brief Replaces the dynamic and the static space; the geoms of the
+     * old spaces are moved into the new ones.
+     */
+    void WorldPhysics::createSpaces(const Broadphase &bp) {
+      dSpaceID oldSpaces[2] = {space, static_space};
+      space = createSpace(bp, false);
+      static_space = createSpace(bp, true);
+      dSpaceID newSpaces[2] = {space, static_space};
+
+      for(int s=0; s<2; s++) {
+        if(!oldSpaces[s]) continue;
+        while(dSpaceGetNumGeoms(oldSpaces[s])) {
+          dGeomID geom = dSpaceGetGeom(oldSpaces[s], 0);
+          dSpaceRemove(oldSpaces[s], geom);
+          dSpaceAdd(newSpaces[s], geom);
+        }
+        dSpaceDestroy(oldSpaces[s]);
+      }
+      static_bvh_rebuild = true;
+
+      if(bp.type == "quadtree") {
+        LOG_INFO("WorldPhysics: broadphase quadtree (center %g %g %g, "
+                 "extents %g %g %g, depth %d)", bp.quadtree_center.x(),
+                 bp.quadtree_center.y(), bp.quadtree_center.z(),
+                 bp.quadtree_extents.x(), bp.quadtree_extents.y(),
+                 bp.quadtree_extents.z(), bp.quadtree_depth);
+      }
+      else if(bp.type == "hash") {
+        LOG_INFO("WorldPhysics: broadphase hash (levels %d to %d)",
+                 bp.hash_min_level, bp.hash_max_level);
+      }
+      else {
+        LOG_INFO("WorldPhysics: broadphase %s", bp.type.c_str());
+      }
+    }
+
+    unsigned long WorldPhysics::getRandomSeed(void) const {
+      return dRandGetSeed();
+    }
+
+    void WorldPhysics::setRandomSeed(unsigned long seed) {
+      dRandSetSeed(seed);
+    }
+
+    void WorldPhysics::addRays(const std::vector<RayCaster::Ray> &rays) {
+      if(ray_caster) ray_caster->addRays(rays);
+    }
+
+    /**
+     * \brief Casts the rays of the sensors. The world stays locked until
+     * the narrowphase is done: dCollide reads the poses of the candidate
+     * geoms, and the motor and joint setters as well as node moves would
+     * change them meanwhile. The narrowphase itself runs on the threads
+     * of the pool, which do not take the lock.
+     */
+    void WorldPhysics::castRays(void) {
+      ReadWriteLocker locker(&iMutex, READWRITELOCK_MODE_WRITE);
+      if(!world_init) return;
+      makeCurrent();
+      updateStaticBVH();
+      ray_caster->collectCandidates(space, &static_bvh);
+      ray_caster->castCandidates();
+    }
+
+    void WorldPhysics::setThreadPool(ThreadPool *pool) {
+      ReadWriteLocker locker(&iMutex, READWRITELOCK_MODE_WRITE);
+      thread_pool = pool;
+      if(ray_caster) ray_caster->setThreadPool(pool);
+    }
+
+    void WorldPhysics::updateBroadphase(void) {
+      ReadWriteLocker locker(&iMutex, READWRITELOCK_MODE_WRITE);
+      if(world_init) createSpaces(getBroadphase());
+    }
+
     /**
      * \brief Sets the body pointer param to the body for the comp_group_id
      *
@@ -415,6 +1226,34 @@ namespace mars {
       return step_size;
     }
 
+    // number of joint feedbacks allocated at once by newFeedback()
+    static const size_t feedbackBlockSize = 256;
+
+    /**
+     * \brief Appends a value and counts the allocation if the vector has
+     * to grow.
+     */
+    template<typename T>
+    static inline void pushCounted(std::vector<T> *values, const T &value,
+                                   unsigned long *allocations) {
+      if(values->size() == values->capacity()) ++(*allocations);
+      values->push_back(value);
+    }
+
+    /**
+     * \brief Returns a joint feedback that is valid until the next
+     * collide(). The feedbacks are allocated in blocks which are reused
+     * in every step.
+     */
+    dJointFeedback* WorldPhysics::newFeedback(void) {
+      size_t block = num_feedbacks / feedbackBlockSize;
+      if(block == feedback_blocks.size()) {
+        feedback_blocks.push_back(new dJointFeedback[feedbackBlockSize]);
+        ++contact_allocations;
+      }
+      return feedback_blocks[block] + (num_feedbacks++ % feedbackBlockSize);
+    }
+
     /**
      * \brief In this function the collision handling from ode is performed.
      *
@@ -502,7 +1341,12 @@ namespace mars {
       else {
         maxNumContacts = geom_data2->c_params.max_num_contacts;
       }
-      dContact *contact = new dContact[maxNumContacts];
+      if(maxNumContacts < 1) return;
+      if(contact_buffer.size() < (size_t)maxNumContacts) {
+        contact_buffer.resize(maxNumContacts);
+        ++contact_allocations;
+      }
+      dContact *contact = &contact_buffer[0];
 
 
       //for granular test
@@ -654,7 +1498,18 @@ namespace mars {
         contact[i] = contact[0];
       }
 
-      numc=dCollide(o1,o2, maxNumContacts, &contact[0].geom,sizeof(dContact));
+      if(!contact_cache.get(o1, o2, contact_generation, contact,
+                            maxNumContacts, &numc)) {
+        numc=dCollide(o1,o2, maxNumContacts, &contact[0].geom,sizeof(dContact));
+        if(max_manifold_contacts > 0) {
+          numc = ContactCache::reduceContacts(contact, numc,
+                                              max_manifold_contacts);
+        }
+        if(contact_cache.isEnabled() &&
+           contact_cache.set(o1, o2, contact_generation, contact, numc)) {
+          ++contact_allocations;
+        }
+      }
       if(numc){ 
         dJointFeedback *fb;
         draw_item item;
@@ -662,6 +1517,8 @@ namespace mars {
 
         num_contacts++;
         if(create_contacts) {
+          geom_data1->beginContacts(contact_generation);
+          geom_data2->beginContacts(contact_generation);
           fb = 0;
           item.id = 0;
           item.type = DRAW_LINE;
@@ -683,7 +1540,9 @@ namespace mars {
             item.end.x() = contact[i].geom.pos[0] + contact[i].geom.normal[0];
             item.end.y() = contact[i].geom.pos[1] + contact[i].geom.normal[1];
             item.end.z() = contact[i].geom.pos[2] + contact[i].geom.normal[2];
-            draw_intern.push_back(item);
+            if(draw_contact_points) {
+              pushCounted(&draw_intern, item, &contact_allocations);
+            }
             if(geom_data1->c_params.friction_direction1 ||
                geom_data2->c_params.friction_direction1) {
               v[0] = contact[i].geom.normal[0];
@@ -700,8 +1559,12 @@ namespace mars {
                                       geom_data2->c_params.depth_correction);
         
             if(contact[0].geom.depth < 0.0) contact[0].geom.depth = 0.0;
+            if(contact[i].geom.depth > max_contact_depth) {
+              max_contact_depth = contact[i].geom.depth;
+            }
             dJointID c=dJointCreateContact(world,contactgroup,contact+i);
             dJointAttach(c,b1,b2);
+            ++num_contact_joints;
 
             geom_data1->num_ground_collisions += numc;
             geom_data2->num_ground_collisions += numc;
@@ -710,33 +1573,36 @@ namespace mars {
             contact_point.y() = contact[i].geom.pos[1];
             contact_point.z() = contact[i].geom.pos[2];
 
-            geom_data1->contact_ids.push_back(geom_data2->id);
-            geom_data2->contact_ids.push_back(geom_data1->id);
-            geom_data1->contact_points.push_back(contact_point);
-            geom_data2->contact_points.push_back(contact_point);
+            pushCounted(&geom_data1->contact_ids, geom_data2->id,
+                        &contact_allocations);
+            pushCounted(&geom_data2->contact_ids, geom_data1->id,
+                        &contact_allocations);
+            pushCounted(&geom_data1->contact_points, contact_point,
+                        &contact_allocations);
+            pushCounted(&geom_data2->contact_points, contact_point,
+                        &contact_allocations);
             //if(dGeomGetClass(o1) == dPlaneClass) {
             fb = 0;
             if(geom_data2->sense_contact_force) {
-              fb = (dJointFeedback*)malloc(sizeof(dJointFeedback));
+              fb = newFeedback();
               dJointSetFeedback(c, fb);
-              contact_feedback_list.push_back(fb);
-              geom_data2->ground_feedbacks.push_back(fb);
+              pushCounted(&geom_data2->ground_feedbacks, fb,
+                          &contact_allocations);
               geom_data2->node1 = false;
             } 
             //else if(dGeomGetClass(o2) == dPlaneClass) {
             if(geom_data1->sense_contact_force) {
               if(!fb) {
-                fb = (dJointFeedback*)malloc(sizeof(dJointFeedback));
+                fb = newFeedback();
                 dJointSetFeedback(c, fb);
-                contact_feedback_list.push_back(fb);
               }
-              geom_data1->ground_feedbacks.push_back(fb);
+              pushCounted(&geom_data1->ground_feedbacks, fb,
+                          &contact_allocations);
               geom_data1->node1 = true;
             }
           }
         }
       }
-      delete[] contact;
     }
 
     /**
@@ -803,7 +1669,7 @@ namespace mars {
     }
 
     const Vector WorldPhysics::getCenterOfMass(const std::vector<NodeInterface*> &nodes) const {
-      MutexLocker locker(&iMutex);
+      ReadWriteLocker locker(&iMutex, READWRITELOCK_MODE_WRITE);
       Vector center;
       std::vector<NodeInterface*>::const_iterator iter;
       dMass sumMass;
@@ -838,19 +1704,33 @@ namespace mars {
       ray_collision = 0;
       dSpaceCollide2(theGeom, (dGeomID)space, this,
                      &WorldPhysics::callbackForward);
+      dSpaceCollide2(theGeom, (dGeomID)static_space, this,
+                     &WorldPhysics::callbackForward);
       return ray_collision;
     }
 
     double WorldPhysics::getCollisionDepth(dGeomID theGeom) {
+      ReadWriteLocker locker(&iMutex, READWRITELOCK_MODE_WRITE);
       dGeomID otherGeom;
       dContact contact[1];
       double depth = 0.0;
       int numc;
       dBodyID b1;
       dBodyID b2;
+      dReal aabb[6];
+      // all dynamic geoms and the static geoms near the geom
+      std::vector<dGeomID> geoms;
 
       for(int i=0; i<dSpaceGetNumGeoms(space); i++) {
-        otherGeom = dSpaceGetGeom(space, i);
+        geoms.push_back(dSpaceGetGeom(space, i));
+      }
+      updateStaticBVH();
+      dGeomGetAABB(theGeom, aabb);
+      static_bvh.query(theGeom, aabb, &geoms);
+
+      for(size_t i=0; i<geoms.size(); i++) {
+        otherGeom = geoms[i];
+        if(otherGeom == theGeom) continue;
 
         if(!(dGeomGetCollideBits(theGeom) & dGeomGetCollideBits(otherGeom)))
           continue;
@@ -873,23 +1753,26 @@ namespace mars {
     }
 
     int WorldPhysics::checkCollisions(void) {
-      MutexLocker locker(&iMutex);
+      ReadWriteLocker locker(&iMutex, READWRITELOCK_MODE_WRITE);
       num_contacts = log_contacts = 0;
       create_contacts = 0;
       dSpaceCollide(space,this, &WorldPhysics::callbackForward);	
+      dSpaceCollide2((dGeomID)space, (dGeomID)static_space, this,
+                     &WorldPhysics::callbackForward);
       return num_contacts;
     }
 
     double WorldPhysics::getVectorCollision(const Vector &pos, 
                                             const Vector &ray) const {
-      MutexLocker locker(&iMutex);
+      ReadWriteLocker locker(&iMutex, READWRITELOCK_MODE_WRITE);
       dGeomID otherGeom;
       dContact contact[1];
       //double depth = ray.length();
       double depth = ray.norm();
       int numc;
   
-      dGeomID theGeom = dCreateRay(space, depth);
+      if(depth <= 0.0) return 0.0;
+      dGeomID theGeom = dCreateRay(0, depth);
       dGeomRaySet(theGeom, pos.x(), pos.y(), pos.z(), ray.x(), ray.y(), ray.z()); 
 
       for(int i=0; i<dSpaceGetNumGeoms(space); i++) {
@@ -905,6 +1788,16 @@ namespace mars {
         }
       }
 
+      // the static geoms are tested front to back through the hierarchy
+      dVector3 origin, direction;
+      Vector dir = ray.normalized();
+      for(int k=0; k<3; k++) {
+        origin[k] = pos[k];
+        direction[k] = dir[k];
+      }
+      updateStaticBVH();
+      depth = static_bvh.castRay(theGeom, origin, direction, depth, 0);
+
       dGeomDestroy(theGeom);
       return depth;
     }
@@ -36,13 +36,21 @@
 //#define _DEBUG_MASS_
 
 #include <mars/utils/Mutex.h>
+#include <mars/utils/ReadWriteLock.h>
 #include <mars/utils/Vector.h>
 #include <mars/interfaces/sim_common.h>
 #include <mars/interfaces/sim/ControlCenter.h>
 #include <mars/interfaces/sim/PhysicsInterface.h>
 #include <mars/interfaces/graphics/draw_structs.h>
 
+#include "ContactCache.h"
+#include "RayCaster.h"
+#include "StaticBVH.h"
+#include "TiledHeightfield.h"
+#include "TriMeshCache.h"
+
 #include <vector>
+#include <string>
 
 #include <ode/ode.h>
 
@@ -94,10 +102,56 @@ namespace mars {
       virtual void update(std::vector<interfaces::draw_item> *drawItems);
       virtual int checkCollisions(void);
       virtual interfaces::sReal getVectorCollision(const utils::Vector &pos, const utils::Vector &ray) const;
+      virtual void updateBroadphase(void);
+      virtual void castRays(void);
+      virtual unsigned long getRandomSeed(void) const;
+      virtual void setRandomSeed(unsigned long seed);
 
       // this functions are used by the other physical classes
       dWorldID getWorld(void) const;
       dSpaceID getSpace(void) const;
+      dSpaceID getStaticSpace(void) const;
+      /**
+       * \brief Returns the number of the current collision step; only
+       * the contacts of geoms with this generation are valid.
+       */
+      unsigned long getContactGeneration(void) const;
+      /**
+       * \brief Moves a geom without body into the space of the static
+       * geoms; static geoms are not tested against each other.
+       */
+      void makeGeomStatic(dGeomID geom);
+      /**
+       * \brief Has to be called after a static geom was moved; the
+       * bounding volumes of the static geoms are refitted before the
+       * next query.
+       */
+      void staticGeomMoved(dGeomID geom);
+      /**
+       * \brief Destroys a geom and removes it from the hierarchy of the
+       * static geoms.
+       */
+      void destroyGeom(dGeomID geom);
+      /**
+       * \brief Returns the shared trimesh data of the mesh nodes; it may
+       * only be used while iMutex is locked for writing.
+       */
+      TriMeshCache* getTriMeshCache(void);
+      /**
+       * \brief Registers a tiled terrain; its tiles are updated before
+       * every collision step.
+       */
+      void addTiledHeightfield(TiledHeightfield *field);
+      void removeTiledHeightfield(TiledHeightfield *field);
+      /**
+       * \brief Adds sensor rays to the batch that is cast by castRays().
+       */
+      void addRays(const std::vector<RayCaster::Ray> &rays);
+      /**
+       * \brief Sets the pool of the parallel ray casting; NULL casts the
+       * rays in the calling thread.
+       */
+      void setThreadPool(ThreadPool *pool);
       bool getCompositeBody(int comp_group, dBodyID *body, NodePhysics *node);
       void destroyBody(dBodyID theBody, NodePhysics *node);
       dReal getWorldStep(void);
@@ -105,13 +159,52 @@ namespace mars {
       void moveCompositeMassCenter(dBodyID theBody, dReal x, dReal y, dReal z);
       int handleCollision(dGeomID theGeom);
       interfaces::sReal getCollisionDepth(dGeomID theGeom);
-      mutable utils::Mutex iMutex;
+      /**
+       * \brief Guards the ODE objects of the world. Methods that only
+       * read the state of single bodies or joints lock it for reading, so
+       * the nodes and joints can be updated by several threads at once;
+       * everything else locks it for writing. dGeomGetPosition() and
+       * dGeomGetQuaternion() update the cached pose of their own geom,
+       * which is safe as long as no two threads read the same node.
+       */
+      mutable utils::ReadWriteLock iMutex;
+
+      /**
+       * \brief Makes this world the receiver of the ODE messages that are
+       * created in the calling thread and prepares ODE for the thread.
+       *
+       * ODE only supports global message handlers. To run several worlds
+       * in one process the handlers forward the messages to the world that
+       * was made current in the calling thread.
+       */
+      void makeCurrent(void);
+      static WorldPhysics* getCurrent(void);
 
-      static interfaces::PhysicsError error;
+      /// error state of the last ODE call of this world
+      interfaces::PhysicsError error;
 
     private:
+      struct Broadphase {
+        std::string type;
+        int hash_min_level, hash_max_level;
+        utils::Vector quadtree_center, quadtree_extents;
+        int quadtree_depth;
+      };
+
       utils::Mutex drawLock;
-      dSpaceID space;
+      dSpaceID space, static_space;
+      RayCaster *ray_caster;
+      ThreadPool *thread_pool;
+      // hierarchy of the static geoms for the ray and depth queries;
+      // it is updated lazily by the queries
+      mutable StaticBVH static_bvh;
+      mutable bool static_bvh_rebuild, static_bvh_refit;
+      // freed before ODE is closed
+      TriMeshCache *trimesh_cache;
+      ContactCache contact_cache;
+      std::vector<TiledHeightfield*> tiled_heightfields;
+      // bounding boxes of the dynamic geoms for the tile updates
+      std::vector<dReal> body_aabbs;
       dWorldID world;
       dGeomID plane;
       dJointGroupID contactgroup;
@@ -119,14 +212,64 @@ namespace mars {
       interfaces::ControlCenter *control;
       utils::Vector old_gravity;
       interfaces::sReal old_cfm, old_erp;
+      int old_quickstep_iterations;
+      interfaces::sReal old_quickstep_w;
+      // steps with a small error since the iterations were changed
+      int quickstep_calm_steps;
+      bool old_auto_disable;
+      interfaces::sReal old_auto_disable_linear, old_auto_disable_angular;
+      interfaces::sReal old_auto_disable_time;
+      int old_auto_disable_steps;
+      // the disabled bodies of the last step, sorted
+      std::vector<dBodyID> sleeping_bodies, sleeping_tmp;
+#ifdef ODE_THREADING
+      // the solver threads of ODE; both are 0 if the world is stepped in
+      // the calling thread
+      dThreadingImplementationID threading;
+      dThreadingThreadPoolID threading_pool;
+#endif
+      int old_solver_threads;
+      // union find data of the island statistics
+      std::vector<int> island_parent, island_count;
+      std::vector<bool> island_enabled;
 
       std::vector<body_nbr_tupel> comp_body_list;
       std::vector<interfaces::draw_item> draw_intern;
       std::vector<interfaces::draw_item> draw_extern;
-      std::vector<dJointFeedback*> contact_feedback_list;
+      // contact buffer of nearCallback and pool of the joint feedbacks;
+      // both keep their memory from step to step
+      std::vector<dContact> contact_buffer;
+      std::vector<dJointFeedback*> feedback_blocks;
+      size_t num_feedbacks;
+      unsigned long contact_generation;
+      dJointFeedback* newFeedback(void);
       bool create_contacts, log_contacts;
       int num_contacts;
       int ray_collision;
+      dReal max_contact_depth;
+      std::vector<dBodyID> adaptive_bodies;
+      // adaptive_bodies holds the bodies of the current step
+      bool bodies_collected;
+      std::vector<utils::Vector> adaptive_forces;
+      void collide(void);
+      Broadphase getBroadphase(void) const;
+      Broadphase chooseBroadphase(void) const;
+      dSpaceID createSpace(const Broadphase &bp, bool isStatic) const;
+      void createSpaces(const Broadphase &bp);
+      void updateStaticBVH(void) const;
+      void applyAutoDisable(void);
+      void updateSleepStatistics(void);
+      void wakeBodiesNear(dGeomID geom);
+      void applySolverThreads(void);
+      void freeSolverThreads(void);
+      void updateIslandStatistics(void);
+      void updateTiledHeightfields(void);
+      int getNumSubsteps(void);
+      dReal getJointError(void);
+      void adaptQuickStepIterations(void);
+      void collectBodies(void);
+      void saveBodyForces(void);
+      void restoreBodyForces(void);
       // this functions are for the collision implementation
       void nearCallback (dGeomID o1, dGeomID o2);
       static void callbackForward(void *data, dGeomID o1, dGeomID o2);
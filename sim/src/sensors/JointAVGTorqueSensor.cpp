@@ -68,15 +68,19 @@ namespace mars {
     }
 
     int JointAVGTorqueSensor::getSensorData(sReal** data) const {
-      std::vector<double>::const_iterator iter;
-  
       *data = (sReal*)malloc(sizeof(sReal));
-      **data = 0;
+      return readSensorData(*data, 1);
+    }
+
+    int JointAVGTorqueSensor::readSensorData(sReal *data, int size) const {
+      std::vector<double>::const_iterator iter;
+
+      if(size < 1) return 0;
+      *data = 0;
       for(iter = doubleArray.begin(); iter != doubleArray.end(); iter++) {
-        **data += *iter;
+        *data += *iter;
       }
-      **data /= doubleArray.size();
-
+      *data /= doubleArray.size();
       return 1;
     }
 
@@ -53,6 +53,9 @@ namespace mars {
       virtual ~JointArraySensor(void);
       virtual int getAsciiData(char* data) const ;
       virtual int getSensorData(interfaces::sReal **data) const ;
+      virtual int readSensorData(interfaces::sReal *data, int size) const;
+      virtual void saveState(utils::BinaryBuffer *buffer) const;
+      virtual bool restoreState(utils::BinaryBuffer *buffer, bool apply);
       virtual void receiveData(const data_broker::DataInfo &info,
                                const data_broker::DataPackage &package,
                                int callbackParam) {}
@@ -67,14 +67,19 @@ namespace mars {
     }
 
     int JointLoadSensor::getSensorData(sReal** data) const {
+      *data = (sReal*)malloc(sizeof(sReal));
+      return readSensorData(*data, 1);
+    }
+
+    int JointLoadSensor::readSensorData(sReal *data, int size) const {
       std::vector<double>::const_iterator iter;
 
-      *data = (sReal*)malloc(sizeof(sReal));
-      **data = 0;
+      if(size < 1) return 0;
+      *data = 0;
       for(iter = doubleArray.begin(); iter != doubleArray.end(); iter++) {
-        **data += *iter;
+        *data += *iter;
       }
-      **data /= doubleArray.size();
+      *data /= doubleArray.size();
       return 1;
     }
 
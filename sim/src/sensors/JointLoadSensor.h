@@ -47,6 +47,7 @@ namespace mars {
 
       virtual int getAsciiData(char* data) const ;
       virtual int getSensorData(interfaces::sReal **data) const ;
+      virtual int readSensorData(interfaces::sReal *data, int size) const;
       virtual void receiveData(const data_broker::DataInfo &info,
                                const data_broker::DataPackage &package,
                                int callbackParam);
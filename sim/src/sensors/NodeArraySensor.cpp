@@ -122,16 +122,34 @@ namespace mars {
     }
 
     int NodeArraySensor::getSensorData(sReal** data) const {
+      *data = (sReal*)calloc(doubleArray.size(), sizeof(sReal));
+      return readSensorData(*data, doubleArray.size());
+    }
+
+    int NodeArraySensor::readSensorData(sReal *data, int size) const {
       std::vector<double>::const_iterator iter;
       int i=0;
 
-      *data = (sReal*)calloc(doubleArray.size(), sizeof(sReal));
-      for(iter = doubleArray.begin(); iter != doubleArray.end(); iter++) {
-        (*data)[i++] = *iter;
+      for(iter = doubleArray.begin(); iter != doubleArray.end() && i < size;
+          iter++) {
+        data[i++] = *iter;
       }
 
       return i;
     }
 
+    void NodeArraySensor::saveState(utils::BinaryBuffer *buffer) const {
+      buffer->writeVector(doubleArray);
+    }
+
+    bool NodeArraySensor::restoreState(utils::BinaryBuffer *buffer, bool apply) {
+      std::vector<double> values;
+      if(!buffer->readVector(&values) || values.size() != doubleArray.size()) {
+        return false;
+      }
+      if(apply) doubleArray.swap(values);
+      return true;
+    }
+
   } // end of namespace sim
 } // end of namespace mars
@@ -59,13 +59,19 @@ namespace mars {
     }
 
     int NodeCOMSensor::getSensorData(sReal** data) const {
-      Vector center = control->nodes->getCenterOfMass(config.ids);
-  
       *data = (sReal*)calloc(3, sizeof(sReal));
-      (*data)[0] = center.x();
-      (*data)[1] = center.y();
-      (*data)[2] = center.z();
-      return 3;
+      return readSensorData(*data, 3);
+    }
+
+    int NodeCOMSensor::readSensorData(sReal *data, int size) const {
+      int count = size < 3 ? size : 3;
+      if(count <= 0) return 0;
+      Vector center = control->nodes->getCenterOfMass(config.ids);
+
+      for(int i=0; i<count; ++i) {
+        data[i] = center[i];
+      }
+      return count;
     }
 
   } // end of namespace sim
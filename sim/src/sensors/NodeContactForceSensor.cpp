@@ -86,14 +86,19 @@ namespace mars {
     }
 
     int NodeContactForceSensor::getSensorData(sReal** data) const {
+      *data = (sReal*)malloc(sizeof(sReal));
+      return readSensorData(*data, 1);
+    }
+
+    int NodeContactForceSensor::readSensorData(sReal *data, int size) const {
       sReal contact = 0;
       std::vector<double>::const_iterator iter;
-  
-      *data = (sReal*)malloc(sizeof(sReal));
+
+      if(size < 1) return 0;
       for(iter = doubleArray.begin(); iter != doubleArray.end(); iter++) {
-        contact += *iter;;
+        contact += *iter;
       }
-      **data = contact;
+      *data = contact;
       return 1;
     }
 
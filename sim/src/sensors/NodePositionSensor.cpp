@@ -75,14 +75,19 @@ namespace mars {
     }
 
     int NodePositionSensor::getSensorData(sReal** data) const {
+      *data = (sReal*)calloc(3*values.size(), sizeof(sReal));
+      return readSensorData(*data, 3*values.size());
+    }
+
+    int NodePositionSensor::readSensorData(sReal *data, int size) const {
       std::vector<Vector>::const_iterator iter;
       int i=0;
 
-      *data = (sReal*)calloc(3*values.size(), sizeof(sReal));
-      for(iter = values.begin(); iter != values.end(); iter++) {
-        (*data)[i++] = iter->x();
-        (*data)[i++] = iter->y();
-        (*data)[i++] = iter->z();
+      for(iter = values.begin(); iter != values.end() && i < size;
+          iter++) {
+        for(int k=0; k<3 && i < size; ++k) {
+          data[i++] = (*iter)[k];
+        }
       }
       return i;
     }
@@ -78,15 +78,25 @@ namespace mars {
     }
 
     int NodeRotationSensor::getSensorData(sReal** data) const {
-      std::vector<sRotation>::const_iterator iter;
-  
       *data = (sReal*)calloc(3, sizeof(sReal));
+      return readSensorData(*data, 3);
+    }
+
+    int NodeRotationSensor::readSensorData(sReal *data, int size) const {
+      std::vector<sRotation>::const_iterator iter;
+
+      int count = size < 3 ? size : 3;
+      if(count <= 0) return 0;
+      sReal rotation[3] = {0.0, 0.0, 0.0};
       for(iter = values.begin(); iter != values.end(); iter++) {
-        (*data)[0] = iter->alpha;
-        (*data)[1] = iter->beta;
-        (*data)[2] = iter->gamma;
+        rotation[0] = iter->alpha;
+        rotation[1] = iter->beta;
+        rotation[2] = iter->gamma;
+      }
+      for(int i=0; i<count; ++i) {
+        data[i] = rotation[i];
       }
-      return 3;
+      return count;
     }
 
     void NodeRotationSensor::receiveData(const data_broker::DataInfo &info,
@@ -143,10 +143,16 @@ namespace mars {
 
     int RaySensor::getSensorData(double **data_) const {
       *data_ = (double*)malloc(data.size()*sizeof(double));
-      for(unsigned int i=0; i<data.size(); i++) {
-        (*data_)[i] = data[i];
+      return readSensorData(*data_, data.size());
+    }
+
+    int RaySensor::readSensorData(double *data_, int size) const {
+      int count = data.size();
+      if(count > size) count = size;
+      for(int i=0; i<count; i++) {
+        data_[i] = data[i];
       }
-      return data.size();
+      return count;
     }
 
     void RaySensor::receiveData(const data_broker::DataInfo &info,
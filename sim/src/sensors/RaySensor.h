@@ -82,6 +82,7 @@ namespace mars {
   
       std::vector<double> getSensorData() const; 
       int getSensorData(double**) const; 
+      int readSensorData(double *data, int size) const;
       virtual void receiveData(const data_broker::DataInfo &info,
                                const data_broker::DataPackage &package,
                                int callbackParam);
@@ -191,6 +191,34 @@ namespace mars {
       return pointcloud.size();
     }
 
+    void RotatingRaySensor::saveState(utils::BinaryBuffer *buffer) const {
+      mars::utils::MutexLocker lock(&mutex_pointcloud);
+      std::vector<utils::Vector> points(pointcloud.begin(), pointcloud.end());
+      buffer->writeVector(points);
+      buffer->writeVector(pointcloud_full);
+      buffer->write(have_update);
+      buffer->write(turning_offset);
+      buffer->write(orientation_offset);
+      buffer->write(current_pose.matrix());
+    }
+
+    bool RotatingRaySensor::restoreState(utils::BinaryBuffer *buffer,
+                                         bool apply) {
+      mars::utils::MutexLocker lock(&mutex_pointcloud);
+      std::vector<utils::Vector> points, full;
+      if(!buffer->readVector(&points) || !buffer->readVector(&full)) {
+        return false;
+      }
+      if(apply) {
+        pointcloud.assign(points.begin(), points.end());
+        pointcloud_full.swap(full);
+      }
+      return (buffer->readOrSkip(&have_update, apply) &&
+              buffer->readOrSkip(&turning_offset, apply) &&
+              buffer->readOrSkip(&orientation_offset, apply) &&
+              buffer->readOrSkip(&current_pose.matrix(), apply));
+    }
+
     void RotatingRaySensor::receiveData(const data_broker::DataInfo &info,
                                 const data_broker::DataPackage &package,
                                 int callbackParam) {
@@ -105,6 +105,12 @@ namespace mars {
        * Inherited from BaseSensor, implemented from BasePolarIntersectionSensor.
        */
       int getSensorData(double**) const; 
+
+      /**
+       * Stores the scan in progress and the last full scan.
+       */
+      virtual void saveState(utils::BinaryBuffer *buffer) const;
+      virtual bool restoreState(utils::BinaryBuffer *buffer, bool apply);
       
       /**
        * Receives the measured distances, calculates the vectors in the local
@@ -230,7 +230,7 @@ namespace mars {
         }
       }
 
-      static int wth = width*height;
+      int wth = width*height;
       for(int i=0;i<config.maxDist/config.resolution;i++){
         res[i+1]= std::min((res[i+1]/wth)*255.0*config.gain,255.0);
       }
@@ -167,7 +167,7 @@ namespace mars {
 
       control->dataBroker = libManager->getLibraryAs<data_broker::DataBrokerInterface>("data_broker");
       if(control->dataBroker) {
-        ControlCenter::theDataBroker = control->dataBroker;
+        ControlCenter::setLogDataBroker(control->dataBroker);
       }
 
       libManager->loadConfigFile(coreConfigFile);